@@ -0,0 +1,359 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of AcquisitionGroup
+ */
+
+#include "scopehal.h"
+#include "AcquisitionGroup.h"
+#include <thread>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+AcquisitionGroup::AcquisitionGroup()
+	: m_triggerArmed(false)
+	, m_triggerOneShot(false)
+{
+}
+
+AcquisitionGroup::~AcquisitionGroup()
+{
+	//We own any merged waveforms nobody has picked up yet, but not the instruments themselves
+	for(auto set : m_pendingWaveforms)
+	{
+		for(auto it : set)
+			delete it.second;
+	}
+	m_pendingWaveforms.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Membership
+
+/**
+	@brief Adds an instrument to the group.
+
+	The first instrument added is the timing reference for the whole group.
+
+	@param scope	The instrument to add
+	@param skew		Delay, in picoseconds, from the reference instrument's trigger to this instrument's trigger
+ */
+void AcquisitionGroup::AddScope(Oscilloscope* scope, int64_t skew)
+{
+	for(auto s : m_scopes)
+	{
+		if(s == scope)
+		{
+			LogWarning("AcquisitionGroup::AddScope: instrument is already in the group\n");
+			return;
+		}
+	}
+
+	m_scopes.push_back(scope);
+	m_skews[scope] = skew;
+}
+
+void AcquisitionGroup::RemoveScope(Oscilloscope* scope)
+{
+	for(size_t i=0; i<m_scopes.size(); i++)
+	{
+		if(m_scopes[i] == scope)
+		{
+			m_scopes.erase(m_scopes.begin() + i);
+			break;
+		}
+	}
+	m_skews.erase(scope);
+	m_triggered.erase(scope);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Triggering
+
+/**
+	@brief Arms every instrument in the group for a single acquisition.
+
+	Members are always armed in one-shot mode so that no instrument re-arms itself at the end of its own download.
+	In continuous mode the group re-arms everybody at once after the slowest member has finished downloading.
+ */
+void AcquisitionGroup::ArmAll()
+{
+	m_triggered.clear();
+	for(auto s : m_scopes)
+		s->StartSingleTrigger();
+	m_triggerArmed = true;
+}
+
+void AcquisitionGroup::Start()
+{
+	m_triggerOneShot = false;
+	ArmAll();
+}
+
+void AcquisitionGroup::StartSingleTrigger()
+{
+	m_triggerOneShot = true;
+	ArmAll();
+}
+
+void AcquisitionGroup::Stop()
+{
+	for(auto s : m_scopes)
+		s->Stop();
+	m_triggered.clear();
+	m_triggerArmed = false;
+	m_triggerOneShot = true;
+}
+
+/**
+	@brief Checks the trigger status of the group.
+
+	The group is considered triggered once every member has triggered. Members which have already reported a trigger
+	are not polled again, since some instruments (e.g. LeCroy) clear the trigger status when it is read.
+ */
+Oscilloscope::TriggerMode AcquisitionGroup::PollTrigger()
+{
+	if(m_scopes.empty())
+		return Oscilloscope::TRIGGER_MODE_STOP;
+
+	for(auto s : m_scopes)
+	{
+		if(m_triggered.find(s) != m_triggered.end())
+			continue;
+		if(s->PollTrigger() == Oscilloscope::TRIGGER_MODE_TRIGGERED)
+			m_triggered.emplace(s);
+	}
+
+	if(m_triggered.size() == m_scopes.size())
+	{
+		m_triggerArmed = false;
+		return Oscilloscope::TRIGGER_MODE_TRIGGERED;
+	}
+
+	if(m_triggerArmed)
+		return Oscilloscope::TRIGGER_MODE_RUN;
+	return Oscilloscope::TRIGGER_MODE_STOP;
+}
+
+/**
+	@brief Block until every member has triggered or a timeout elapses.
+
+	@param timeout	Timeout value, in milliseconds
+
+	@return True if triggered, false if timeout
+ */
+bool AcquisitionGroup::WaitForTrigger(int timeout)
+{
+	double deadline = GetTime() + timeout * 1e-3;
+	while(GetTime() < deadline)
+	{
+		if(PollTrigger() == Oscilloscope::TRIGGER_MODE_TRIGGERED)
+			return true;
+		usleep(10 * 1000);
+	}
+
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Acquisition
+
+/**
+	@brief Downloads waveforms from every member concurrently and merges them into one set per trigger event.
+
+	Each instrument is downloaded on its own thread into its own pending-waveform queue. Once all downloads are done,
+	the n'th set of every instrument's queue is merged into the n'th set of the group's queue.
+
+	@return True on success, false if any member failed to download (in which case nothing is queued)
+ */
+bool AcquisitionGroup::AcquireData()
+{
+	if(m_scopes.empty())
+		return false;
+
+	double start = GetTime();
+
+	//Pull data from everyone at once. Each driver does its own locking, so no serialization is needed here.
+	//(Use char rather than bool so that each thread writes to a distinct memory location)
+	vector<char> ok(m_scopes.size(), 0);
+	vector<thread> threads;
+	for(size_t i=0; i<m_scopes.size(); i++)
+		threads.push_back(thread([this, i, &ok] { ok[i] = m_scopes[i]->AcquireData(true); }));
+	for(auto& t : threads)
+		t.join();
+	m_triggered.clear();
+
+	//If anybody failed, throw the whole acquisition away so segments don't get out of sync between instruments
+	bool success = true;
+	for(size_t i=0; i<m_scopes.size(); i++)
+	{
+		if(!ok[i])
+		{
+			LogError("AcquisitionGroup: waveform download from %s failed\n", m_scopes[i]->m_nickname.c_str());
+			success = false;
+		}
+	}
+
+	//We can only merge as many segments as the member with the fewest has
+	size_t nsegments = success ? SIZE_MAX : 0;
+	for(auto s : m_scopes)
+		nsegments = min(nsegments, s->GetPendingWaveformCount());
+
+	Oscilloscope* ref = m_scopes[0];
+	int64_t refskew = m_skews[ref];
+	for(size_t i=0; i<nsegments; i++)
+	{
+		Oscilloscope::SequenceSet merged;
+
+		//Find the timing reference for this segment
+		Oscilloscope::SequenceSet set;
+		ref->PopPendingWaveform(set);
+		CaptureChannelBase* refcap = NULL;
+		for(auto it : set)
+		{
+			if(it.second != NULL)
+			{
+				refcap = it.second;
+				break;
+			}
+		}
+		merged.insert(set.begin(), set.end());
+
+		//Merge everything else in, fixing up timestamps as we go
+		for(size_t j=1; j<m_scopes.size(); j++)
+		{
+			set.clear();
+			m_scopes[j]->PopPendingWaveform(set);
+			if(refcap != NULL)
+				AlignTimestamps(set, refcap, m_skews[m_scopes[j]] - refskew);
+			merged.insert(set.begin(), set.end());
+		}
+
+		lock_guard<mutex> lock(m_pendingWaveformsMutex);
+		m_pendingWaveforms.push_back(merged);
+	}
+
+	//Discard any extra segments so the next acquisition starts out aligned
+	for(auto s : m_scopes)
+	{
+		Oscilloscope::SequenceSet set;
+		while(s->PopPendingWaveform(set))
+		{
+			if(success)
+				LogWarning("AcquisitionGroup: discarding unmatched segment from %s\n", s->m_nickname.c_str());
+			for(auto it : set)
+				delete it.second;
+		}
+	}
+
+	double dt = GetTime() - start;
+	LogTrace("Group download of %zu instruments took %.3f ms\n", m_scopes.size(), dt * 1000);
+
+	//Re-arm everyone together if not in one-shot mode
+	if(!m_triggerOneShot)
+		ArmAll();
+
+	return success;
+}
+
+/**
+	@brief Moves every capture in a set onto the time base of the reference capture.
+
+	@param set		The set of captures to adjust
+	@param ref		Capture from the reference instrument for the same trigger event
+	@param skew		Delay, in picoseconds, of this instrument relative to the reference
+ */
+void AcquisitionGroup::AlignTimestamps(Oscilloscope::SequenceSet& set, CaptureChannelBase* ref, int64_t skew)
+{
+	const int64_t ps_per_sec = 1000000000000LL;
+
+	int64_t ps = ref->m_startPicoseconds + skew;
+	time_t sec = ref->m_startTimestamp + ps / ps_per_sec;
+	ps %= ps_per_sec;
+	if(ps < 0)
+	{
+		ps += ps_per_sec;
+		sec --;
+	}
+
+	for(auto it : set)
+	{
+		auto cap = it.second;
+		if(cap == NULL)
+			continue;
+		cap->m_startTimestamp = sec;
+		cap->m_startPicoseconds = ps;
+	}
+}
+
+size_t AcquisitionGroup::GetPendingWaveformCount()
+{
+	lock_guard<mutex> lock(m_pendingWaveformsMutex);
+	return m_pendingWaveforms.size();
+}
+
+bool AcquisitionGroup::HasPendingWaveforms()
+{
+	lock_guard<mutex> lock(m_pendingWaveformsMutex);
+	return !m_pendingWaveforms.empty();
+}
+
+/**
+	@brief Removes the oldest merged set of waveforms from the queue. Ownership of the captures passes to the caller.
+ */
+bool AcquisitionGroup::PopPendingWaveform(Oscilloscope::SequenceSet& set)
+{
+	lock_guard<mutex> lock(m_pendingWaveformsMutex);
+	if(m_pendingWaveforms.empty())
+		return false;
+
+	set = *m_pendingWaveforms.begin();
+	m_pendingWaveforms.pop_front();
+	return true;
+}
+
+/**
+	@brief Applies the oldest merged set of waveforms to the channels of every member instrument
+ */
+bool AcquisitionGroup::AcquireDataFifo()
+{
+	Oscilloscope::SequenceSet set;
+	if(!PopPendingWaveform(set))
+		return false;
+
+	for(auto it : set)
+		it.first->SetData(it.second);
+	return true;
+}
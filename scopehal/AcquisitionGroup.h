@@ -0,0 +1,117 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of AcquisitionGroup
+ */
+
+#ifndef AcquisitionGroup_h
+#define AcquisitionGroup_h
+
+/**
+	@brief A set of oscilloscopes triggered from a shared reference and acquired as a single logical instrument.
+
+	All members are armed together, the group waits until every member has triggered, and then waveforms are
+	downloaded from all members concurrently (one thread per instrument) so the total download time is that of the
+	slowest instrument rather than the sum of all of them.
+
+	The first instrument added to the group is the timing reference. Each capture from the other members has its
+	timestamp replaced by the reference capture's timestamp plus that instrument's skew offset, so that waveforms
+	from every instrument share a single time base.
+ */
+class AcquisitionGroup
+{
+public:
+	AcquisitionGroup();
+	virtual ~AcquisitionGroup();
+
+	//Membership
+	void AddScope(Oscilloscope* scope, int64_t skew = 0);
+	void RemoveScope(Oscilloscope* scope);
+
+	size_t GetScopeCount()
+	{ return m_scopes.size(); }
+
+	Oscilloscope* GetScope(size_t i)
+	{ return m_scopes[i]; }
+
+	/**
+		@brief Sets the skew of an instrument relative to the reference instrument.
+
+		@param scope	The instrument
+		@param skew		Delay, in picoseconds, from the reference instrument's trigger to this instrument's trigger
+	 */
+	void SetSkew(Oscilloscope* scope, int64_t skew)
+	{ m_skews[scope] = skew; }
+
+	int64_t GetSkew(Oscilloscope* scope)
+	{ return m_skews[scope]; }
+
+	//Triggering
+	void Start();
+	void StartSingleTrigger();
+	void Stop();
+	bool IsTriggerArmed()
+	{ return m_triggerArmed; }
+
+	Oscilloscope::TriggerMode PollTrigger();
+	bool WaitForTrigger(int timeout);
+
+	//Acquisition
+	bool AcquireData();
+
+	bool HasPendingWaveforms();
+	size_t GetPendingWaveformCount();
+	bool PopPendingWaveform(Oscilloscope::SequenceSet& set);
+	bool AcquireDataFifo();
+
+protected:
+	void ArmAll();
+	void AlignTimestamps(Oscilloscope::SequenceSet& set, CaptureChannelBase* ref, int64_t skew);
+
+	///The instruments in the group (the first is the timing reference)
+	std::vector<Oscilloscope*> m_scopes;
+
+	///Skew of each instrument, in picoseconds, relative to the reference
+	std::map<Oscilloscope*, int64_t> m_skews;
+
+	///Instruments which have triggered since the group was last armed
+	std::set<Oscilloscope*> m_triggered;
+
+	bool m_triggerArmed;
+	bool m_triggerOneShot;
+
+	///Merged waveforms from all instruments, ready for display
+	std::list<Oscilloscope::SequenceSet> m_pendingWaveforms;
+	std::mutex m_pendingWaveformsMutex;
+};
+
+#endif
@@ -422,35 +422,40 @@ bool AgilentOscilloscope::AcquireData(bool toQueue)
 {
 	//LogDebug("Acquiring data\n");
 
+	vector<size_t> channels;
+	vector<bool> enabled = GetEnabledChannelMask(m_analogChannelCount, channels);
+
 	lock_guard<recursive_mutex> lock(m_mutex);
 	LogIndenter li;
 
-	unsigned int format;
-	unsigned int type;
-	size_t length;
-	unsigned int average_count;
-	double xincrement;
-	double xorigin;
-	double xreference;
-	double yincrement;
-	double yorigin;
-	double yreference;
-	map<int, vector<AnalogCapture*> > pending_waveforms;
-	for(size_t i=0; i<m_analogChannelCount; i++)
+	//Ask for every enabled channel's preamble in one burst.
+	//:WAV:SOUR is sticky, but commands are executed in order so each query sees the source set just before it.
+	m_transport->BeginBatch();
+	for(auto i : channels)
 	{
-		if(!IsChannelEnabled(i))
-		{
-			if(!toQueue)
-				m_channels[i]->SetData(NULL);
-			continue;
-		}
-
-
-		// Set source & get preamble
 		m_transport->SendCommand(":WAV:SOUR " + m_channels[i]->GetHwname());
 		m_transport->SendCommand(":WAV:PRE?");
+	}
+	m_transport->EndBatch();
+
+	vector<size_t> lengths;
+	vector<int64_t> timescales;
+	vector<float> scales;
+	vector<float> offsets;
+	for(size_t n=0; n<channels.size(); n++)
+	{
+		unsigned int format;
+		unsigned int type;
+		size_t length = 0;
+		unsigned int average_count;
+		double xincrement = 0;
+		double xorigin;
+		double xreference;
+		double yincrement = 0;
+		double yorigin = 0;
+		double yreference = 0;
 		string reply = m_transport->ReadReply();
-		sscanf(reply.c_str(), "%u,%u,%lu,%u,%lf,%lf,%lf,%lf,%lf,%lf",
+		sscanf(reply.c_str(), "%u,%u,%zu,%u,%lf,%lf,%lf,%lf,%lf,%lf",
 				&format, &type, &length, &average_count, &xincrement, &xorigin, &xreference, &yincrement, &yorigin, &yreference);
 
 		//Figure out the sample rate
@@ -459,45 +464,67 @@ bool AgilentOscilloscope::AcquireData(bool toQueue)
 
 		//LogDebug("length = %d\n", length);
 
-		//Set up the capture we're going to store our data into (no high res timer on R&S scopes)
+		//volts = yincrement * (raw - yreference) + yorigin
+		lengths.push_back(length);
+		timescales.push_back(ps_per_sample);
+		scales.push_back(yincrement);
+		offsets.push_back(yorigin - yincrement*yreference);
+	}
+
+	//Ask for the first channel's data
+	if(!channels.empty())
+	{
+		m_transport->BeginBatch();
+		m_transport->SendCommand(":WAV:SOUR " + m_channels[channels[0]]->GetHwname());
+		m_transport->SendCommand(":WAV:DATA?");
+		m_transport->EndBatch();
+	}
+
+	map<int, vector<AnalogCapture*> > pending_waveforms;
+	for(size_t n=0; n<channels.size(); n++)
+	{
+		size_t i = channels[n];
+
+		//Set up the capture we're going to store our data into (no high res timer on Agilent scopes)
 		AnalogCapture* cap = new AnalogCapture;
-		cap->m_timescale = ps_per_sample;
+		cap->m_timescale = timescales[n];
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time(NULL);
 		double t = GetTime();
 		cap->m_startPicoseconds = (t - floor(t)) * 1e12f;
 
-		//Ask for the data
-		m_transport->SendCommand(":WAV:DATA?");
-
 		//Read the length header
 		char tmp[16] = {0};
 		m_transport->ReadRawData(2, (unsigned char*)tmp);
 		int num_digits = atoi(tmp+1);
 		//LogDebug("num_digits = %d", num_digits);
 		m_transport->ReadRawData(num_digits, (unsigned char*)tmp);
-		int actual_len = atoi(tmp);
+		tmp[num_digits] = 0;
+		size_t actual_len = strtoul(tmp, NULL, 10);
 		//LogDebug("actual_len = %d", actual_len);
 
-		uint8_t* temp_buf = new uint8_t[actual_len / sizeof(uint8_t)];
-
-		//Read the actual data
-		m_transport->ReadRawData(actual_len, (unsigned char*)temp_buf);
-		//Discard trailing newline
+		//Read the actual data straight into the capture (one byte per sample), then the trailing newline
+		if(actual_len != lengths[n])
+			LogWarning("%s: expected %zu points, got %zu\n", m_channels[i]->GetHwname().c_str(), lengths[n], actual_len);
+		ReadRawBlock<uint8_t>(cap, actual_len);
 		m_transport->ReadRawData(1, (unsigned char*)tmp);
 
-		//Format the capture
-		for(size_t j=0; j<length; j++)
-			cap->m_samples.push_back(AnalogSample(j, 1, yincrement * (temp_buf[j] - yreference) + yorigin));
+		//This block is fully read, so queue up the next channel's and let the scope send it while we convert
+		if(n+1 < channels.size())
+		{
+			m_transport->BeginBatch();
+			m_transport->SendCommand(":WAV:SOUR " + m_channels[channels[n+1]]->GetHwname());
+			m_transport->SendCommand(":WAV:DATA?");
+			m_transport->EndBatch();
+		}
+
+		ExpandAnalogBlock<uint8_t>(cap, actual_len, scales[n], offsets[n]);
 
 		//Done, update the data
 		if(!toQueue)
 			m_channels[i]->SetData(cap);
 		else
 			pending_waveforms[i].push_back(cap);
-
-		//Clean up
-		delete[] temp_buf;
 	}
 
 	//Now that we have all of the pending waveforms, save them in sets across all channels
@@ -510,13 +537,23 @@ bool AgilentOscilloscope::AcquireData(bool toQueue)
 		SequenceSet s;
 		for(size_t j=0; j<m_analogChannelCount; j++)
 		{
-			if(IsChannelEnabled(j))
+			if(enabled[j])
 				s[m_channels[j]] = pending_waveforms[j][i];
 		}
 		m_pendingWaveforms.push_back(s);
 	}
 	m_pendingWaveformsMutex.unlock();
 
+	//Disabled channels get cleared
+	if(!toQueue)
+	{
+		for(size_t i=0; i<m_analogChannelCount; i++)
+		{
+			if(!enabled[i])
+				m_channels[i]->SetData(NULL);
+		}
+	}
+
 	//TODO: support digital channels
 
 	//Re-arm the trigger if not in one-shot mode
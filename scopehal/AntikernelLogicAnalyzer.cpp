@@ -289,6 +289,64 @@ Oscilloscope::TriggerMode AntikernelLogicAnalyzer::PollTrigger()
 	}
 }
 
+/**
+	@brief Transposes an 8x8 bit matrix packed into a 64-bit word.
+
+	On input, byte i bit j is row i column j. On output, byte j bit i holds the same value.
+ */
+uint64_t AntikernelLogicAnalyzer::Transpose8x8(uint64_t x)
+{
+	uint64_t t;
+	t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+	x = x ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+	x = x ^ t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+	x = x ^ t ^ (t << 28);
+	return x;
+}
+
+/**
+	@brief Converts the raw row-major capture memory into a column store
+
+	Each bit column of the capture memory becomes a packed run of stride bytes in columns, LSB first, so sample j of
+	column c is bit (j % 8) of columns[c*stride + j/8].
+
+	This is done 8 rows x 8 columns at a time with a bit-matrix transpose, rather than one bit at a time.
+
+	@return The stride, in bytes, between columns
+ */
+size_t AntikernelLogicAnalyzer::TransposeToColumns(
+	const vector<uint8_t>& data,
+	uint32_t bytewidth,
+	vector<uint8_t>& columns)
+{
+	size_t stride = (m_memoryDepth + 7) / 8;
+	columns.resize(bytewidth * 8 * stride);
+
+	#pragma omp parallel for
+	for(size_t block=0; block<stride; block++)
+	{
+		size_t row = block*8;
+		size_t nrows = min((size_t)8, (size_t)m_memoryDepth - row);
+
+		for(size_t nbyte=0; nbyte<bytewidth; nbyte++)
+		{
+			//Gather one byte from each of 8 consecutive rows
+			uint64_t x = 0;
+			for(size_t k=0; k<nrows; k++)
+				x |= static_cast<uint64_t>(data[(row+k)*bytewidth + nbyte]) << (k*8);
+
+			//Byte j of the transposed block is 8 consecutive samples of column (nbyte*8 + j)
+			x = Transpose8x8(x);
+			for(size_t j=0; j<8; j++)
+				columns[(nbyte*8 + j)*stride + block] = (x >> (j*8)) & 0xff;
+		}
+	}
+
+	return stride;
+}
+
 bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 {
 	lock_guard<recursive_mutex> lock(m_mutex);
@@ -310,26 +368,48 @@ bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 	SendCommand(CMD_GET_DATA);
 	m_transport->ReadRawData(memsize, &data[0]);
 
+	//Split it up by column. The raw rows aren't needed after this, so free them rather than hold two copies.
+	//The column store only lives until the channel captures have been built from it.
+	vector<uint8_t> columns;
+	size_t stride = TransposeToColumns(data, bytewidth, columns);
+	vector<uint8_t>().swap(data);
+
 	SequenceSet pending_waveforms;
 
-	//Synthesize the clock
+	//Synthesize the clock.
+	//It only depends on the memory depth and sample period, so if we're updating the channel in place and the last
+	//clock is still the right shape, keep it and just bump the timestamp.
 	double time = GetTime();
 	double ps = (time - floor(time)) * 1e12f;
 	{
-		DigitalCapture* cap = new DigitalCapture;
-		cap->m_timescale = m_samplePeriod / 2;
-		cap->m_triggerPhase = 0;
-		cap->m_startTimestamp = time;
-		cap->m_startPicoseconds = ps;
-		cap->m_samples.resize(m_memoryDepth * 2);
-
 		auto chan = m_channels[0];
 
-		for(size_t i=0; i<m_memoryDepth; i++)
+		DigitalCapture* cap = NULL;
+		if(!toQueue)
+		{
+			cap = dynamic_cast<DigitalCapture*>(chan->GetData());
+			if( (cap != NULL) &&
+				( (cap->m_samples.size() != m_memoryDepth*2) || (cap->m_timescale != m_samplePeriod/2) ) )
+			{
+				cap = NULL;
+			}
+		}
+
+		if(cap == NULL)
 		{
-			cap->m_samples[i*2] 	= DigitalSample(i*2, 1, 0);
-			cap->m_samples[i*2 + 1] = DigitalSample(i*2 + 1, 1, 1);
+			cap = new DigitalCapture;
+			cap->m_timescale = m_samplePeriod / 2;
+			cap->m_triggerPhase = 0;
+			cap->m_samples.resize(m_memoryDepth * 2);
+
+			for(size_t i=0; i<m_memoryDepth; i++)
+			{
+				cap->m_samples[i*2] 	= DigitalSample(i*2, 1, 0);
+				cap->m_samples[i*2 + 1] = DigitalSample(i*2 + 1, 1, 1);
+			}
 		}
+		cap->m_startTimestamp = time;
+		cap->m_startPicoseconds = ps;
 
 		//Done, update the data
 		if(!toQueue)
@@ -338,7 +418,7 @@ bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 			pending_waveforms[chan] = cap;
 	}
 
-	//Crunch the waveform data (note, LS byte first in each row)
+	//Crunch the waveform data
 	for(size_t i=1; i<m_channels.size(); i++)
 	{
 		auto chan = m_channels[i];
@@ -348,9 +428,6 @@ bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 
 		if(cwidth == 1)
 		{
-			size_t nbyte = nlow / 8;
-			size_t nbit = nlow % 8;
-
 			//Create the channel
 			DigitalCapture* cap = new DigitalCapture;
 			cap->m_timescale = m_samplePeriod;
@@ -359,11 +436,16 @@ bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 			cap->m_startPicoseconds = ps;
 			cap->m_samples.resize(m_memoryDepth);
 
-			//Pull the data
-			for(size_t j=0; j<m_memoryDepth; j++)
+			//Pull the data, 8 samples per column byte
+			const uint8_t* col = &columns[nlow * stride];
+			#pragma omp parallel for
+			for(size_t block=0; block<stride; block++)
 			{
-				uint8_t s = data[j*bytewidth + nbyte];
-				cap->m_samples[j] = DigitalSample(j, 1, (s >> nbit) & 1 ? true : false);
+				uint8_t s = col[block];
+				size_t base = block*8;
+				size_t n = min((size_t)8, (size_t)m_memoryDepth - base);
+				for(size_t k=0; k<n; k++)
+					cap->m_samples[base+k] = DigitalSample(base+k, 1, (s >> k) & 1 ? true : false);
 			}
 
 			//Done, update the data
@@ -381,21 +463,23 @@ bool AntikernelLogicAnalyzer::AcquireData(bool toQueue)
 			cap->m_triggerPhase = 0;
 			cap->m_startTimestamp = time;
 			cap->m_startPicoseconds = ps;
-			cap->m_samples.reserve(m_memoryDepth);
+			cap->m_samples.resize(m_memoryDepth);
 
+			//Fill in each sample's bit vector in place, rather than building a temporary and copying it
+			const uint8_t* cols = &columns[nlow * stride];
+			#pragma omp parallel for
 			for(size_t j=0; j<m_memoryDepth; j++)
 			{
-				vector<bool> bits;
+				size_t nbyte = j / 8;
+				size_t nbit = j % 8;
+
+				auto& sample = cap->m_samples[j];
+				sample.m_offset = j;
+				sample.m_duration = 1;
+				auto& bits = sample.m_sample;
+				bits.resize(cwidth);
 				for(size_t k=0; k<cwidth; k++)
-				{
-					size_t off = nlow + k;
-					size_t nbyte = off / 8;
-					size_t nbit = off % 8;
-					uint8_t s = data[j*bytewidth + nbyte];
-					bits.push_back((s >> nbit) & 1 ? true : false);
-				}
-
-				cap->m_samples.push_back(DigitalBusSample(j, 1, bits));
+					bits[k] = (cols[k*stride + nbyte] >> nbit) & 1 ? true : false;
 			}
 
 			//Done, update the data
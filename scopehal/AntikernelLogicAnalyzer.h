@@ -93,6 +93,8 @@ public:
 
 	virtual unsigned int GetInstrumentTypes();
 
+	static uint64_t Transpose8x8(uint64_t x);
+
 protected:
 	void LoadChannels();
 
@@ -102,6 +104,7 @@ protected:
 	uint8_t Read1ByteReply();
 
 	void ArmTrigger();
+	size_t TransposeToColumns(const std::vector<uint8_t>& data, uint32_t bytewidth, std::vector<uint8_t>& columns);
 
 	bool m_triggerArmed;
 	bool m_triggerOneShot;
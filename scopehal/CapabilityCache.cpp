@@ -0,0 +1,217 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of CapabilityCache
+ */
+
+#include "scopehal.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+mutex CapabilityCache::m_mutex;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File I/O
+
+string CapabilityCache::GetCachePath()
+{
+	const char* home = getenv("HOME");
+	if(home == NULL)
+		return "";
+
+	//Make sure the directory exists (ignore errors, we'll find out when we open the file)
+	string dir = string(home) + "/.scopehal";
+	mkdir(dir.c_str(), 0755);
+
+	return dir + "/instruments.yml";
+}
+
+YAML::Node CapabilityCache::LoadCache()
+{
+	string path = GetCachePath();
+	if(path == "")
+		return YAML::Node();
+
+	//Missing or corrupted cache is not an error, just start over
+	try
+	{
+		return YAML::LoadFile(path);
+	}
+	catch(const YAML::Exception& e)
+	{
+		return YAML::Node();
+	}
+}
+
+/**
+	@brief Replaces the cache file with the given contents.
+
+	The new cache is written to a temporary file next to the real one and renamed over it, so a crash or another
+	session writing at the same time can never leave a truncated cache behind for the next load to trust.
+ */
+void CapabilityCache::SaveCache(const YAML::Node& node)
+{
+	string path = GetCachePath();
+	if(path == "")
+		return;
+
+	YAML::Emitter out;
+	out << node;
+
+	//Temporary name is unique to this process so concurrent sessions don't write to the same file
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%d.tmp", (int)getpid());
+	string tmppath = path + suffix;
+
+	FILE* fp = fopen(tmppath.c_str(), "w");
+	if(!fp)
+	{
+		LogWarning("Couldn't write instrument capability cache %s\n", tmppath.c_str());
+		return;
+	}
+	bool ok = (fprintf(fp, "%s\n", out.c_str()) >= 0);
+	ok &= (fflush(fp) == 0);
+	ok &= (fsync(fileno(fp)) == 0);
+	ok &= (fclose(fp) == 0);
+
+	if(!ok || (rename(tmppath.c_str(), path.c_str()) != 0) )
+	{
+		LogWarning("Couldn't write instrument capability cache %s\n", path.c_str());
+		unlink(tmppath.c_str());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache access
+
+/**
+	@brief Looks up an instrument in the cache.
+
+	@param connectionString	Transport connection string of the instrument
+	@param serial			Serial number reported by *IDN?
+	@param model			Model number reported by *IDN?
+	@param fwVersion		Firmware version reported by *IDN?
+	@param entry			Cached capabilities (only valid if we return true)
+
+	@return True if a matching entry was found
+ */
+bool CapabilityCache::Lookup(
+	const string& connectionString,
+	const string& serial,
+	const string& model,
+	const string& fwVersion,
+	Entry& entry)
+{
+	if(serial == "")
+		return false;
+
+	lock_guard<mutex> lock(m_mutex);
+	const YAML::Node root = LoadCache();
+
+	try
+	{
+		auto inst = root[connectionString];
+		if(!inst)
+			return false;
+		auto node = inst[serial];
+		if(!node)
+			return false;
+
+		//Different instrument at the same address, or firmware was upgraded (which may change the options)
+		if( (node["model"].as<string>() != model) || (node["fwversion"].as<string>() != fwVersion) )
+		{
+			LogDebug("Capability cache entry for %s is stale, ignoring\n", connectionString.c_str());
+			return false;
+		}
+
+		entry.m_vendor = node["vendor"].as<string>();
+		entry.m_model = model;
+		entry.m_serial = serial;
+		entry.m_fwVersion = fwVersion;
+
+		entry.m_options.clear();
+		for(auto it : node["options"])
+			entry.m_options.push_back(it.as<string>());
+
+		entry.m_analogChannelCount = node["analogchannels"].as<unsigned int>();
+	}
+	catch(const YAML::Exception& e)
+	{
+		LogWarning("Malformed capability cache entry for %s, ignoring\n", connectionString.c_str());
+		return false;
+	}
+
+	LogDebug("Using cached capabilities for %s %s (serial %s)\n",
+		entry.m_vendor.c_str(), model.c_str(), serial.c_str());
+	return true;
+}
+
+/**
+	@brief Adds (or replaces) the entry for an instrument
+ */
+void CapabilityCache::Store(const string& connectionString, const Entry& entry)
+{
+	if(entry.m_serial == "")
+		return;
+
+	lock_guard<mutex> lock(m_mutex);
+	YAML::Node root = LoadCache();
+
+	YAML::Node node;
+	node["vendor"] = entry.m_vendor;
+	node["model"] = entry.m_model;
+	node["fwversion"] = entry.m_fwVersion;
+	node["options"] = entry.m_options;
+	node["analogchannels"] = entry.m_analogChannelCount;
+
+	//Only one instrument can live at a given address, so replace anything else there
+	root[connectionString] = YAML::Node();
+	root[connectionString][entry.m_serial] = node;
+
+	SaveCache(root);
+}
+
+/**
+	@brief Removes any cached entries for the given connection string
+ */
+void CapabilityCache::Invalidate(const string& connectionString)
+{
+	lock_guard<mutex> lock(m_mutex);
+	YAML::Node root = LoadCache();
+	if(!root[connectionString])
+		return;
+
+	root.remove(connectionString);
+	SaveCache(root);
+}
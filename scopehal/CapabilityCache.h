@@ -0,0 +1,94 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of CapabilityCache
+ */
+
+#ifndef CapabilityCache_h
+#define CapabilityCache_h
+
+/**
+	@brief Persistent on-disk cache of instrument identity and capabilities.
+
+	Detecting options, channel topology, etc. can take many round trips, which adds up to several seconds over
+	high latency links. Since none of this changes unless the hardware or firmware does, drivers may store the
+	results here after the first connection and skip detection on subsequent connections. The only query needed to
+	validate a cache entry is *IDN?, which the driver has to send anyway.
+
+	Entries are keyed by transport connection string and serial number, and are only considered valid if the model
+	and firmware version reported by the instrument match the cached ones.
+
+	The cache lives in ~/.scopehal/instruments.yml.
+ */
+class CapabilityCache
+{
+public:
+
+	class Entry
+	{
+	public:
+		Entry()
+		: m_analogChannelCount(0)
+		{}
+
+		std::string m_vendor;
+		std::string m_model;
+		std::string m_serial;
+		std::string m_fwVersion;
+
+		///Installed software/hardware options, as reported by the instrument
+		std::vector<std::string> m_options;
+
+		///Number of analog channels.
+		///Digital channels, sample rates, memory depths etc are derived from the model and options, so aren't stored.
+		unsigned int m_analogChannelCount;
+	};
+
+	static bool Lookup(
+		const std::string& connectionString,
+		const std::string& serial,
+		const std::string& model,
+		const std::string& fwVersion,
+		Entry& entry);
+	static void Store(const std::string& connectionString, const Entry& entry);
+	static void Invalidate(const std::string& connectionString);
+
+protected:
+	static std::string GetCachePath();
+	static YAML::Node LoadCache();
+	static void SaveCache(const YAML::Node& node);
+
+	///Serialize access to the cache file (instruments may be connected from several threads at once)
+	static std::mutex m_mutex;
+};
+
+#endif
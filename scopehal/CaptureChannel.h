@@ -38,6 +38,9 @@
 
 #include "OscilloscopeSample.h"
 #include <vector>
+#include <memory>
+
+class CaptureEdgeCache;
 
 /**
 	@brief Base class for all CaptureChannel specializations
@@ -45,9 +48,25 @@
 class CaptureChannelBase
 {
 public:
+	CaptureChannelBase()
+	: m_generation(0)
+	{}
+
 	virtual ~CaptureChannelBase()
 	{}
 
+	/**
+		@brief Unique ID of this capture's contents.
+
+		Assigned by OscilloscopeChannel::SetData() when the capture is first published, and again whenever it's
+		updated in place. Zero if the capture has never been published. Used to tell whether a decoder's inputs have
+		changed.
+	 */
+	uint64_t m_generation;
+
+	///Edge lists found in this capture (see EdgeDetector), created on first use
+	std::shared_ptr<CaptureEdgeCache> m_edgeCache;
+
 	/**
 		@brief The time scale, in picoseconds per timestep, used by this channel.
 
@@ -86,6 +105,12 @@ public:
 	virtual bool EqualityTest(size_t i, size_t j) const =0;
 
 	virtual bool SamplesAdjacent(size_t i, size_t j) const =0;
+
+	/**
+		@brief Gets the approximate amount of memory used by this capture, in bytes
+	 */
+	virtual size_t GetMemoryUsage() const
+	{ return sizeof(*this) + GetDepth() * sizeof(OscilloscopeSampleBase); }
 };
 
 /**
@@ -150,6 +175,9 @@ public:
 		return samp.m_offset + samp.m_duration;
 	}
 
+	virtual size_t GetMemoryUsage() const
+	{ return sizeof(*this) + m_samples.capacity() * sizeof(OscilloscopeSample<S>); }
+
 	size_t size() const
 	{ return m_samples.size(); }
 
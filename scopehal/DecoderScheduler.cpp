@@ -0,0 +1,296 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of DecoderScheduler
+ */
+
+#include "scopehal.h"
+#include "DecoderScheduler.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Creates a scheduler and starts its worker threads
+
+	@param nthreads	Number of worker threads, or zero for one per hardware thread
+ */
+DecoderScheduler::DecoderScheduler(size_t nthreads)
+	: m_remaining(0)
+	, m_queued(0)
+	, m_terminating(false)
+{
+	if(nthreads == 0)
+		nthreads = thread::hardware_concurrency();
+	if(nthreads == 0)
+		nthreads = 1;
+
+	for(size_t i=0; i<nthreads; i++)
+		m_queues.push_back(new WorkQueue);
+	for(size_t i=0; i<nthreads; i++)
+		m_workers.push_back(thread(&DecoderScheduler::WorkerThread, this, i));
+}
+
+DecoderScheduler::~DecoderScheduler()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_terminating = true;
+	}
+	m_workReady.notify_all();
+
+	for(auto& t : m_workers)
+		t.join();
+	for(auto q : m_queues)
+		delete q;
+}
+
+/**
+	@brief Gets a process-wide scheduler with one worker per hardware thread
+ */
+DecoderScheduler& DecoderScheduler::GetDefault()
+{
+	static DecoderScheduler scheduler;
+	return scheduler;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scheduling
+
+/**
+	@brief Refreshes the given decoders, and any dirty decoders they depend on, in parallel.
+
+	Same semantics as calling RefreshIfDirty() on each decoder in turn: a decoder which isn't dirty is left alone,
+	along with everything upstream of it. Returns once every refresh has completed.
+ */
+void DecoderScheduler::RefreshIfDirty(const vector<ProtocolDecoder*>& decoders)
+{
+	lock_guard<mutex> passlock(m_passMutex);
+	RunPass(decoders);
+}
+
+/**
+	@brief Body of RefreshIfDirty(). The caller must hold m_passMutex.
+ */
+void DecoderScheduler::RunPass(const vector<ProtocolDecoder*>& decoders)
+{
+	BuildGraph(decoders);
+	if(m_nodes.empty())
+		return;
+
+	//Seed the queues with everything that has no dirty inputs, spread across the workers
+	m_remaining = m_nodes.size();
+	size_t nqueue = 0;
+	for(size_t i=0; i<m_nodes.size(); i++)
+	{
+		if(m_nodes[i]->m_pending == 0)
+		{
+			Push(nqueue, i);
+			nqueue = (nqueue + 1) % m_queues.size();
+		}
+	}
+
+	//Wait for the pass to finish
+	{
+		unique_lock<mutex> lock(m_mutex);
+		while(m_remaining != 0)
+			m_passDone.wait(lock);
+	}
+
+	for(auto n : m_nodes)
+		delete n;
+	m_nodes.clear();
+}
+
+/**
+	@brief Decodes the whole input of each of the given decoders whose output only covers its time window.
+
+	Meant to be called after the windowed results have been displayed, e.g. from an idle handler.
+	Holds off any other pass until it's done, since it changes the refresh flags of decoders a pass may be using.
+ */
+void DecoderScheduler::CompletePartialRefreshes(const vector<ProtocolDecoder*>& decoders)
+{
+	lock_guard<mutex> passlock(m_passMutex);
+
+	vector<ProtocolDecoder*> partial;
+	for(auto d : decoders)
+	{
+		if(d->IsPartial())
+		{
+			d->m_fullRefresh = true;
+			d->m_dirty = true;
+			partial.push_back(d);
+		}
+	}
+	if(partial.empty())
+		return;
+
+	RunPass(partial);
+
+	for(auto d : partial)
+		d->m_fullRefresh = false;
+}
+
+/**
+	@brief Finds every dirty decoder reachable from the requested outputs and links up their dependencies
+ */
+void DecoderScheduler::BuildGraph(const vector<ProtocolDecoder*>& decoders)
+{
+	//Find all of the decoders which need refreshing
+	map<ProtocolDecoder*, size_t> indexes;
+	vector<ProtocolDecoder*> work = decoders;
+	while(!work.empty())
+	{
+		ProtocolDecoder* d = work.back();
+		work.pop_back();
+
+		if( (d == NULL) || !d->m_dirty || (indexes.find(d) != indexes.end()) )
+			continue;
+
+		indexes[d] = m_nodes.size();
+		Node* node = new Node;
+		node->m_decoder = d;
+		m_nodes.push_back(node);
+
+		for(size_t i=0; i<d->GetInputCount(); i++)
+			work.push_back(dynamic_cast<ProtocolDecoder*>(d->GetInput(i)));
+	}
+
+	//Hook each decoder up to its dirty inputs (counting an input used twice only once)
+	for(size_t i=0; i<m_nodes.size(); i++)
+	{
+		ProtocolDecoder* d = m_nodes[i]->m_decoder;
+
+		set<size_t> inputs;
+		for(size_t j=0; j<d->GetInputCount(); j++)
+		{
+			auto it = indexes.find(dynamic_cast<ProtocolDecoder*>(d->GetInput(j)));
+			if(it != indexes.end())
+				inputs.insert(it->second);
+		}
+
+		m_nodes[i]->m_pending = inputs.size();
+		for(auto n : inputs)
+			m_nodes[n]->m_consumers.push_back(i);
+	}
+}
+
+/**
+	@brief Adds a ready node to a worker's queue and wakes up an idle worker
+ */
+void DecoderScheduler::Push(size_t id, size_t node)
+{
+	{
+		lock_guard<mutex> lock(m_queues[id]->m_mutex);
+		m_queues[id]->m_nodes.push_back(node);
+	}
+	m_queued ++;
+
+	//Take the main mutex so a worker can't miss the wakeup between checking m_queued and going to sleep
+	{
+		lock_guard<mutex> lock(m_mutex);
+	}
+	m_workReady.notify_one();
+}
+
+/**
+	@brief Gets the next ready node, from our own queue if possible or else stolen from another worker
+ */
+bool DecoderScheduler::GetWork(size_t id, size_t& node)
+{
+	size_t nqueues = m_queues.size();
+	for(size_t i=0; i<nqueues; i++)
+	{
+		WorkQueue* q = m_queues[(id + i) % nqueues];
+		lock_guard<mutex> lock(q->m_mutex);
+		if(q->m_nodes.empty())
+			continue;
+
+		//Newest first from our own queue, oldest first when stealing
+		if(i == 0)
+		{
+			node = q->m_nodes.back();
+			q->m_nodes.pop_back();
+		}
+		else
+		{
+			node = q->m_nodes.front();
+			q->m_nodes.pop_front();
+		}
+
+		m_queued --;
+		return true;
+	}
+
+	return false;
+}
+
+void DecoderScheduler::RunNode(size_t id, size_t node)
+{
+	Node* n = m_nodes[node];
+	n->m_decoder->m_dirty = false;
+	n->m_decoder->RefreshWithCache();
+
+	//Anything waiting only on us is now ready to go
+	for(auto c : n->m_consumers)
+	{
+		if(--m_nodes[c]->m_pending == 0)
+			Push(id, c);
+	}
+
+	if(--m_remaining == 0)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_passDone.notify_all();
+	}
+}
+
+void DecoderScheduler::WorkerThread(size_t id)
+{
+	while(true)
+	{
+		size_t node;
+		if(GetWork(id, node))
+		{
+			RunNode(id, node);
+			continue;
+		}
+
+		unique_lock<mutex> lock(m_mutex);
+		while(!m_terminating && (m_queued == 0) )
+			m_workReady.wait(lock);
+		if(m_terminating)
+			return;
+	}
+}
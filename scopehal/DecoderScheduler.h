@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of DecoderScheduler
+ */
+
+#ifndef DecoderScheduler_h
+#define DecoderScheduler_h
+
+#include "ProtocolDecoder.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+/**
+	@brief Refreshes a graph of protocol decoders in parallel.
+
+	ProtocolDecoder::RefreshIfDirty() walks the graph depth-first on the calling thread, so independent decoders run
+	one after another. The scheduler instead finds every dirty decoder needed by the requested outputs, works out the
+	dependencies between them, and runs them on a pool of worker threads. Each decoder starts as soon as all of its
+	dirty inputs have finished, and a decoder feeding several others is refreshed exactly once.
+
+	Each worker has its own queue of ready decoders. A worker takes work from the back of its own queue first, so
+	a decoder's consumers tend to run on the thread that just produced their input. When its queue is empty it
+	steals from the front of another worker's queue.
+ */
+class DecoderScheduler
+{
+public:
+	DecoderScheduler(size_t nthreads = 0);
+	virtual ~DecoderScheduler();
+
+	void RefreshIfDirty(const std::vector<ProtocolDecoder*>& decoders);
+	void CompletePartialRefreshes(const std::vector<ProtocolDecoder*>& decoders);
+
+	size_t GetThreadCount()
+	{ return m_workers.size(); }
+
+	static DecoderScheduler& GetDefault();
+
+protected:
+	void RunPass(const std::vector<ProtocolDecoder*>& decoders);
+
+	///One decoder to be refreshed during the current pass
+	class Node
+	{
+	public:
+		Node()
+		: m_decoder(NULL)
+		, m_pending(0)
+		{}
+
+		ProtocolDecoder* m_decoder;
+
+		///Nodes consuming this node's output
+		std::vector<size_t> m_consumers;
+
+		///Number of this node's inputs which have not been refreshed yet
+		std::atomic<size_t> m_pending;
+	};
+
+	///Per-worker ready queue
+	class WorkQueue
+	{
+	public:
+		std::mutex m_mutex;
+		std::deque<size_t> m_nodes;
+	};
+
+	void BuildGraph(const std::vector<ProtocolDecoder*>& decoders);
+	void WorkerThread(size_t id);
+	bool GetWork(size_t id, size_t& node);
+	void RunNode(size_t id, size_t node);
+	void Push(size_t id, size_t node);
+
+	std::vector<std::thread> m_workers;
+	std::vector<WorkQueue*> m_queues;
+
+	///Nodes for the current pass
+	std::vector<Node*> m_nodes;
+
+	///Protects the pass state below and is used with the condition variables
+	std::mutex m_mutex;
+
+	///Signalled when new work is queued or the pool is shutting down
+	std::condition_variable m_workReady;
+
+	///Signalled when the last node of a pass completes
+	std::condition_variable m_passDone;
+
+	///Number of nodes in the current pass which have not finished yet
+	std::atomic<size_t> m_remaining;
+
+	///Number of nodes sitting in queues, not yet picked up by a worker
+	std::atomic<size_t> m_queued;
+
+	///Serializes calls to RefreshIfDirty() and CompletePartialRefreshes()
+	std::mutex m_passMutex;
+
+	bool m_terminating;
+};
+
+#endif
@@ -0,0 +1,248 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of EdgeDetector
+ */
+
+#include "scopehal.h"
+
+using namespace std;
+
+///Number of samples scanned by each thread
+static const size_t EDGE_CHUNK_SIZE = 262144;
+
+///Block size used to skip quickly over regions with no transitions
+static const size_t EDGE_BLOCK_SIZE = 64;
+
+///Serializes creation of per-capture caches
+static mutex g_edgeCacheCreateMutex;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public API
+
+/**
+	@brief Gets the times of all threshold crossings in an analog capture, in either direction
+
+	With zero hysteresis the results are identical to the old ProtocolDecoder::FindZeroCrossings(): a crossing is
+	any change in (value > threshold), and the first sample of the capture is ignored. With hysteresis, the state
+	only changes once the signal leaves the band threshold +/- hysteresis/2, but the crossing time is still
+	interpolated at the threshold itself.
+
+	@param cap			The capture to search
+	@param threshold	Crossing threshold
+	@param hysteresis	Width of the hysteresis band
+
+	@return Edge times in picoseconds
+ */
+EdgeListPtr EdgeDetector::FindZeroCrossings(AnalogCapture* cap, float threshold, float hysteresis)
+{
+	//A capture which hasn't been published through SetData() yet may still be filled or reused in place without
+	//its generation changing, so there's nothing we could safely key a cache on. Just compute the edges.
+	if(cap->m_generation == 0)
+	{
+		auto edges = make_shared< vector<int64_t> >();
+		Compute(cap, threshold, hysteresis, *edges);
+		return edges;
+	}
+
+	shared_ptr<CaptureEdgeCache> cache;
+	{
+		lock_guard<mutex> lock(g_edgeCacheCreateMutex);
+		if(cap->m_edgeCache == NULL)
+			cap->m_edgeCache = make_shared<CaptureEdgeCache>();
+		cache = cap->m_edgeCache;
+	}
+
+	//Hold the lock while computing so concurrent requests for the same edges wait rather than duplicate the work
+	lock_guard<mutex> lock(cache->m_mutex);
+
+	//Capture was updated in place, old results are stale
+	if(cache->m_generation != cap->m_generation)
+	{
+		cache->m_edges.clear();
+		cache->m_generation = cap->m_generation;
+	}
+
+	auto key = make_pair(threshold, hysteresis);
+	auto it = cache->m_edges.find(key);
+	if(it != cache->m_edges.end())
+		return it->second;
+
+	auto edges = make_shared< vector<int64_t> >();
+	Compute(cap, threshold, hysteresis, *edges);
+
+	EdgeListPtr ret = edges;
+	cache->m_edges[key] = ret;
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Edge detection
+
+void EdgeDetector::Compute(AnalogCapture* cap, float threshold, float hysteresis, vector<int64_t>& edges)
+{
+	//Sample 0 is ignored and sample 1 is the initial state, so we need at least three to find anything
+	size_t len = cap->m_samples.size();
+	if(len < 3)
+		return;
+
+	//Scan each chunk independently
+	const size_t first = 1;
+	size_t nchunks = (len - first + EDGE_CHUNK_SIZE - 1) / EDGE_CHUNK_SIZE;
+	vector<Chunk> chunks(nchunks);
+
+	#pragma omp parallel for if(nchunks > 1)
+	for(size_t i=0; i<nchunks; i++)
+	{
+		size_t start = first + i*EDGE_CHUNK_SIZE;
+		size_t end = min(len, start + EDGE_CHUNK_SIZE);
+		ScanChunk(cap, start, end, threshold, hysteresis, chunks[i]);
+	}
+
+	//Stitch the chunks together. Each chunk's first defined state is only an edge if it differs from the previous
+	//chunk's final state. Chunks entirely inside the hysteresis band don't change the state.
+	size_t total = 0;
+	for(auto& c : chunks)
+		total += c.m_edges.size() + 1;
+	edges.reserve(total);
+
+	bool known = false;
+	bool state = false;
+	for(auto& c : chunks)
+	{
+		if(c.m_firstDefined == SIZE_MAX)
+			continue;
+
+		if(known && (state != c.m_firstState))
+			edges.push_back(GetCrossingTime(cap, c.m_firstDefined, threshold, c.m_firstState));
+		edges.insert(edges.end(), c.m_edges.begin(), c.m_edges.end());
+
+		known = true;
+		state = c.m_finalState;
+	}
+}
+
+/**
+	@brief Finds edges within one chunk, starting from whatever state its first sample outside the band implies
+ */
+void EdgeDetector::ScanChunk(AnalogCapture* cap, size_t start, size_t end, float threshold, float hysteresis,
+	Chunk& chunk)
+{
+	float hi = threshold + hysteresis/2;
+	float lo = threshold - hysteresis/2;
+	auto& samples = cap->m_samples;
+
+	//Find the first sample with a definite state
+	size_t i = start;
+	for(; i<end; i++)
+	{
+		float v = samples[i];
+		if( (v > hi) || (v <= lo) )
+			break;
+	}
+	if(i >= end)
+		return;
+
+	bool state = (float)samples[i] > hi;
+	chunk.m_firstDefined = i;
+	chunk.m_firstState = state;
+	i++;
+
+	while(i < end)
+	{
+		//Skip whole blocks with nothing that could change the state
+		if(i + EDGE_BLOCK_SIZE <= end)
+		{
+			size_t nflip = 0;
+			size_t bend = i + EDGE_BLOCK_SIZE;
+			if(state)
+			{
+				#pragma omp simd reduction(+:nflip)
+				for(size_t k=i; k<bend; k++)
+					nflip += (samples[k].m_sample <= lo);
+			}
+			else
+			{
+				#pragma omp simd reduction(+:nflip)
+				for(size_t k=i; k<bend; k++)
+					nflip += (samples[k].m_sample > hi);
+			}
+
+			if(nflip == 0)
+			{
+				i = bend;
+				continue;
+			}
+		}
+
+		//Something happens in this block, go through it one sample at a time
+		size_t bend = min(end, i + EDGE_BLOCK_SIZE);
+		for(; i<bend; i++)
+		{
+			float v = samples[i];
+			if(state && (v <= lo) )
+			{
+				state = false;
+				chunk.m_edges.push_back(GetCrossingTime(cap, i, threshold, false));
+			}
+			else if(!state && (v > hi) )
+			{
+				state = true;
+				chunk.m_edges.push_back(GetCrossingTime(cap, i, threshold, true));
+			}
+		}
+	}
+
+	chunk.m_finalState = state;
+}
+
+/**
+	@brief Interpolates the time of a crossing detected at sample i.
+
+	With hysteresis, the signal may have crossed the threshold a few samples before it left the band, so look back
+	for the pair of samples which actually straddles the threshold.
+ */
+int64_t EdgeDetector::GetCrossingTime(AnalogCapture* cap, size_t i, float threshold, bool rising)
+{
+	size_t j = i;
+	while( (j > 2) && ( ((float)cap->m_samples[j-1] > threshold) == rising) )
+		j--;
+
+	//Start time of the sample, in picoseconds, moved to the middle of the sample
+	auto& s = cap->m_samples[j];
+	int64_t t = cap->m_triggerPhase + cap->m_timescale * s.m_offset;
+	t += cap->m_timescale/2;
+
+	//Interpolate the time
+	t += cap->m_timescale * Measurement::InterpolateTime(cap, j-1, threshold);
+	return t;
+}
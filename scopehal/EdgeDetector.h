@@ -0,0 +1,107 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of EdgeDetector
+ */
+
+#ifndef EdgeDetector_h
+#define EdgeDetector_h
+
+#include <mutex>
+
+///Shared, read-only list of edge times (in picoseconds)
+typedef std::shared_ptr< const std::vector<int64_t> > EdgeListPtr;
+
+/**
+	@brief Edge lists already found in one capture
+ */
+class CaptureEdgeCache
+{
+public:
+	CaptureEdgeCache()
+	: m_generation(0)
+	{}
+
+	std::mutex m_mutex;
+
+	///Generation of the capture when the lists were computed
+	uint64_t m_generation;
+
+	///Edge lists keyed by (threshold, hysteresis)
+	std::map< std::pair<float, float>, EdgeListPtr > m_edges;
+};
+
+/**
+	@brief Finds threshold crossings in analog captures, sharing the results between every consumer of the capture.
+
+	The first request for a given threshold and hysteresis computes the edge list, splitting the capture into
+	chunks which are scanned in parallel and then stitched together. Later requests for the same capture get the
+	same list back. The cache lives with the capture, so it is freed along with it.
+
+	Only captures published through OscilloscopeChannel::SetData() are cached, since SetData() is what gives a
+	capture a new generation number when it is updated in place. Captures that haven't been published yet (generation
+	zero) are scanned from scratch on every call.
+ */
+class EdgeDetector
+{
+public:
+	static EdgeListPtr FindZeroCrossings(AnalogCapture* cap, float threshold, float hysteresis = 0);
+
+protected:
+	static void Compute(AnalogCapture* cap, float threshold, float hysteresis, std::vector<int64_t>& edges);
+
+	///Results of scanning one chunk
+	class Chunk
+	{
+	public:
+		Chunk()
+		: m_firstDefined(SIZE_MAX)
+		, m_firstState(false)
+		, m_finalState(false)
+		{}
+
+		///Index of the first sample outside the hysteresis band (SIZE_MAX if none)
+		size_t m_firstDefined;
+
+		///State at m_firstDefined, and at the end of the chunk
+		bool m_firstState;
+		bool m_finalState;
+
+		///Edges after m_firstDefined
+		std::vector<int64_t> m_edges;
+	};
+
+	static void ScanChunk(AnalogCapture* cap, size_t start, size_t end, float threshold, float hysteresis, Chunk& chunk);
+	static int64_t GetCrossingTime(AnalogCapture* cap, size_t i, float threshold, bool rising);
+};
+
+#endif
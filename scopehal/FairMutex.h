@@ -0,0 +1,102 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of FairRecursiveMutex
+ */
+#ifndef FairMutex_h
+#define FairMutex_h
+
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+/**
+	@brief A recursive mutex which grants the lock to waiting threads in the order they asked for it.
+
+	std::recursive_mutex makes no fairness guarantees, so a thread which releases and immediately re-acquires the
+	lock in a loop (for example, polling an instrument for trigger status) can starve other threads indefinitely.
+
+	This is a ticket lock: each thread takes a number when it calls lock() and waits until that number is served.
+	Recursive locking by the owning thread does not take a new ticket.
+ */
+class FairRecursiveMutex
+{
+public:
+	FairRecursiveMutex()
+	: m_nextTicket(0)
+	, m_nowServing(0)
+	, m_depth(0)
+	{}
+
+	void lock()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if( (m_depth != 0) && (m_owner == std::this_thread::get_id()) )
+		{
+			m_depth ++;
+			return;
+		}
+
+		uint64_t ticket = m_nextTicket ++;
+		while(m_nowServing != ticket)
+			m_cond.wait(lock);
+
+		m_owner = std::this_thread::get_id();
+		m_depth = 1;
+	}
+
+	void unlock()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_depth --;
+		if(m_depth != 0)
+			return;
+
+		m_owner = std::thread::id();
+		m_nowServing ++;
+		m_cond.notify_all();
+	}
+
+protected:
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+
+	uint64_t m_nextTicket;
+	uint64_t m_nowServing;
+
+	std::thread::id m_owner;
+	unsigned int m_depth;
+};
+
+#endif
@@ -39,7 +39,7 @@ using namespace std;
 // Construction / destruction
 
 LeCroyOscilloscope::LeCroyOscilloscope(SCPITransport* transport)
-	: SCPIOscilloscope(transport)
+	: SCPIOscilloscope(transport, false)
 	, m_hasLA(false)
 	, m_hasDVM(false)
 	, m_hasFunctionGen(false)
@@ -50,9 +50,22 @@ LeCroyOscilloscope::LeCroyOscilloscope(SCPITransport* transport)
 	//standard initialization
 	FlushConfigCache();
 	IdentifyHardware();
-	DetectAnalogChannels();
-	SharedCtorInit();
-	DetectOptions();
+
+	//If we've seen this exact instrument before, skip capability detection and use the cached results
+	CapabilityCache::Entry entry;
+	if(CapabilityCache::Lookup(m_transport->GetConnectionString(), m_serial, m_model, m_fwVersion, entry))
+	{
+		AddAnalogChannels(entry.m_analogChannelCount);
+		SharedCtorInit();
+		ProcessOptions(entry.m_options);
+	}
+	else
+	{
+		DetectAnalogChannels();
+		SharedCtorInit();
+		DetectOptions();
+		UpdateCapabilityCache();
+	}
 }
 
 void LeCroyOscilloscope::SharedCtorInit()
@@ -87,21 +100,7 @@ void LeCroyOscilloscope::IdentifyHardware()
 	m_transport->SendCommand("CHDR OFF");
 
 	//Ask for the ID
-	m_transport->SendCommand("*IDN?");
-	string reply = m_transport->ReadReply();
-	char vendor[128] = "";
-	char model[128] = "";
-	char serial[128] = "";
-	char version[128] = "";
-	if(4 != sscanf(reply.c_str(), "%127[^,],%127[^,],%127[^,],%127s", vendor, model, serial, version))
-	{
-		LogError("Bad IDN response %s\n", reply.c_str());
-		return;
-	}
-	m_vendor = vendor;
-	m_model = model;
-	m_serial = serial;
-	m_fwVersion = version;
+	Identify();
 
 	//Look up model info
 	if(m_model.find("WS3") == 0)
@@ -127,19 +126,18 @@ void LeCroyOscilloscope::DetectOptions()
 	if(reply.length() > 3)
 	{
 		//Read options until we hit a null
-		vector<string> options;
 		string opt;
 		for(unsigned int i=0; i<reply.length(); i++)
 		{
 			if(reply[i] == 0)
 			{
-				options.push_back(opt);
+				m_options.push_back(opt);
 				break;
 			}
 
 			else if(reply[i] == ',')
 			{
-				options.push_back(opt);
+				m_options.push_back(opt);
 				opt = "";
 			}
 
@@ -151,53 +149,63 @@ void LeCroyOscilloscope::DetectOptions()
 				opt += reply[i];
 		}
 		if(opt != "")
-			options.push_back(opt);
+			m_options.push_back(opt);
+	}
 
-		//Print out the option list and do processing for each
-		LogDebug("Installed options:\n");
-		if(options.empty())
-			LogDebug("* None\n");
-		for(auto o : options)
-		{
-			//If we have an LA module installed, add the digital channels
-			if( (o == "MSXX") && !m_hasLA)
-			{
-				LogDebug("* MSXX (logic analyzer)\n");
-				AddDigitalChannels(16);
-			}
+	ProcessOptions(m_options);
+}
 
-			//If we have the voltmeter installed, make a note of that
-			else if(o == "DVM")
-			{
-				m_hasDVM = true;
-				LogDebug("* DVM (digital voltmeter / frequency counter)\n");
+/**
+	@brief Configures the driver based on the installed options
+ */
+void LeCroyOscilloscope::ProcessOptions(const vector<string>& options)
+{
+	m_options = options;
 
-				SetMeterAutoRange(false);
-			}
+	//Print out the option list and do processing for each
+	LogDebug("Installed options:\n");
+	if(options.empty())
+		LogDebug("* None\n");
+	for(auto o : options)
+	{
+		//If we have an LA module installed, add the digital channels
+		if( (o == "MSXX") && !m_hasLA)
+		{
+			LogDebug("* MSXX (logic analyzer)\n");
+			AddDigitalChannels(16);
+		}
 
-			//If we have the function generator installed, remember that
-			else if(o == "AFG")
-			{
-				m_hasFunctionGen = true;
-				LogDebug("* AFG (function generator)\n");
-			}
+		//If we have the voltmeter installed, make a note of that
+		else if(o == "DVM")
+		{
+			m_hasDVM = true;
+			LogDebug("* DVM (digital voltmeter / frequency counter)\n");
 
-			//Ignore protocol decodes, we do those ourselves
-			else if( (o == "I2C") || (o == "UART") || (o == "SPI") )
-			{
-				LogDebug("* %s (protocol decode, ignoring)\n", o.c_str());
-			}
+			SetMeterAutoRange(false);
+		}
 
-			//Ignore UI options
-			else if(o == "XWEB")
-			{
-				LogDebug("* %s (UI option, ignoring)\n", o.c_str());
-			}
+		//If we have the function generator installed, remember that
+		else if(o == "AFG")
+		{
+			m_hasFunctionGen = true;
+			LogDebug("* AFG (function generator)\n");
+		}
 
-			//No idea what it is
-			else
-				LogDebug("* %s (not yet implemented)\n", o.c_str());
+		//Ignore protocol decodes, we do those ourselves
+		else if( (o == "I2C") || (o == "UART") || (o == "SPI") )
+		{
+			LogDebug("* %s (protocol decode, ignoring)\n", o.c_str());
+		}
+
+		//Ignore UI options
+		else if(o == "XWEB")
+		{
+			LogDebug("* %s (UI option, ignoring)\n", o.c_str());
 		}
+
+		//No idea what it is
+		else
+			LogDebug("* %s (not yet implemented)\n", o.c_str());
 	}
 
 	//If we don't have a code for the LA software option, but are a -MS scope, add the LA
@@ -205,6 +213,21 @@ void LeCroyOscilloscope::DetectOptions()
 		AddDigitalChannels(16);
 }
 
+/**
+	@brief Saves the results of capability detection so we can skip it next time we connect
+ */
+void LeCroyOscilloscope::UpdateCapabilityCache()
+{
+	CapabilityCache::Entry entry;
+	entry.m_vendor = m_vendor;
+	entry.m_model = m_model;
+	entry.m_serial = m_serial;
+	entry.m_fwVersion = m_fwVersion;
+	entry.m_options = m_options;
+	entry.m_analogChannelCount = m_analogChannelCount;
+	CapabilityCache::Store(m_transport->GetConnectionString(), entry);
+}
+
 /**
 	@brief Creates digital channels for the oscilloscope
  */
@@ -271,7 +294,15 @@ void LeCroyOscilloscope::DetectAnalogChannels()
 	if(m_modelid == MODEL_DDA_5K)
 		nchans = 4;
 
-	for(int i=0; i<nchans; i++)
+	AddAnalogChannels(nchans);
+}
+
+/**
+	@brief Creates analog channels for the oscilloscope
+ */
+void LeCroyOscilloscope::AddAnalogChannels(unsigned int nchans)
+{
+	for(unsigned int i=0; i<nchans; i++)
 	{
 		//Hardware name of the channel
 		string chname = string("C1");
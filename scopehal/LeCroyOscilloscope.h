@@ -51,8 +51,11 @@ protected:
 	void IdentifyHardware();
 	void SharedCtorInit();
 	virtual void DetectAnalogChannels();
+	void AddAnalogChannels(unsigned int nchans);
 	void AddDigitalChannels(unsigned int count);
 	void DetectOptions();
+	void ProcessOptions(const std::vector<std::string>& options);
+	void UpdateCapabilityCache();
 
 public:
 	//Device information
@@ -166,13 +169,10 @@ protected:
 	unsigned int m_analogChannelCount;
 	unsigned int m_digitalChannelCount;
 
-	std::string m_vendor;
-	std::string m_model;
-	std::string m_serial;
-	std::string m_fwVersion;
 	Model m_modelid;
 
 	//set of SW/HW options we have
+	std::vector<std::string> m_options;
 	bool m_hasLA;
 	bool m_hasDVM;
 	bool m_hasFunctionGen;
@@ -42,6 +42,28 @@ Measurement::Measurement()
 
 Measurement::~Measurement()
 {
+	Profiler::GetDefault().Forget(this);
+}
+
+/**
+	@brief Recalculates the measurement, recording it with the profiler if profiling is enabled
+ */
+bool Measurement::Refresh()
+{
+	Profiler::Scope scope(Profiler::GetDefault());
+	bool ret = DoRefresh();
+	if(!scope.IsActive())
+		return ret;
+
+	uint64_t nin = 0;
+	for(auto c : m_channels)
+	{
+		if( (c != NULL) && (c->GetData() != NULL) )
+			nin += c->GetData()->GetDepth();
+	}
+
+	scope.Finish(this, GetMeasurementDisplayName(), nin, 0, 0);
+	return ret;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,7 +42,7 @@ public:
 	Measurement();
 	virtual ~Measurement();
 
-	virtual bool Refresh() =0;
+	bool Refresh();
 
 	virtual std::string GetValueAsString() =0;
 
@@ -96,6 +96,11 @@ public:
 	static Measurement* CreateMeasurement(std::string measurement);
 
 protected:
+	/**
+		@brief Recalculates the measurement. Called by Refresh(), which records it with the profiler.
+	 */
+	virtual bool DoRefresh() =0;
+
 	//Helpers for more complex measurements
 	//TODO: create some process for caching this so we don't waste CPU time
 	float GetMinVoltage(AnalogCapture* cap);
@@ -30,10 +30,262 @@
 #include "scopehal.h"
 #include "Multimeter.h"
 
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
 Multimeter::Multimeter()
+	: m_logRunning(false)
+	, m_logBlockSize(0)
+	, m_logSize(0)
+	, m_logWritePtr(0)
+	, m_logReaders(0)
+	, m_logRestarting(false)
 {
 }
 
 Multimeter::~Multimeter()
 {
+	//Derived classes should have stopped the logger already, since the thread calls their virtual functions.
+	//This is just a last resort so we don't destroy a joinable std::thread.
+	if(m_logThread.joinable())
+	{
+		m_logRunning = false;
+		m_logThread.join();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data logger
+
+/**
+	@brief Starts streaming readings into the log ring buffer on a background thread.
+
+	The meter is configured to take several readings per request, which are then fetched in bulk. This gets far more
+	readings per second than calling GetVoltage() etc in a loop, which is limited to one reading per round trip.
+
+	While logging is active the logging thread owns the instrument. Other meter calls shouldn't be made until
+	StopLogging() is called.
+
+	@param blocksize	Number of readings to fetch per request
+	@param depth		Capacity of the ring buffer, in readings (rounded up to a power of two)
+
+	@return True if logging started, false if the meter doesn't support it
+ */
+bool Multimeter::StartLogging(size_t blocksize, size_t depth)
+{
+	if(m_logThread.joinable())
+	{
+		if(m_logRunning)
+		{
+			LogWarning("Multimeter::StartLogging: already logging\n");
+			return true;
+		}
+
+		//The logger stopped by itself after a read error. Clean up after it before starting over.
+		StopLogging();
+	}
+
+	if(blocksize == 0)
+		blocksize = 1;
+	size_t size = 1;
+	while(size < depth)
+		size <<= 1;
+
+	if(!BeginLogging(blocksize))
+		return false;
+
+	m_logBlockSize = blocksize;
+
+	//Readers may still be copying out of the old buffer. Lock new ones out, and wait for the rest to finish
+	//before freeing it. The write pointer isn't reset, so positions held by existing subscribers stay meaningful.
+	m_logRestarting = true;
+	while(m_logReaders != 0)
+		this_thread::yield();
+	m_logBuffer.reset(new LogSlot[size]);
+	m_logSize = size;
+	m_logRestarting = false;
+
+	m_logRunning = true;
+	m_logThread = thread(&Multimeter::LoggingThread, this);
+	return true;
+}
+
+/**
+	@brief Stops the data logger and returns the meter to normal single-reading operation.
+
+	Readings already in the ring buffer remain available to ReadLog() until logging is started again.
+	Also cleans up after a logger that stopped by itself because of a read error.
+ */
+void Multimeter::StopLogging()
+{
+	if(!m_logThread.joinable())
+		return;
+
+	m_logRunning = false;
+	m_logThread.join();
+	EndLogging();
+}
+
+bool Multimeter::IsLogging()
+{
+	return m_logRunning;
+}
+
+/**
+	@brief Gets the position of the newest reading in the log.
+
+	A new subscriber that only wants readings from now on should start reading from this position.
+ */
+uint64_t Multimeter::GetLogPosition()
+{
+	return m_logWritePtr.load(memory_order_acquire);
+}
+
+/**
+	@brief Copies all readings logged since the given position.
+
+	Each subscriber keeps its own position, so any number of consumers can read the log concurrently. Readers never
+	block each other or the logging thread. A subscriber that falls more than one buffer behind loses the oldest
+	readings and skips ahead.
+
+	@param position	Position of the first reading wanted. Updated to the position after the last reading returned.
+	@param readings	Readings are appended here
+
+	@return Number of readings that were dropped because the subscriber fell behind
+ */
+size_t Multimeter::ReadLog(uint64_t& position, vector<MeterReading>& readings)
+{
+	//Don't touch the buffer while StartLogging() is replacing it. Nothing new has been logged yet anyway.
+	m_logReaders ++;
+	if(m_logRestarting)
+	{
+		m_logReaders --;
+		return 0;
+	}
+
+	size_t dropped = ReadLogLocked(position, readings);
+
+	m_logReaders --;
+	return dropped;
+}
+
+/**
+	@brief Does the work of ReadLog(). Must be called with m_logReaders held so the buffer can't be replaced.
+ */
+size_t Multimeter::ReadLogLocked(uint64_t& position, vector<MeterReading>& readings)
+{
+	size_t size = m_logSize;
+	if(size == 0)
+		return 0;
+
+	uint64_t wptr = m_logWritePtr.load(memory_order_acquire);
+
+	//A position past the end of the log can't have come from us. Start from the newest reading instead.
+	if(position > wptr)
+	{
+		position = wptr;
+		return 0;
+	}
+
+	//Skip anything that's already been overwritten
+	size_t dropped = 0;
+	if(wptr - position > size)
+	{
+		dropped = wptr - size - position;
+		position = wptr - size;
+	}
+
+	//If the logger laps us while we're copying, a slot will no longer hold the reading we want. Skip it.
+	for(uint64_t i=position; i<wptr; i++)
+	{
+		LogSlot& slot = m_logBuffer[i & (size-1)];
+		if(slot.m_position.load(memory_order_acquire) != i)
+		{
+			dropped ++;
+			continue;
+		}
+
+		MeterReading reading(slot.m_timestamp.load(memory_order_relaxed), slot.m_value.load(memory_order_relaxed));
+
+		atomic_thread_fence(memory_order_acquire);
+		if(slot.m_position.load(memory_order_relaxed) != i)
+		{
+			dropped ++;
+			continue;
+		}
+
+		readings.push_back(reading);
+	}
+
+	position = wptr;
+	return dropped;
+}
+
+/**
+	@brief Configures the instrument to take blocks of readings. Default implementation: logging not supported.
+ */
+bool Multimeter::BeginLogging(size_t /*blocksize*/)
+{
+	LogError("This multimeter doesn't support data logging\n");
+	return false;
+}
+
+/**
+	@brief Fetches the next block of readings from the instrument, oldest first.
+
+	@return False if the read failed and logging should stop
+ */
+bool Multimeter::ReadLogBlock(vector<double>& /*values*/)
+{
+	return false;
+}
+
+/**
+	@brief Returns the instrument to single-reading mode after logging
+ */
+void Multimeter::EndLogging()
+{
+}
+
+void Multimeter::LoggingThread()
+{
+	vector<double> values;
+	double tlast = GetTime();
+	size_t mask = m_logSize - 1;
+
+	while(m_logRunning)
+	{
+		values.clear();
+		if(!ReadLogBlock(values))
+		{
+			LogError("Multimeter data logger: read failed, stopping\n");
+			break;
+		}
+		double tnow = GetTime();
+
+		//We only know when the block arrived, so spread the readings evenly over the time since the last one.
+		//Each reading is published as soon as it's written, so readers only ever race with one slot.
+		size_t n = values.size();
+		uint64_t wptr = m_logWritePtr.load(memory_order_relaxed);
+		for(size_t i=0; i<n; i++)
+		{
+			double t = tlast + (tnow - tlast) * (i+1) / n;
+
+			//Invalidate the slot before touching the reading, and publish it again once done
+			LogSlot& slot = m_logBuffer[wptr & mask];
+			slot.m_position.store(UINT64_MAX, memory_order_relaxed);
+			atomic_thread_fence(memory_order_release);
+			slot.m_timestamp.store(t, memory_order_relaxed);
+			slot.m_value.store(values[i], memory_order_relaxed);
+			slot.m_position.store(wptr, memory_order_release);
+
+			wptr ++;
+			m_logWritePtr.store(wptr, memory_order_release);
+		}
+		tlast = tnow;
+	}
+
+	m_logRunning = false;
 }
@@ -29,6 +29,28 @@
 #ifndef Multimeter_h
 #define Multimeter_h
 
+#include <thread>
+#include <atomic>
+#include <memory>
+
+/**
+	@brief A single timestamped reading captured by the multimeter data logger
+ */
+class MeterReading
+{
+public:
+	MeterReading(double t = 0, double v = 0)
+	: m_timestamp(t)
+	, m_value(v)
+	{}
+
+	///Host time (as returned by GetTime()) at which the reading was taken
+	double m_timestamp;
+
+	///Value, in the units of the current meter mode
+	double m_value;
+};
+
 class Multimeter : public virtual Instrument
 {
 public:
@@ -72,6 +94,68 @@ public:
 	virtual double GetFrequency() =0;
 	virtual double GetCurrent() =0;
 	virtual double GetTemperature() =0;
+
+	//Streaming data logger
+	bool StartLogging(size_t blocksize = 100, size_t depth = 65536);
+	void StopLogging();
+	bool IsLogging();
+
+	uint64_t GetLogPosition();
+	size_t ReadLog(uint64_t& position, std::vector<MeterReading>& readings);
+
+protected:
+	//Driver hooks for the data logger
+	virtual bool BeginLogging(size_t blocksize);
+	virtual bool ReadLogBlock(std::vector<double>& values);
+	virtual void EndLogging();
+
+	void LoggingThread();
+	size_t ReadLogLocked(uint64_t& position, std::vector<MeterReading>& readings);
+
+	///Background thread pulling readings off the instrument
+	std::thread m_logThread;
+
+	///Set while the logging thread should keep running
+	std::atomic<bool> m_logRunning;
+
+	///Number of readings requested per block
+	size_t m_logBlockSize;
+
+	/**
+		@brief One slot of the log ring buffer.
+
+		m_position is the log position of the reading in the slot, or UINT64_MAX while it's being overwritten. The
+		logging thread publishes it with a release store after writing the reading, and readers check it before and
+		after copying the reading, so a slot overwritten mid-copy is detected rather than returned torn.
+	 */
+	class LogSlot
+	{
+	public:
+		LogSlot()
+		: m_position(UINT64_MAX)
+		, m_timestamp(0)
+		, m_value(0)
+		{}
+
+		std::atomic<uint64_t> m_position;
+		std::atomic<double> m_timestamp;
+		std::atomic<double> m_value;
+	};
+
+	///Ring buffer of readings
+	std::unique_ptr<LogSlot[]> m_logBuffer;
+
+	///Number of slots in m_logBuffer (a power of two)
+	size_t m_logSize;
+
+	///Total number of readings ever written to m_logBuffer. Keeps counting across restarts of the logger.
+	std::atomic<uint64_t> m_logWritePtr;
+
+	///Number of ReadLog() calls currently using m_logBuffer
+	std::atomic<unsigned int> m_logReaders;
+
+	///Set while StartLogging() is replacing m_logBuffer. ReadLog() doesn't touch the buffer while this is set.
+	std::atomic<bool> m_logRestarting;
 };
 
 #endif
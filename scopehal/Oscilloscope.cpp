@@ -152,6 +152,26 @@ bool Oscilloscope::HasPendingWaveforms()
 	return (m_pendingWaveforms.size() != 0);
 }
 
+/**
+	@brief Removes the oldest set of waveforms from the pending-waveform queue without applying it to the channels.
+
+	Ownership of the captures in the set passes to the caller.
+
+	@param set	Output set of waveforms
+
+	@return True if a set was removed, false if the queue was empty
+ */
+bool Oscilloscope::PopPendingWaveform(SequenceSet& set)
+{
+	lock_guard<mutex> lock(m_pendingWaveformsMutex);
+	if(m_pendingWaveforms.empty())
+		return false;
+
+	set = *m_pendingWaveforms.begin();
+	m_pendingWaveforms.pop_front();
+	return true;
+}
+
 /**
 	@brief Just like PollTrigger(), but checks the fifo instead
  */
@@ -298,39 +318,44 @@ void Oscilloscope::LoadConfiguration(const YAML::Node& node, IDTable& table)
 	//Load the channels
 	auto& chans = node["channels"];
 	for(auto it : chans)
-	{
-		auto& cnode = it.second;
-		auto chan = m_channels[cnode["index"].as<int>()];
-		table.emplace(cnode["id"].as<int>(), chan);
+		LoadChannelConfiguration(it.second, table);
+}
 
-		//Ignore name/type.
-		//These are only needed for offline scopes to create a representation of the original instrument.
+/**
+	@brief Load the configuration of a single channel from a save file
+ */
+void Oscilloscope::LoadChannelConfiguration(const YAML::Node& cnode, IDTable& table)
+{
+	auto chan = m_channels[cnode["index"].as<int>()];
+	table.emplace(cnode["id"].as<int>(), chan);
 
-		chan->m_displaycolor = cnode["color"].as<string>();
-		chan->m_displayname = cnode["nick"].as<string>();
+	//Ignore name/type.
+	//These are only needed for offline scopes to create a representation of the original instrument.
 
-		if(cnode["enabled"].as<int>())
-			chan->Enable();
-		else
-			chan->Disable();
+	chan->m_displaycolor = cnode["color"].as<string>();
+	chan->m_displayname = cnode["nick"].as<string>();
 
-		//only load AFE config for analog inputs
-		if(chan->GetType() == OscilloscopeChannel::CHANNEL_TYPE_ANALOG)
-		{
-			chan->SetAttenuation(cnode["attenuation"].as<float>());
-			chan->SetBandwidthLimit(cnode["bwlimit"].as<int>());
-			chan->SetVoltageRange(cnode["vrange"].as<float>());
-			chan->SetOffset(cnode["offset"].as<float>());
-
-			string coupling = cnode["coupling"].as<string>();
-			if(coupling == "dc_50")
-				chan->SetCoupling(OscilloscopeChannel::COUPLE_DC_50);
-			else if(coupling == "dc_1M")
-				chan->SetCoupling(OscilloscopeChannel::COUPLE_DC_1M);
-			else if(coupling == "ac_1M")
-				chan->SetCoupling(OscilloscopeChannel::COUPLE_AC_1M);
-			else if(coupling == "gnd")
-				chan->SetCoupling(OscilloscopeChannel::COUPLE_GND);
-		}
+	if(cnode["enabled"].as<int>())
+		chan->Enable();
+	else
+		chan->Disable();
+
+	//only load AFE config for analog inputs
+	if(chan->GetType() == OscilloscopeChannel::CHANNEL_TYPE_ANALOG)
+	{
+		chan->SetAttenuation(cnode["attenuation"].as<float>());
+		chan->SetBandwidthLimit(cnode["bwlimit"].as<int>());
+		chan->SetVoltageRange(cnode["vrange"].as<float>());
+		chan->SetOffset(cnode["offset"].as<float>());
+
+		string coupling = cnode["coupling"].as<string>();
+		if(coupling == "dc_50")
+			chan->SetCoupling(OscilloscopeChannel::COUPLE_DC_50);
+		else if(coupling == "dc_1M")
+			chan->SetCoupling(OscilloscopeChannel::COUPLE_DC_1M);
+		else if(coupling == "ac_1M")
+			chan->SetCoupling(OscilloscopeChannel::COUPLE_AC_1M);
+		else if(coupling == "gnd")
+			chan->SetCoupling(OscilloscopeChannel::COUPLE_GND);
 	}
 }
@@ -409,14 +409,19 @@ public:
 	 */
 	virtual void LoadConfiguration(const YAML::Node& node, IDTable& idmap);
 
+protected:
+	virtual void LoadChannelConfiguration(const YAML::Node& cnode, IDTable& idmap);
+
 public:
+	typedef std::map<OscilloscopeChannel*, CaptureChannelBase*> SequenceSet;
+
 	bool HasPendingWaveforms();
 	size_t GetPendingWaveformCount();
+	bool PopPendingWaveform(SequenceSet& set);
 	virtual Oscilloscope::TriggerMode PollTriggerFifo();
 	virtual bool AcquireDataFifo();
 
 protected:
-	typedef std::map<OscilloscopeChannel*, CaptureChannelBase*> SequenceSet;
 	std::list<SequenceSet> m_pendingWaveforms;
 	std::mutex m_pendingWaveformsMutex;
 
@@ -38,9 +38,13 @@
 #include "ChannelRenderer.h"
 #include "AnalogRenderer.h"
 #include "DigitalRenderer.h"
+#include "ProtocolDecoder.h"
 
 using namespace std;
 
+///Source of CaptureChannelBase::m_generation values
+static atomic<uint64_t> g_nextCaptureGeneration(1);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
@@ -206,8 +210,22 @@ CaptureChannelBase* OscilloscopeChannel::GetData()
 	return m_data;
 }
 
+/**
+	@brief Set new data, overwriting the old data as appropriate.
+
+	Everything downstream of this channel is marked dirty, even if the same capture object is passed in again
+	(since its contents may have been updated in place).
+
+	A capture being published for the first time, or updated in place, gets a new generation ID. A capture that was
+	published before (e.g. one restored from history) keeps its ID, so decoders can recognize it.
+ */
 void OscilloscopeChannel::SetData(CaptureChannelBase* pNew)
 {
+	MarkDownstreamDirty();
+
+	if( (pNew != NULL) && ( (pNew == m_data) || (pNew->m_generation == 0) ) )
+		pNew->m_generation = g_nextCaptureGeneration ++;
+
 	if(m_data == pNew)
 		return;
 
@@ -216,6 +234,56 @@ void OscilloscopeChannel::SetData(CaptureChannelBase* pNew)
 	m_data = pNew;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dependency tracking
+
+/**
+	@brief Records that a decoder is using this channel as an input. Called by ProtocolDecoder::SetInput().
+ */
+void OscilloscopeChannel::AddConsumer(ProtocolDecoder* decoder)
+{
+	m_consumers.push_back(decoder);
+}
+
+/**
+	@brief Removes one reference to a decoder from the consumer list
+ */
+void OscilloscopeChannel::RemoveConsumer(ProtocolDecoder* decoder)
+{
+	for(size_t i=0; i<m_consumers.size(); i++)
+	{
+		if(m_consumers[i] == decoder)
+		{
+			m_consumers.erase(m_consumers.begin() + i);
+			return;
+		}
+	}
+}
+
+/**
+	@brief Marks every decoder that depends on this channel, directly or indirectly, as dirty.
+
+	Decoders not downstream of this channel are left alone, so only the affected part of the graph is recomputed.
+ */
+void OscilloscopeChannel::MarkDownstreamDirty()
+{
+	set<ProtocolDecoder*> visited;
+	vector<ProtocolDecoder*> work = m_consumers;
+	while(!work.empty())
+	{
+		ProtocolDecoder* d = work.back();
+		work.pop_back();
+
+		if(visited.find(d) != visited.end())
+			continue;
+		visited.insert(d);
+
+		d->m_dirty = true;
+		for(auto c : d->m_consumers)
+			work.push_back(c);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factory methods
 
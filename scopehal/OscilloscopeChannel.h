@@ -40,6 +40,7 @@
 
 class ChannelRenderer;
 class Oscilloscope;
+class ProtocolDecoder;
 
 /**
 	@brief A single channel on the oscilloscope.
@@ -148,6 +149,15 @@ public:
 	virtual Unit GetYAxisUnits()
 	{ return m_yAxisUnit; }
 
+	//Decoders using this channel as an input
+	void AddConsumer(ProtocolDecoder* decoder);
+	void RemoveConsumer(ProtocolDecoder* decoder);
+
+	const std::vector<ProtocolDecoder*>& GetConsumers()
+	{ return m_consumers; }
+
+	void MarkDownstreamDirty();
+
 protected:
 
 	Oscilloscope* m_scope;
@@ -181,6 +191,9 @@ protected:
 
 	///Unit of measurement for our vertical axis
 	Unit m_yAxisUnit;
+
+	///Protocol decoders using this channel as an input (one entry per input it's connected to)
+	std::vector<ProtocolDecoder*> m_consumers;
 };
 
 #endif
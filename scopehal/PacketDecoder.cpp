@@ -30,9 +30,7 @@
 #include "scopehal.h"
 #include "PacketDecoder.h"
 
-Packet::~Packet()
-{
-}
+using namespace std;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
@@ -44,14 +42,28 @@ PacketDecoder::PacketDecoder(OscilloscopeChannel::ChannelType type, std::string
 
 PacketDecoder::~PacketDecoder()
 {
-	ClearPackets();
 }
 
+/**
+	@brief Discards all packets, keeping the table's memory for the next decode
+ */
 void PacketDecoder::ClearPackets()
 {
-	for(auto p : m_packets)
-		delete p;
-	m_packets.clear();
+	//GetHeaders() is virtual so we can't set up the schema in our constructor
+	if(m_packets.GetColumnCount() == 0)
+	{
+		m_packets.SetSchema(GetHeaders());
+		InitColumns();
+	}
+	else
+		m_packets.Clear();
+}
+
+/**
+	@brief Called once the packet table's schema has been created, to set up display formats etc.
+ */
+void PacketDecoder::InitColumns()
+{
 }
 
 bool PacketDecoder::GetShowDataColumn()
@@ -63,3 +75,61 @@ bool PacketDecoder::GetShowImageColumn()
 {
 	return false;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Export
+
+/**
+	@brief Gets the pcapng link type for our packets, or -1 if they can't be exported
+ */
+int PacketDecoder::GetPcapLinkType()
+{
+	return -1;
+}
+
+/**
+	@brief Writes our packets to a pcapng file
+
+	The default implementation writes the payload of each packet in the table.
+
+	@param writer	Output file
+	@param tbase	Start of the capture, in picoseconds after the writer's base second
+ */
+void PacketDecoder::WritePcap(PcapNGWriter& writer, int64_t tbase)
+{
+	for(size_t i=0; i<m_packets.size(); i++)
+		writer.WritePacket(tbase + m_packets.GetOffset(i), m_packets.GetPayload(i), m_packets.GetPayloadSize(i));
+}
+
+/**
+	@brief Writes the current decode to a pcapng file, without any UI
+
+	Packets are streamed straight from the decoder's output into the file.
+ */
+bool PacketDecoder::ExportPcapNG(const string& path)
+{
+	int linktype = GetPcapLinkType();
+	if(linktype < 0)
+	{
+		LogError("%s: packets can't be exported to pcapng\n", m_displayname.c_str());
+		return false;
+	}
+
+	auto data = GetData();
+	if(data == NULL)
+	{
+		LogError("%s: nothing to export\n", m_displayname.c_str());
+		return false;
+	}
+
+	PcapNGWriter writer;
+	if(!writer.Open(path, linktype, data->m_startTimestamp))
+		return false;
+	WritePcap(writer, data->m_startPicoseconds);
+	size_t count = writer.GetPacketCount();
+	if(!writer.Close())
+		return false;
+
+	LogDebug("%s: wrote %zu packets to %s\n", m_displayname.c_str(), count, path.c_str());
+	return true;
+}
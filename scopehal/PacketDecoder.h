@@ -31,28 +31,9 @@
 #define PacketDecoder_h
 
 #include "ProtocolDecoder.h"
-
-/**
-	@class
-	@brief Generic display representation for arbitrary packetized data
- */
-class Packet
-{
-public:
-	virtual ~Packet();
-
-	///Offset of the packet from the start of the capture (picoseconds)
-	int64_t m_offset;
-
-	///Duration time of the packet (picoseconds)
-	int64_t m_len;
-
-	//Arbitrary header properties (human readable)
-	std::map<std::string, std::string> m_headers;
-
-	//Packet bytes
-	std::vector<uint8_t> m_data;
-};
+#include "PacketTable.h"
+#include "PacketQuery.h"
+#include "PcapNGWriter.h"
 
 /**
 	@class
@@ -64,7 +45,7 @@ public:
 	PacketDecoder(OscilloscopeChannel::ChannelType type, std::string color, ProtocolDecoder::Category cat);
 	virtual ~PacketDecoder();
 
-	const std::vector<Packet*>& GetPackets()
+	const PacketTable& GetPackets()
 	{ return m_packets; }
 
 	virtual std::vector<std::string> GetHeaders() =0;
@@ -72,10 +53,17 @@ public:
 	virtual bool GetShowDataColumn();
 	virtual bool GetShowImageColumn();
 
+	//Export
+	virtual int GetPcapLinkType();
+	virtual void WritePcap(PcapNGWriter& writer, int64_t tbase);
+	bool ExportPcapNG(const std::string& path);
+
 protected:
 	void ClearPackets();
+	virtual void InitColumns();
 
-	std::vector<Packet*> m_packets;
+	///Decoded packets, one column per entry in GetHeaders()
+	PacketTable m_packets;
 };
 
 #endif
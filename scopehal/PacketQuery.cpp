@@ -0,0 +1,306 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of PacketQuery
+ */
+
+#include "scopehal.h"
+#include "PacketQuery.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PacketQueryResult
+
+/**
+	@brief Gets the table row of the Nth match
+
+	@return Row index, or SIZE_MAX if the table has changed since the query was run
+ */
+size_t PacketQueryResult::GetRow(size_t n) const
+{
+	if(!IsValid())
+		return SIZE_MAX;
+
+	size_t i = upper_bound(m_rangeStarts.begin(), m_rangeStarts.end(), n) - m_rangeStarts.begin() - 1;
+	return m_ranges[i].first + (n - m_rangeStarts[i]);
+}
+
+/**
+	@brief Gets the start time of the Nth match (picoseconds)
+
+	@return Start time, or -1 if the table has changed since the query was run
+ */
+int64_t PacketQueryResult::GetTime(size_t n) const
+{
+	size_t row = GetRow(n);
+	if(row == SIZE_MAX)
+		return -1;
+	return m_table->GetOffset(row);
+}
+
+/**
+	@brief Finds the first match starting at or after a given time
+
+	Packets are assumed to be in chronological order, as all decoders emit them.
+
+	@return Index of the match, or size() if there are none (or the table has changed since the query was run)
+ */
+size_t PacketQueryResult::FindFirstAfter(int64_t t) const
+{
+	if(!IsValid())
+		return m_count;
+
+	size_t low = 0;
+	size_t high = m_count;
+	while(low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+		if(GetTime(mid) < t)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Predicates
+
+void PacketQuery::Clear()
+{
+	m_predicates.clear();
+}
+
+/**
+	@brief Matches rows whose cell in a column equals a value
+
+	Integer cells match if the value parses as the same number (decimal, or hex with a 0x prefix). Enum and string
+	cells match on their text.
+ */
+void PacketQuery::AddEquals(const string& column, const string& value)
+{
+	Predicate p;
+	p.m_type = Predicate::PRED_EQUALS;
+	p.m_column = column;
+	p.m_value = value;
+	p.m_low = 0;
+	p.m_high = 0;
+	m_predicates.push_back(p);
+}
+
+/**
+	@brief Matches rows whose cell in a column is an integer in [low, high]
+ */
+void PacketQuery::AddRange(const string& column, int64_t low, int64_t high)
+{
+	Predicate p;
+	p.m_type = Predicate::PRED_RANGE;
+	p.m_column = column;
+	p.m_low = low;
+	p.m_high = high;
+	m_predicates.push_back(p);
+}
+
+/**
+	@brief Matches rows whose payload contains a byte sequence
+ */
+void PacketQuery::AddContains(const vector<uint8_t>& bytes)
+{
+	Predicate p;
+	p.m_type = Predicate::PRED_CONTAINS;
+	p.m_low = 0;
+	p.m_high = 0;
+	p.m_bytes = bytes;
+	m_predicates.push_back(p);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Evaluation
+
+/**
+	@brief Finds all rows matching every predicate
+
+	@return False if a predicate names a column the table doesn't have
+ */
+bool PacketQuery::Run(const PacketTable& table, PacketQueryResult& result) const
+{
+	result.m_table = &table;
+	result.m_generation = table.GetGeneration();
+	result.m_ranges.clear();
+	result.m_rangeStarts.clear();
+	result.m_count = 0;
+
+	//Start with every row selected
+	size_t nrows = table.size();
+	size_t nwords = (nrows + 63) / 64;
+	Bitmap matches(nwords, ~0ULL);
+	if(nrows % 64)
+		matches[nwords - 1] = (1ULL << (nrows % 64)) - 1;
+
+	Bitmap bits;
+	for(auto& p : m_predicates)
+	{
+		bits.assign(nwords, 0);
+
+		int col = -1;
+		if(p.m_type != Predicate::PRED_CONTAINS)
+		{
+			col = table.GetColumn(p.m_column);
+			if(col < 0)
+			{
+				LogError("PacketQuery: no column named \"%s\"\n", p.m_column.c_str());
+				return false;
+			}
+		}
+
+		switch(p.m_type)
+		{
+			case Predicate::PRED_EQUALS:
+				MatchEquals(table, col, p.m_value, bits);
+				break;
+
+			case Predicate::PRED_RANGE:
+				MatchKeys(table.GetColumnIndex(col), PacketTable::GetIntKey(p.m_low), PacketTable::GetIntKey(p.m_high), bits);
+				break;
+
+			case Predicate::PRED_CONTAINS:
+				MatchContains(table, p.m_bytes, bits);
+				break;
+		}
+
+		for(size_t i=0; i<nwords; i++)
+			matches[i] &= bits[i];
+	}
+
+	//Convert the bitmap to runs of consecutive rows
+	size_t runstart = SIZE_MAX;
+	for(size_t w=0; w<nwords; w++)
+	{
+		uint64_t word = matches[w];
+		size_t base = w * 64;
+
+		//Fast path for whole words in or out of a run
+		if( (word == 0) && (runstart == SIZE_MAX) )
+			continue;
+		if( (word == ~0ULL) && (runstart != SIZE_MAX) )
+			continue;
+
+		for(size_t b=0; b<64; b++)
+		{
+			bool hit = (word >> b) & 1;
+			if(hit && (runstart == SIZE_MAX) )
+				runstart = base + b;
+			else if(!hit && (runstart != SIZE_MAX) )
+			{
+				result.m_ranges.push_back(pair<size_t, size_t>(runstart, base + b));
+				runstart = SIZE_MAX;
+			}
+		}
+	}
+	if(runstart != SIZE_MAX)
+		result.m_ranges.push_back(pair<size_t, size_t>(runstart, nrows));
+
+	for(auto& r : result.m_ranges)
+	{
+		result.m_rangeStarts.push_back(result.m_count);
+		result.m_count += r.second - r.first;
+	}
+
+	return true;
+}
+
+/**
+	@brief Sets the bit for every row in an index with a key in [low, high]
+ */
+void PacketQuery::MatchKeys(const PacketTable::ColumnIndex& index, uint64_t low, uint64_t high, Bitmap& bits)
+{
+	auto it = lower_bound(index.begin(), index.end(), pair<uint64_t, uint32_t>(low, 0));
+	for(; (it != index.end()) && (it->first <= high); ++it)
+		bits[it->second / 64] |= (1ULL << (it->second % 64));
+}
+
+void PacketQuery::MatchEquals(const PacketTable& table, size_t col, const string& value, Bitmap& bits)
+{
+	auto& index = table.GetColumnIndex(col);
+
+	//Integer cells
+	if(!value.empty())
+	{
+		char* end = NULL;
+		long long n = strtoll(value.c_str(), &end, 0);
+		if(*end == '\0')
+		{
+			uint64_t key = PacketTable::GetIntKey(n);
+			MatchKeys(index, key, key, bits);
+		}
+	}
+
+	//Enum cells
+	uint32_t id;
+	if(table.FindEnum(value, id))
+	{
+		uint64_t key = PacketTable::GetEnumKey(id);
+		MatchKeys(index, key, key, bits);
+	}
+
+	//String cells. Keys are hashes so check each candidate.
+	uint64_t key = PacketTable::GetStringKey(value.c_str(), value.length());
+	auto it = lower_bound(index.begin(), index.end(), pair<uint64_t, uint32_t>(key, 0));
+	for(; (it != index.end()) && (it->first == key); ++it)
+	{
+		if(table.GetCellText(it->second, col) == value)
+			bits[it->second / 64] |= (1ULL << (it->second % 64));
+	}
+}
+
+void PacketQuery::MatchContains(const PacketTable& table, const vector<uint8_t>& bytes, Bitmap& bits)
+{
+	//Each thread owns whole words of the bitmap
+	size_t nrows = table.size();
+	size_t nwords = bits.size();
+
+	#pragma omp parallel for
+	for(size_t w=0; w<nwords; w++)
+	{
+		uint64_t word = 0;
+		size_t end = min(nrows, (w+1) * 64);
+		for(size_t row = w*64; row < end; row++)
+		{
+			const uint8_t* data = table.GetPayload(row);
+			const uint8_t* dend = data + table.GetPayloadSize(row);
+			if(bytes.empty() || (search(data, dend, bytes.begin(), bytes.end()) != dend) )
+				word |= (1ULL << (row % 64));
+		}
+		bits[w] = word;
+	}
+}
@@ -0,0 +1,138 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of PacketQuery
+ */
+
+#ifndef PacketQuery_h
+#define PacketQuery_h
+
+#include "PacketTable.h"
+
+/**
+	@brief Rows of a PacketTable matching a PacketQuery
+
+	Matches are stored as runs of consecutive rows, so the Nth match (or the first match after a given time) can be
+	found with a binary search.
+
+	A result refers to rows of the table it was computed from. Once the decoder runs again and clears its table, the
+	result is stale: IsValid() returns false and the accessors return "not found" values rather than rows of the new
+	decode. A result must not outlive the decoder that owns the table.
+ */
+class PacketQueryResult
+{
+public:
+	PacketQueryResult()
+	: m_table(NULL)
+	, m_generation(0)
+	, m_count(0)
+	{}
+
+	///True if the table still holds the packets this result was computed from
+	bool IsValid() const
+	{ return (m_table != NULL) && (m_table->GetGeneration() == m_generation); }
+
+	///Number of matching rows
+	size_t size() const
+	{ return m_count; }
+
+	bool empty() const
+	{ return m_count == 0; }
+
+	///Matching rows, as half-open [first, last) ranges in ascending order
+	const std::vector< std::pair<size_t, size_t> >& GetRanges() const
+	{ return m_ranges; }
+
+	size_t GetRow(size_t n) const;
+	int64_t GetTime(size_t n) const;
+	size_t FindFirstAfter(int64_t t) const;
+
+protected:
+	friend class PacketQuery;
+
+	const PacketTable* m_table;
+
+	///Generation of m_table when the query was run
+	uint64_t m_generation;
+
+	std::vector< std::pair<size_t, size_t> > m_ranges;
+
+	///Number of matches before each range
+	std::vector<size_t> m_rangeStarts;
+
+	size_t m_count;
+};
+
+/**
+	@brief A set of predicates over the output of a PacketDecoder, all of which must match
+
+	Column predicates use the table's per-column indexes, which are built the first time a column is queried.
+ */
+class PacketQuery
+{
+public:
+	void Clear();
+
+	void AddEquals(const std::string& column, const std::string& value);
+	void AddRange(const std::string& column, int64_t low, int64_t high);
+	void AddContains(const std::vector<uint8_t>& bytes);
+
+	bool Run(const PacketTable& table, PacketQueryResult& result) const;
+
+protected:
+	class Predicate
+	{
+	public:
+		enum Type
+		{
+			PRED_EQUALS,
+			PRED_RANGE,
+			PRED_CONTAINS
+		} m_type;
+
+		std::string m_column;
+		std::string m_value;
+		int64_t m_low;
+		int64_t m_high;
+		std::vector<uint8_t> m_bytes;
+	};
+
+	typedef std::vector<uint64_t> Bitmap;
+
+	static void MatchKeys(const PacketTable::ColumnIndex& index, uint64_t low, uint64_t high, Bitmap& bits);
+	static void MatchEquals(const PacketTable& table, size_t col, const std::string& value, Bitmap& bits);
+	static void MatchContains(const PacketTable& table, const std::vector<uint8_t>& bytes, Bitmap& bits);
+
+	std::vector<Predicate> m_predicates;
+};
+
+#endif
@@ -0,0 +1,397 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of PacketTable
+ */
+
+#include "scopehal.h"
+#include "PacketTable.h"
+#include <cstring>
+#include <atomic>
+
+using namespace std;
+
+///Source of PacketTable::m_generation values
+static atomic<uint64_t> g_nextTableGeneration(1);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+PacketTable::PacketTable()
+	: m_rows(0)
+	, m_open(false)
+	, m_generation(g_nextTableGeneration ++)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Schema
+
+/**
+	@brief Sets the column names and discards all packets
+ */
+void PacketTable::SetSchema(const vector<string>& headers)
+{
+	m_headers = headers;
+	m_intFormats.assign(headers.size(), "%" PRId64);
+	m_columns.resize(headers.size());
+	m_indexes.resize(headers.size());
+	m_indexRows.resize(headers.size());
+	Clear();
+}
+
+/**
+	@brief Looks up a column by name
+
+	@return Column index, or -1 if there is no such column
+ */
+int PacketTable::GetColumn(const string& name) const
+{
+	for(size_t i=0; i<m_headers.size(); i++)
+	{
+		if(m_headers[i] == name)
+			return i;
+	}
+	return -1;
+}
+
+/**
+	@brief Sets the printf format used to display integer cells in a column
+
+	The format must consume a single int64_t (for example "%04" PRIx64).
+ */
+void PacketTable::SetIntFormat(size_t col, const char* format)
+{
+	if(col < m_intFormats.size())
+		m_intFormats[col] = format;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Building
+
+/**
+	@brief Discards all packets without releasing any memory
+ */
+void PacketTable::Clear()
+{
+	for(auto& c : m_columns)
+		c.clear();
+	m_offsets.clear();
+	m_lengths.clear();
+	m_payloadStarts.clear();
+	m_payload.clear();
+	m_strings.clear();
+	m_rows = 0;
+	m_open = false;
+	m_generation = g_nextTableGeneration ++;
+
+	for(auto& i : m_indexes)
+		i.clear();
+	m_indexRows.assign(m_indexRows.size(), SIZE_MAX);
+}
+
+/**
+	@brief Starts a new packet, abandoning any packet that was not finished
+
+	@param offset	Start time of the packet (picoseconds)
+ */
+void PacketTable::BeginPacket(int64_t offset)
+{
+	if(m_open)
+		AbortPacket();
+
+	for(auto& c : m_columns)
+		c.push_back(0);
+	m_offsets.push_back(offset);
+	m_lengths.push_back(0);
+	m_payloadStarts.push_back(m_payload.size());
+	m_open = true;
+}
+
+/**
+	@brief Finishes the current packet
+
+	@param len		Duration of the packet (picoseconds)
+ */
+void PacketTable::EndPacket(int64_t len)
+{
+	if(!m_open)
+		return;
+
+	m_lengths.back() = len;
+	m_rows ++;
+	m_open = false;
+}
+
+/**
+	@brief Throws away the current packet and everything that was added to it
+ */
+void PacketTable::AbortPacket()
+{
+	if(!m_open)
+		return;
+
+	//Strings belonging to the packet are always at the end of the arena
+	size_t strend = m_strings.size();
+	for(auto& c : m_columns)
+	{
+		uint64_t cell = c.back();
+		if( (cell >> TAG_SHIFT) == CELL_STRING)
+			strend = min(strend, static_cast<size_t>( (cell & VALUE_MASK) >> STRING_LEN_BITS));
+		c.pop_back();
+	}
+	m_strings.resize(strend);
+
+	m_payload.resize(m_payloadStarts.back());
+	m_offsets.pop_back();
+	m_lengths.pop_back();
+	m_payloadStarts.pop_back();
+	m_open = false;
+}
+
+void PacketTable::SetOffset(int64_t offset)
+{
+	if(m_open)
+		m_offsets.back() = offset;
+}
+
+void PacketTable::SetLength(int64_t len)
+{
+	if(m_open)
+		m_lengths.back() = len;
+}
+
+void PacketTable::SetCell(size_t col, uint64_t cell)
+{
+	if(!m_open || (col >= m_columns.size()) )
+		return;
+	m_columns[col].back() = cell;
+}
+
+void PacketTable::SetInt(size_t col, int64_t value)
+{
+	SetCell(col, (static_cast<uint64_t>(CELL_INT) << TAG_SHIFT) | (static_cast<uint64_t>(value) & VALUE_MASK));
+}
+
+/**
+	@brief Sets a cell to one of a small set of strings that repeat across many packets
+ */
+void PacketTable::SetEnum(size_t col, const char* value)
+{
+	SetCell(col, (static_cast<uint64_t>(CELL_ENUM) << TAG_SHIFT) | Intern(value));
+}
+
+/**
+	@brief Sets a cell to a string that is specific to this packet
+ */
+void PacketTable::SetString(size_t col, const char* value)
+{
+	if(!m_open || (col >= m_columns.size()) )
+		return;
+
+	size_t len = min(strlen(value), static_cast<size_t>(STRING_MAX_LEN));
+	uint64_t start = m_strings.size();
+	m_strings.insert(m_strings.end(), value, value + len);
+
+	SetCell(col, (static_cast<uint64_t>(CELL_STRING) << TAG_SHIFT) | (start << STRING_LEN_BITS) | len);
+}
+
+void PacketTable::SetString(size_t col, const string& value)
+{
+	SetString(col, value.c_str());
+}
+
+uint32_t PacketTable::Intern(const char* value)
+{
+	string s(value);
+	auto it = m_enumIndex.find(s);
+	if(it != m_enumIndex.end())
+		return it->second;
+
+	uint32_t id = m_enums.size();
+	m_enums.push_back(s);
+	m_enumIndex[s] = id;
+	return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Access
+
+/**
+	@brief Gets the value of an integer cell (0 for any other type)
+ */
+int64_t PacketTable::GetInt(size_t row, size_t col) const
+{
+	uint64_t cell = m_columns[col][row];
+	if( (cell >> TAG_SHIFT) != CELL_INT)
+		return 0;
+
+	//Sign extend from 62 bits
+	return static_cast<int64_t>(cell << (64 - TAG_SHIFT)) >> (64 - TAG_SHIFT);
+}
+
+/**
+	@brief Formats a cell for display
+ */
+string PacketTable::GetCellText(size_t row, size_t col) const
+{
+	uint64_t cell = m_columns[col][row];
+	uint64_t value = cell & VALUE_MASK;
+	switch(cell >> TAG_SHIFT)
+	{
+		case CELL_INT:
+			{
+				char tmp[64];
+				snprintf(tmp, sizeof(tmp), m_intFormats[col].c_str(), GetInt(row, col));
+				return tmp;
+			}
+
+		case CELL_ENUM:
+			return m_enums[value];
+
+		case CELL_STRING:
+			return string(m_strings.data() + (value >> STRING_LEN_BITS), value & STRING_MAX_LEN);
+
+		case CELL_EMPTY:
+		default:
+			return "";
+	}
+}
+
+/**
+	@brief Gets the memory allocated by the table, including capacity held for reuse
+ */
+size_t PacketTable::GetMemoryUsage() const
+{
+	size_t ret = 0;
+	for(auto& c : m_columns)
+		ret += c.capacity() * sizeof(uint64_t);
+	ret += m_offsets.capacity() * sizeof(int64_t);
+	ret += m_lengths.capacity() * sizeof(int64_t);
+	ret += m_payloadStarts.capacity() * sizeof(size_t);
+	ret += m_payload.capacity();
+	ret += m_strings.capacity();
+	for(auto& i : m_indexes)
+		ret += i.capacity() * sizeof(pair<uint64_t, uint32_t>);
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Indexing
+
+/**
+	@brief Gets the index key for an integer cell
+
+	Keys of each type sort together, and integer keys sort in numeric order.
+ */
+uint64_t PacketTable::GetIntKey(int64_t value)
+{
+	uint64_t biased = (static_cast<uint64_t>(value) + (1ULL << (TAG_SHIFT - 1))) & VALUE_MASK;
+	return (static_cast<uint64_t>(CELL_INT) << TAG_SHIFT) | biased;
+}
+
+uint64_t PacketTable::GetEnumKey(uint32_t id)
+{
+	return (static_cast<uint64_t>(CELL_ENUM) << TAG_SHIFT) | id;
+}
+
+/**
+	@brief Gets the index key for a string cell
+
+	The key is a hash, so rows found by key must be checked against the actual text.
+ */
+uint64_t PacketTable::GetStringKey(const char* value, size_t len)
+{
+	//FNV-1a
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(size_t i=0; i<len; i++)
+	{
+		hash ^= static_cast<uint8_t>(value[i]);
+		hash *= 0x100000001b3ULL;
+	}
+	return (static_cast<uint64_t>(CELL_STRING) << TAG_SHIFT) | (hash & VALUE_MASK);
+}
+
+/**
+	@brief Looks up an interned enum string without adding it
+ */
+bool PacketTable::FindEnum(const string& value, uint32_t& id) const
+{
+	auto it = m_enumIndex.find(value);
+	if(it == m_enumIndex.end())
+		return false;
+	id = it->second;
+	return true;
+}
+
+/**
+	@brief Gets the sorted (key, row) index for a column, building it if the table has changed since the last call
+
+	Empty cells are not indexed.
+ */
+const PacketTable::ColumnIndex& PacketTable::GetColumnIndex(size_t col) const
+{
+	auto& index = m_indexes[col];
+	if(m_indexRows[col] == m_rows)
+		return index;
+
+	auto& cells = m_columns[col];
+	index.clear();
+	index.reserve(m_rows);
+	for(size_t i=0; i<m_rows; i++)
+	{
+		uint64_t cell = cells[i];
+		uint64_t value = cell & VALUE_MASK;
+		switch(cell >> TAG_SHIFT)
+		{
+			case CELL_INT:
+				index.push_back(pair<uint64_t, uint32_t>(GetIntKey(GetInt(i, col)), i));
+				break;
+
+			case CELL_ENUM:
+				index.push_back(pair<uint64_t, uint32_t>(cell, i));
+				break;
+
+			case CELL_STRING:
+				index.push_back(pair<uint64_t, uint32_t>(
+					GetStringKey(m_strings.data() + (value >> STRING_LEN_BITS), value & STRING_MAX_LEN), i));
+				break;
+
+			default:
+				break;
+		}
+	}
+	sort(index.begin(), index.end());
+
+	m_indexRows[col] = m_rows;
+	return index;
+}
@@ -0,0 +1,198 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of PacketTable
+ */
+
+#ifndef PacketTable_h
+#define PacketTable_h
+
+#include <unordered_map>
+#include <cinttypes>
+
+/**
+	@brief Column-oriented storage for the output of a PacketDecoder
+
+	Each header named by PacketDecoder::GetHeaders() is one column. Cells are 64-bit words tagged with their type:
+	integers (formatted for display on demand), enumerated strings (interned once per table and shared by every row),
+	or short strings (stored in a single arena). Payload bytes for every packet live in a second arena.
+
+	Packets are built one at a time with BeginPacket() / Set*() / EndPacket(). Only finished packets are counted by
+	size(), so a decoder may abandon a partial packet with AbortPacket().
+
+	Clear() keeps all allocations for reuse, so releasing a decode of any size does not free anything.
+ */
+class PacketTable
+{
+public:
+	PacketTable();
+
+	enum CellType
+	{
+		CELL_EMPTY,
+		CELL_INT,
+		CELL_ENUM,
+		CELL_STRING
+	};
+
+	//Schema
+	void SetSchema(const std::vector<std::string>& headers);
+
+	const std::vector<std::string>& GetHeaders() const
+	{ return m_headers; }
+
+	size_t GetColumnCount() const
+	{ return m_headers.size(); }
+
+	int GetColumn(const std::string& name) const;
+
+	void SetIntFormat(size_t col, const char* format);
+
+	//Building
+	void Clear();
+	void BeginPacket(int64_t offset);
+	void EndPacket(int64_t len);
+	void AbortPacket();
+
+	bool IsPacketOpen() const
+	{ return m_open; }
+
+	void SetOffset(int64_t offset);
+	void SetLength(int64_t len);
+	void SetInt(size_t col, int64_t value);
+	void SetEnum(size_t col, const char* value);
+	void SetString(size_t col, const char* value);
+	void SetString(size_t col, const std::string& value);
+
+	void AppendPayload(uint8_t b)
+	{ m_payload.push_back(b); }
+
+	void AppendPayload(const uint8_t* data, size_t len)
+	{ m_payload.insert(m_payload.end(), data, data + len); }
+
+	//Access. Row indexes up to and including the open packet (if any) are valid.
+	size_t size() const
+	{ return m_rows; }
+
+	bool empty() const
+	{ return m_rows == 0; }
+
+	///Changes every time the table is cleared, so anything computed from its rows can tell when it's stale
+	uint64_t GetGeneration() const
+	{ return m_generation; }
+
+	int64_t GetOffset(size_t row) const
+	{ return m_offsets[row]; }
+
+	int64_t GetLength(size_t row) const
+	{ return m_lengths[row]; }
+
+	const uint8_t* GetPayload(size_t row) const
+	{ return m_payload.data() + m_payloadStarts[row]; }
+
+	size_t GetPayloadSize(size_t row) const
+	{
+		size_t end = (row + 1 < m_payloadStarts.size()) ? m_payloadStarts[row + 1] : m_payload.size();
+		return end - m_payloadStarts[row];
+	}
+
+	CellType GetCellType(size_t row, size_t col) const
+	{ return static_cast<CellType>(m_columns[col][row] >> TAG_SHIFT); }
+
+	int64_t GetInt(size_t row, size_t col) const;
+	std::string GetCellText(size_t row, size_t col) const;
+
+	size_t GetMemoryUsage() const;
+
+	//Indexing
+	typedef std::vector< std::pair<uint64_t, uint32_t> > ColumnIndex;
+	const ColumnIndex& GetColumnIndex(size_t col) const;
+	bool FindEnum(const std::string& value, uint32_t& id) const;
+
+	static uint64_t GetIntKey(int64_t value);
+	static uint64_t GetEnumKey(uint32_t id);
+	static uint64_t GetStringKey(const char* value, size_t len);
+
+protected:
+	uint32_t Intern(const char* value);
+	void SetCell(size_t col, uint64_t cell);
+
+	static const int TAG_SHIFT = 62;
+	static const uint64_t VALUE_MASK = (1ULL << TAG_SHIFT) - 1;
+
+	//Short strings are stored as a 40-bit arena offset and a 22-bit length
+	static const int STRING_LEN_BITS = 22;
+	static const uint64_t STRING_MAX_LEN = (1ULL << STRING_LEN_BITS) - 1;
+
+	///Column names
+	std::vector<std::string> m_headers;
+
+	///printf format for integer cells in each column
+	std::vector<std::string> m_intFormats;
+
+	///Cells, one vector per column
+	std::vector< std::vector<uint64_t> > m_columns;
+
+	///Packet timestamps (picoseconds)
+	std::vector<int64_t> m_offsets;
+	std::vector<int64_t> m_lengths;
+
+	///Index of each packet's first byte in m_payload
+	std::vector<size_t> m_payloadStarts;
+
+	///Payload bytes for all packets
+	std::vector<uint8_t> m_payload;
+
+	///Characters for all string cells
+	std::vector<char> m_strings;
+
+	///Interned enum strings. These survive Clear() since decoders reuse the same few values every time.
+	std::vector<std::string> m_enums;
+	std::unordered_map<std::string, uint32_t> m_enumIndex;
+
+	///Sorted (key, row) pairs for each column, built on first use. Not thread safe.
+	mutable std::vector<ColumnIndex> m_indexes;
+
+	///Number of rows covered by each index, or SIZE_MAX if it needs to be rebuilt
+	mutable std::vector<size_t> m_indexRows;
+
+	///Number of finished packets
+	size_t m_rows;
+
+	///True if a packet has been started but not finished
+	bool m_open;
+
+	///Unique across all tables, see GetGeneration()
+	uint64_t m_generation;
+};
+
+#endif
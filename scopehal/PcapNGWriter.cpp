@@ -0,0 +1,249 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of PcapNGWriter
+ */
+
+#include "scopehal.h"
+#include "PcapNGWriter.h"
+#include <cstring>
+
+using namespace std;
+
+//Buffer is flushed once it's at least this big
+static const size_t PCAPNG_FLUSH_SIZE = 4 * 1024 * 1024;
+
+//Block types
+static const uint32_t PCAPNG_SHB = 0x0a0d0d0a;
+static const uint32_t PCAPNG_IDB = 0x00000001;
+static const uint32_t PCAPNG_EPB = 0x00000006;
+
+//Interface description block options
+static const uint16_t PCAPNG_OPT_ENDOFOPT = 0;
+static const uint16_t PCAPNG_IF_TSRESOL = 9;
+static const uint16_t PCAPNG_IF_TSOFFSET = 14;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+PcapNGWriter::PcapNGWriter()
+	: m_fp(NULL)
+	, m_blockStart(SIZE_MAX)
+	, m_packets(0)
+	, m_error(false)
+{
+}
+
+PcapNGWriter::~PcapNGWriter()
+{
+	Close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File management
+
+/**
+	@brief Creates the file and writes the section header and interface description
+
+	@param path		Output file
+	@param linktype	Link-layer header type of every packet
+	@param base		Timestamps passed to BeginPacket() are picoseconds after the start of this second
+ */
+bool PcapNGWriter::Open(const string& path, uint16_t linktype, time_t base)
+{
+	Close();
+
+	m_fp = fopen(path.c_str(), "wb");
+	if(!m_fp)
+	{
+		LogError("PcapNGWriter: couldn't create %s\n", path.c_str());
+		return false;
+	}
+
+	m_buffer.clear();
+	m_buffer.reserve(PCAPNG_FLUSH_SIZE + 65536);
+	m_packets = 0;
+	m_error = false;
+
+	//Section header block (native byte order, unknown section length)
+	Write32(PCAPNG_SHB);
+	Write32(28);
+	Write32(0x1a2b3c4d);
+	Write16(1);
+	Write16(0);
+	Write32(0xffffffff);
+	Write32(0xffffffff);
+	Write32(28);
+
+	//Interface description block
+	size_t start = m_buffer.size();
+	Write32(PCAPNG_IDB);
+	Write32(0);
+	Write16(linktype);
+	Write16(0);
+	Write32(0);				//no snap length
+
+	Write16(PCAPNG_IF_TSRESOL);
+	Write16(1);
+	Append(12);				//10^-12 s
+	Pad();
+
+	int64_t offset = base;
+	Write16(PCAPNG_IF_TSOFFSET);
+	Write16(8);
+	Append(reinterpret_cast<const uint8_t*>(&offset), 8);
+
+	Write16(PCAPNG_OPT_ENDOFOPT);
+	Write16(0);
+
+	uint32_t len = m_buffer.size() - start + 4;
+	Write32(len);
+	Patch32(start + 4, len);
+
+	return Flush();
+}
+
+/**
+	@brief Flushes and closes the file
+
+	@return False if any write failed
+ */
+bool PcapNGWriter::Close()
+{
+	if(!m_fp)
+		return true;
+
+	AbortPacket();
+	Flush();
+	if(0 != fclose(m_fp))
+		m_error = true;
+	m_fp = NULL;
+
+	return !m_error;
+}
+
+bool PcapNGWriter::Flush()
+{
+	if(!m_buffer.empty() && (m_fp != NULL) )
+	{
+		if(m_buffer.size() != fwrite(&m_buffer[0], 1, m_buffer.size(), m_fp))
+		{
+			if(!m_error)
+				LogError("PcapNGWriter: write failed\n");
+			m_error = true;
+		}
+	}
+	m_buffer.clear();
+	return !m_error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Packet assembly
+
+/**
+	@brief Starts an enhanced packet block. Packet data is added with Append().
+
+	@param timestamp	Picoseconds since the base second passed to Open()
+ */
+void PcapNGWriter::BeginPacket(int64_t timestamp)
+{
+	AbortPacket();
+
+	uint64_t ts = (timestamp < 0) ? 0 : timestamp;
+
+	m_blockStart = m_buffer.size();
+	Write32(PCAPNG_EPB);
+	Write32(0);				//block length, patched later
+	Write32(0);				//interface ID
+	Write32(ts >> 32);
+	Write32(ts & 0xffffffff);
+	Write32(0);				//captured length, patched later
+	Write32(0);				//original length, patched later
+}
+
+/**
+	@brief Finishes the current packet and writes it out if the buffer is full
+ */
+void PcapNGWriter::EndPacket()
+{
+	if(m_blockStart == SIZE_MAX)
+		return;
+
+	uint32_t caplen = m_buffer.size() - (m_blockStart + 28);
+	Pad();
+	uint32_t len = m_buffer.size() - m_blockStart + 4;
+	Write32(len);
+
+	Patch32(m_blockStart + 4, len);
+	Patch32(m_blockStart + 20, caplen);
+	Patch32(m_blockStart + 24, caplen);
+
+	m_blockStart = SIZE_MAX;
+	m_packets ++;
+
+	if(m_buffer.size() >= PCAPNG_FLUSH_SIZE)
+		Flush();
+}
+
+/**
+	@brief Discards the current packet
+ */
+void PcapNGWriter::AbortPacket()
+{
+	if(m_blockStart == SIZE_MAX)
+		return;
+
+	m_buffer.resize(m_blockStart);
+	m_blockStart = SIZE_MAX;
+}
+
+void PcapNGWriter::Write32(uint32_t v)
+{
+	Append(reinterpret_cast<const uint8_t*>(&v), 4);
+}
+
+void PcapNGWriter::Write16(uint16_t v)
+{
+	Append(reinterpret_cast<const uint8_t*>(&v), 2);
+}
+
+void PcapNGWriter::Patch32(size_t pos, uint32_t v)
+{
+	memcpy(&m_buffer[pos], &v, 4);
+}
+
+///Pads the buffer to a multiple of 4 bytes (blocks always start 4-aligned)
+void PcapNGWriter::Pad()
+{
+	while(m_buffer.size() % 4)
+		m_buffer.push_back(0);
+}
@@ -0,0 +1,106 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of PcapNGWriter
+ */
+
+#ifndef PcapNGWriter_h
+#define PcapNGWriter_h
+
+/**
+	@brief Buffered writer for pcapng files with picosecond timestamps
+
+	Timestamps are picoseconds relative to the start of a base second, which is stored in the interface's
+	if_tsoffset option. Packet data is appended straight into the output buffer, so a frame can be assembled from
+	several pieces without copying it first.
+ */
+class PcapNGWriter
+{
+public:
+	PcapNGWriter();
+	virtual ~PcapNGWriter();
+
+	//Link types we know how to produce (see tcpdump.org/linktypes.html)
+	enum LinkType
+	{
+		LINKTYPE_ETHERNET	= 1,
+		LINKTYPE_USB_2_0	= 288
+	};
+
+	bool Open(const std::string& path, uint16_t linktype, time_t base);
+	bool Close();
+
+	bool IsOpen()
+	{ return m_fp != NULL; }
+
+	//Packet assembly
+	void BeginPacket(int64_t timestamp);
+	void EndPacket();
+	void AbortPacket();
+
+	void Append(uint8_t b)
+	{ m_buffer.push_back(b); }
+
+	void Append(const uint8_t* data, size_t len)
+	{ m_buffer.insert(m_buffer.end(), data, data + len); }
+
+	void WritePacket(int64_t timestamp, const uint8_t* data, size_t len)
+	{
+		BeginPacket(timestamp);
+		Append(data, len);
+		EndPacket();
+	}
+
+	size_t GetPacketCount()
+	{ return m_packets; }
+
+protected:
+	void Write32(uint32_t v);
+	void Write16(uint16_t v);
+	void Patch32(size_t pos, uint32_t v);
+	void Pad();
+	bool Flush();
+
+	FILE* m_fp;
+
+	///Data not yet written to m_fp
+	std::vector<uint8_t> m_buffer;
+
+	///Position in m_buffer of the block being assembled, or SIZE_MAX if none
+	size_t m_blockStart;
+
+	size_t m_packets;
+
+	bool m_error;
+};
+
+#endif
@@ -30,10 +30,114 @@
 #include "scopehal.h"
 #include "PowerSupply.h"
 
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
 PowerSupply::PowerSupply()
+	: m_telemetryRunning(false)
+	, m_telemetryInterval(0)
 {
 }
 
 PowerSupply::~PowerSupply()
 {
+	//Derived classes should have stopped polling already, since the thread calls their virtual functions.
+	//This is just a last resort so we don't destroy a joinable std::thread.
+	if(m_telemetryThread.joinable())
+	{
+		m_telemetryRunning = false;
+		m_telemetryThread.join();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bulk readout
+
+/**
+	@brief Reads the measured state of every channel.
+
+	The default implementation simply calls the individual getters. Drivers should override this to fetch everything
+	in as few round trips as possible.
+ */
+PowerSupplyTelemetry PowerSupply::GetTelemetrySnapshot()
+{
+	PowerSupplyTelemetry ret;
+	int nchans = GetPowerChannelCount();
+	ret.m_channels.resize(nchans);
+	for(int i=0; i<nchans; i++)
+	{
+		auto& chan = ret.m_channels[i];
+		chan.m_voltageActual = GetPowerVoltageActual(i);
+		chan.m_currentActual = GetPowerCurrentActual(i);
+		chan.m_active = GetPowerChannelActive(i);
+		chan.m_constantCurrent = IsPowerConstantCurrent(i);
+	}
+	ret.m_timestamp = GetTime();
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Background polling
+
+/**
+	@brief Starts polling the supply on a background thread.
+
+	Every interval seconds, a fresh snapshot is taken and published for GetLatestTelemetry(). Readers never wait for
+	the instrument, only (briefly) for the pointer to be swapped.
+
+	@param interval	Time between polls, in seconds
+ */
+void PowerSupply::StartTelemetryPolling(double interval)
+{
+	m_telemetryInterval = interval;
+	if(m_telemetryThread.joinable())
+		return;
+
+	m_telemetryRunning = true;
+	m_telemetryThread = thread(&PowerSupply::TelemetryThread, this);
+}
+
+void PowerSupply::StopTelemetryPolling()
+{
+	if(!m_telemetryThread.joinable())
+		return;
+
+	m_telemetryRunning = false;
+	m_telemetryThread.join();
+}
+
+/**
+	@brief Gets the most recent snapshot published by the polling thread.
+
+	@return The snapshot, or an empty pointer if nothing has been polled yet
+ */
+shared_ptr<const PowerSupplyTelemetry> PowerSupply::GetLatestTelemetry()
+{
+	lock_guard<mutex> lock(m_telemetryMutex);
+	return m_latestTelemetry;
+}
+
+void PowerSupply::TelemetryThread()
+{
+	while(m_telemetryRunning)
+	{
+		double start = GetTime();
+
+		shared_ptr<const PowerSupplyTelemetry> snap = make_shared<PowerSupplyTelemetry>(GetTelemetrySnapshot());
+		{
+			lock_guard<mutex> lock(m_telemetryMutex);
+			m_latestTelemetry.swap(snap);
+		}
+
+		//Sleep until the next poll is due, waking up regularly so StopTelemetryPolling() doesn't have to wait long
+		while(m_telemetryRunning)
+		{
+			double remaining = m_telemetryInterval - (GetTime() - start);
+			if(remaining <= 0)
+				break;
+			usleep(min(remaining, 0.05) * 1e6);
+		}
+	}
 }
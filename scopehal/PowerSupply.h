@@ -29,6 +29,46 @@
 #ifndef PowerSupply_h
 #define PowerSupply_h
 
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/**
+	@brief Measured state of one power supply channel
+ */
+class PowerSupplyChannelStatus
+{
+public:
+	PowerSupplyChannelStatus()
+	: m_voltageActual(0)
+	, m_currentActual(0)
+	, m_active(false)
+	, m_constantCurrent(false)
+	{}
+
+	double m_voltageActual;
+	double m_currentActual;
+	bool m_active;
+	bool m_constantCurrent;
+};
+
+/**
+	@brief Measured state of every channel of a power supply at one point in time
+ */
+class PowerSupplyTelemetry
+{
+public:
+	PowerSupplyTelemetry()
+	: m_timestamp(0)
+	{}
+
+	///Host time (as returned by GetTime()) at which the snapshot was completed
+	double m_timestamp;
+
+	std::vector<PowerSupplyChannelStatus> m_channels;
+};
+
 /**
 	@brief A generic power supply
  */
@@ -65,6 +105,36 @@ public:
 
 	//Soft start
 	virtual bool IsSoftStartEnabled(int chan) =0;
+
+	//Bulk readout
+	virtual PowerSupplyTelemetry GetTelemetrySnapshot();
+
+	//Background polling
+	void StartTelemetryPolling(double interval);
+	void StopTelemetryPolling();
+	std::shared_ptr<const PowerSupplyTelemetry> GetLatestTelemetry();
+
+protected:
+	void TelemetryThread();
+
+	///Background thread calling GetTelemetrySnapshot()
+	std::thread m_telemetryThread;
+
+	///Set while the polling thread should keep running
+	std::atomic<bool> m_telemetryRunning;
+
+	///Time between polls, in seconds. Can be changed by StartTelemetryPolling() while the thread is running.
+	std::atomic<double> m_telemetryInterval;
+
+	/**
+		@brief Most recent snapshot from the polling thread.
+
+		Guarded by m_telemetryMutex, which is only ever held long enough to copy the pointer. This isn't lock-free,
+		but readers never wait on the instrument. (std::atomic_load on a shared_ptr would be no better: libstdc++
+		implements it with a hidden lock too, and those overloads are deprecated in C++20.)
+	 */
+	std::shared_ptr<const PowerSupplyTelemetry> m_latestTelemetry;
+	std::mutex m_telemetryMutex;
 };
 
 #endif
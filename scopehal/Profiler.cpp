@@ -0,0 +1,289 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of Profiler
+ */
+
+#include "scopehal.h"
+#include <time.h>
+#include <algorithm>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Creates a profiler
+
+	@param maxEvents	Number of refreshes to keep on the timeline. Older ones are discarded.
+ */
+Profiler::Profiler(size_t maxEvents)
+	: m_enabled(false)
+	, m_epoch(GetTime())
+	, m_maxEvents(maxEvents)
+{
+}
+
+/**
+	@brief Gets the process-wide profiler used by decoders and measurements
+ */
+Profiler& Profiler::GetDefault()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Recording
+
+Profiler::Scope::Scope(Profiler& profiler)
+	: m_profiler(profiler)
+	, m_active(profiler.IsEnabled())
+	, m_start(0)
+	, m_cpuStart(0)
+{
+	if(m_active)
+	{
+		m_start = GetTime();
+		m_cpuStart = GetThreadCPUTime();
+	}
+}
+
+/**
+	@brief Ends the timed region and records it against a node
+
+	@param node				The decoder or measurement which was refreshed
+	@param name				Display name of the node
+	@param inputSamples		Total number of samples in the node's inputs
+	@param outputSamples	Number of samples in the node's output
+	@param outputBytes		Memory used by the node's output
+ */
+void Profiler::Scope::Finish(
+	const void* node,
+	const string& name,
+	uint64_t inputSamples,
+	uint64_t outputSamples,
+	size_t outputBytes)
+{
+	if(!m_active)
+		return;
+
+	double wall = GetTime() - m_start;
+	double cpu = GetThreadCPUTime() - m_cpuStart;
+	m_profiler.Record(node, name, m_start, wall, cpu, inputSamples, outputSamples, outputBytes);
+}
+
+void Profiler::Record(
+	const void* node,
+	const string& name,
+	double start,
+	double wall,
+	double cpu,
+	uint64_t inputSamples,
+	uint64_t outputSamples,
+	size_t outputBytes)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	auto& stats = m_stats[node];
+	stats.m_name = name;
+	stats.m_calls ++;
+	stats.m_wallTime += wall;
+	stats.m_cpuTime += cpu;
+	stats.m_lastWallTime = wall;
+	stats.m_lastCpuTime = cpu;
+	stats.m_inputSamples += inputSamples;
+	stats.m_outputSamples += outputSamples;
+	if(outputBytes > stats.m_peakBytes)
+		stats.m_peakBytes = outputBytes;
+
+	auto tid = this_thread::get_id();
+	if(m_threadIDs.find(tid) == m_threadIDs.end())
+	{
+		size_t id = m_threadIDs.size();
+		m_threadIDs[tid] = id;
+	}
+
+	TraceEvent ev;
+	ev.m_name = name;
+	ev.m_start = start - m_epoch;
+	ev.m_duration = wall;
+	ev.m_cpuTime = cpu;
+	ev.m_thread = m_threadIDs[tid];
+	ev.m_inputSamples = inputSamples;
+	ev.m_outputSamples = outputSamples;
+	m_events.push_back(ev);
+	while(m_events.size() > m_maxEvents)
+		m_events.pop_front();
+}
+
+/**
+	@brief Gets the CPU time used by the calling thread, in seconds
+ */
+double Profiler::GetThreadCPUTime()
+{
+	timespec t;
+	if(0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t))
+		return 0;
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Queries
+
+/**
+	@brief Discards all recorded statistics and events
+ */
+void Profiler::Reset()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_stats.clear();
+	m_events.clear();
+	m_epoch = GetTime();
+}
+
+/**
+	@brief Discards the statistics for a node which is being deleted
+ */
+void Profiler::Forget(const void* node)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_stats.erase(node);
+}
+
+/**
+	@brief Gets the statistics for every node recorded so far, slowest (by total wall time) first
+ */
+vector<ProfileStats> Profiler::GetStats()
+{
+	vector<ProfileStats> ret;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for(auto& it : m_stats)
+			ret.push_back(it.second);
+	}
+
+	sort(ret.begin(), ret.end(),
+		[](const ProfileStats& a, const ProfileStats& b) { return a.m_wallTime > b.m_wallTime; });
+	return ret;
+}
+
+/**
+	@brief Gets the statistics for a single node
+
+	@return False if nothing has been recorded for it
+ */
+bool Profiler::GetStats(const void* node, ProfileStats& stats)
+{
+	lock_guard<mutex> lock(m_mutex);
+	auto it = m_stats.find(node);
+	if(it == m_stats.end())
+		return false;
+	stats = it->second;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Export
+
+/**
+	@brief Escapes a string for use in a JSON string literal
+ */
+static string JSONEscape(const string& str)
+{
+	string ret;
+	for(auto c : str)
+	{
+		switch(c)
+		{
+			case '"':
+				ret += "\\\"";
+				break;
+
+			case '\\':
+				ret += "\\\\";
+				break;
+
+			default:
+				if(static_cast<unsigned char>(c) < 0x20)
+				{
+					char tmp[8];
+					snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+					ret += tmp;
+				}
+				else
+					ret += c;
+				break;
+		}
+	}
+	return ret;
+}
+
+/**
+	@brief Writes the timeline to a file in Chrome trace-event JSON format
+
+	Each refresh becomes a complete ("X") event on a row for the thread which ran it, with the sample counts and CPU
+	time as arguments.
+ */
+bool Profiler::ExportChromeTrace(const string& path)
+{
+	FILE* fp = fopen(path.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open trace file %s\n", path.c_str());
+		return false;
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for(size_t i=0; i<m_events.size(); i++)
+	{
+		auto& ev = m_events[i];
+		fprintf(fp,
+			"{\"name\":\"%s\",\"cat\":\"refresh\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu,"
+			"\"args\":{\"cpu_us\":%.3f,\"input_samples\":%lu,\"output_samples\":%lu}}%s\n",
+			JSONEscape(ev.m_name).c_str(),
+			ev.m_start * 1e6,
+			ev.m_duration * 1e6,
+			ev.m_thread,
+			ev.m_cpuTime * 1e6,
+			(unsigned long)ev.m_inputSamples,
+			(unsigned long)ev.m_outputSamples,
+			(i+1 < m_events.size()) ? "," : "");
+	}
+	fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+	fclose(fp);
+	return true;
+}
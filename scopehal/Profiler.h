@@ -0,0 +1,183 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of Profiler
+ */
+
+#ifndef Profiler_h
+#define Profiler_h
+
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <thread>
+
+/**
+	@brief Accumulated timing and throughput for one decoder or measurement
+ */
+class ProfileStats
+{
+public:
+	ProfileStats()
+	: m_calls(0)
+	, m_wallTime(0)
+	, m_cpuTime(0)
+	, m_lastWallTime(0)
+	, m_lastCpuTime(0)
+	, m_inputSamples(0)
+	, m_outputSamples(0)
+	, m_peakBytes(0)
+	{}
+
+	///Display name of the node, as of the last call
+	std::string m_name;
+
+	///Number of refreshes recorded
+	size_t m_calls;
+
+	///Total wall clock and CPU time (seconds)
+	double m_wallTime;
+	double m_cpuTime;
+
+	///Wall clock and CPU time of the most recent refresh (seconds)
+	double m_lastWallTime;
+	double m_lastCpuTime;
+
+	///Total number of input and output samples processed
+	uint64_t m_inputSamples;
+	uint64_t m_outputSamples;
+
+	///Largest output capture produced, in bytes
+	size_t m_peakBytes;
+
+	///Average input throughput
+	double GetSamplesPerSecond() const
+	{ return (m_wallTime > 0) ? (m_inputSamples / m_wallTime) : 0; }
+};
+
+/**
+	@brief Records how long each decoder and measurement takes to refresh.
+
+	Disabled by default, in which case the cost is one atomic load per refresh. When enabled, every refresh made
+	through ProtocolDecoder::RefreshIfDirty(), DecoderScheduler or Measurement::Refresh() is recorded, both
+	as running totals per node and as an event in a bounded timeline which can be exported in Chrome trace-event
+	format (for chrome://tracing or Perfetto).
+
+	CPU time is that of the calling thread, so time spent in OpenMP worker threads is not included.
+ */
+class Profiler
+{
+public:
+	Profiler(size_t maxEvents = 100000);
+
+	static Profiler& GetDefault();
+
+	void SetEnabled(bool enabled)
+	{ m_enabled = enabled; }
+
+	bool IsEnabled()
+	{ return m_enabled; }
+
+	void Reset();
+	void Forget(const void* node);
+
+	std::vector<ProfileStats> GetStats();
+	bool GetStats(const void* node, ProfileStats& stats);
+
+	bool ExportChromeTrace(const std::string& path);
+
+	/**
+		@brief Times one refresh, from construction until Finish() is called
+	 */
+	class Scope
+	{
+	public:
+		Scope(Profiler& profiler);
+
+		///True if the profiler was enabled when the scope began
+		bool IsActive()
+		{ return m_active; }
+
+		void Finish(const void* node, const std::string& name, uint64_t inputSamples, uint64_t outputSamples,
+			size_t outputBytes);
+
+	protected:
+		Profiler& m_profiler;
+		bool m_active;
+		double m_start;
+		double m_cpuStart;
+	};
+
+	static double GetThreadCPUTime();
+
+protected:
+	void Record(
+		const void* node,
+		const std::string& name,
+		double start,
+		double wall,
+		double cpu,
+		uint64_t inputSamples,
+		uint64_t outputSamples,
+		size_t outputBytes);
+
+	///One refresh on the timeline
+	class TraceEvent
+	{
+	public:
+		std::string m_name;
+		double m_start;
+		double m_duration;
+		double m_cpuTime;
+		size_t m_thread;
+		uint64_t m_inputSamples;
+		uint64_t m_outputSamples;
+	};
+
+	std::atomic<bool> m_enabled;
+
+	///Protects everything below
+	std::mutex m_mutex;
+
+	///Time zero for the timeline
+	double m_epoch;
+
+	std::map<const void*, ProfileStats> m_stats;
+
+	std::deque<TraceEvent> m_events;
+	size_t m_maxEvents;
+
+	///Small sequential IDs for threads, so the trace viewer shows readable rows
+	std::map<std::thread::id, size_t> m_threadIDs;
+};
+
+#endif
@@ -37,6 +37,7 @@
 #include "ProtocolDecoder.h"
 
 ProtocolDecoder::CreateMapType ProtocolDecoder::m_createprocs;
+size_t ProtocolDecoder::m_defaultResultCacheBudget = 64 * 1024 * 1024;
 
 using namespace std;
 
@@ -45,6 +46,7 @@ using namespace std;
 
 ProtocolDecoderParameter::ProtocolDecoderParameter(ParameterTypes type)
 	: m_type(type)
+	, m_owner(NULL)
 {
 	m_intval = 0;
 	m_floatval = 0;
@@ -70,34 +72,36 @@ void ProtocolDecoderParameter::ParseString(string str)
 			scale = 0.000001f;
 	}
 
+	int intval = 0;
+	float floatval = 0;
+	string filename = "";
 	switch(m_type)
 	{
 		case TYPE_BOOL:
-			m_filename = "";
 			if( (str == "1") || (str == "true") )
-				m_intval = 1;
+				intval = 1;
 			else
-				m_intval = 0;
+				intval = 0;
 
-			m_floatval = m_intval;
+			floatval = intval;
 			break;
 
 		//Parse both int and float as float
 		//so e.g. 1.5M parses correctly
 		case TYPE_FLOAT:
 		case TYPE_INT:
-			sscanf(str.c_str(), "%20f", &m_floatval);
-			m_floatval *= scale;
-			m_intval = m_floatval;
-			m_filename = "";
+			floatval = m_floatval;
+			sscanf(str.c_str(), "%20f", &floatval);
+			floatval *= scale;
+			intval = floatval;
 			break;
 
 		case TYPE_FILENAME:
-			m_intval = 0;
-			m_floatval = 0;
-			m_filename = str;
+			filename = str;
 			break;
 	}
+
+	SetValues(intval, floatval, filename);
 }
 
 string ProtocolDecoderParameter::ToString()
@@ -149,25 +153,40 @@ string ProtocolDecoderParameter::GetFileName()
 	return m_filename;
 }
 
+void ProtocolDecoderParameter::SetBoolVal(bool b)
+{
+	SetValues(b, b, "");
+}
+
 void ProtocolDecoderParameter::SetIntVal(int i)
 {
-	m_intval = i;
-	m_floatval = i;
-	m_filename = "";
+	SetValues(i, i, "");
 }
 
 void ProtocolDecoderParameter::SetFloatVal(float f)
 {
-	m_intval = f;
-	m_floatval = f;
-	m_filename = "";
+	SetValues(f, f, "");
 }
 
 void ProtocolDecoderParameter::SetFileName(string f)
 {
-	m_intval = 0;
-	m_floatval = 0;
-	m_filename = f;
+	SetValues(0, 0, f);
+}
+
+/**
+	@brief Updates the stored value, and marks the owning decoder dirty if it actually changed
+ */
+void ProtocolDecoderParameter::SetValues(int i, float f, string s)
+{
+	if( (i == m_intval) && (f == m_floatval) && (s == m_filename) )
+		return;
+
+	m_intval = i;
+	m_floatval = f;
+	m_filename = s;
+
+	if(m_owner)
+		m_owner->MarkDirty();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -180,6 +199,17 @@ ProtocolDecoder::ProtocolDecoder(
 	: OscilloscopeChannel(NULL, "", type, color, 1)	//TODO: handle this better?
 	, m_category(cat)
 	, m_dirty(true)
+	, m_resultCacheStale(false)
+	, m_hasWindow(false)
+	, m_windowStart(0)
+	, m_windowEnd(0)
+	, m_partial(false)
+	, m_partialStart(0)
+	, m_partialEnd(0)
+	, m_fullRefresh(false)
+	, m_currentKeyValid(false)
+	, m_resultCacheSize(0)
+	, m_resultCacheBudget(m_defaultResultCacheBudget)
 {
 	m_physical = false;
 }
@@ -189,8 +219,14 @@ ProtocolDecoder::~ProtocolDecoder()
 	for(auto c : m_channels)
 	{
 		if(c != NULL)
+		{
+			c->RemoveConsumer(this);
 			c->Release();
+		}
 	}
+
+	ClearResultCache();
+	Profiler::GetDefault().Forget(this);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -213,12 +249,25 @@ bool ProtocolDecoder::IsOverlay()
 	return true;
 }
 
+/**
+	@brief Gets a parameter for modification. Changing its value marks this decoder dirty.
+ */
 ProtocolDecoderParameter& ProtocolDecoder::GetParameter(string s)
 {
 	if(m_parameters.find(s) == m_parameters.end())
 		LogError("Invalid parameter name\n");
 
-	return m_parameters[s];
+	ProtocolDecoderParameter& param = m_parameters[s];
+	param.m_owner = this;
+	return param;
+}
+
+ProtocolDecoder::ParameterMapType::iterator ProtocolDecoder::GetParamBegin()
+{
+	//Anything iterating over the parameters may change them, so make sure they know who to notify
+	for(auto& it : m_parameters)
+		it.second.m_owner = this;
+	return m_parameters.begin();
 }
 
 size_t ProtocolDecoder::GetInputCount()
@@ -241,6 +290,14 @@ void ProtocolDecoder::SetInput(size_t i, OscilloscopeChannel* channel)
 {
 	if(i < m_signalNames.size())
 	{
+		//Disconnect the old input
+		if(m_channels[i] != NULL)
+		{
+			m_channels[i]->RemoveConsumer(this);
+			m_channels[i]->Release();
+		}
+		MarkDirty();
+
 		if(channel == NULL)	//NULL is always legal
 		{
 			m_channels[i] = NULL;
@@ -252,10 +309,9 @@ void ProtocolDecoder::SetInput(size_t i, OscilloscopeChannel* channel)
 			//return;
 		}
 
-		if(m_channels[i] != NULL)
-			m_channels[i]->Release();
 		m_channels[i] = channel;
 		channel->AddRef();
+		channel->AddConsumer(this);
 	}
 	else
 	{
@@ -307,247 +363,374 @@ void ProtocolDecoder::RefreshInputsIfDirty()
 
 void ProtocolDecoder::RefreshIfDirty()
 {
-	if(m_dirty)
+	//Clear the flag first, so an input changing while we refresh isn't lost
+	if(m_dirty.exchange(false))
 	{
 		RefreshInputsIfDirty();
-		Refresh();
-		m_dirty = false;
+		RefreshWithCache();
+	}
+}
+
+/**
+	@brief Calls Refresh(), recording it with the profiler if profiling is enabled
+ */
+void ProtocolDecoder::ProfiledRefresh()
+{
+	Profiler::Scope scope(Profiler::GetDefault());
+	Refresh();
+	if(!scope.IsActive())
+		return;
+
+	uint64_t nin = 0;
+	for(auto c : m_channels)
+	{
+		if( (c != NULL) && (c->GetData() != NULL) )
+			nin += c->GetData()->GetDepth();
 	}
+
+	uint64_t nout = 0;
+	size_t bytes = 0;
+	if(m_data != NULL)
+	{
+		nout = m_data->GetDepth();
+		bytes = m_data->GetMemoryUsage();
+	}
+
+	scope.Finish(this, m_displayname, nin, nout, bytes);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Enumeration
+// Streaming decode
 
-void ProtocolDecoder::DoAddDecoderClass(string name, CreateProcType proc)
+bool ProtocolDecoder::SupportsStreaming()
 {
-	m_createprocs[name] = proc;
+	return false;
 }
 
-void ProtocolDecoder::EnumProtocols(vector<string>& names)
+/**
+	@brief Resets the decoder to start a new stream.
+
+	Derived classes must call this before resetting their own state.
+ */
+void ProtocolDecoder::Begin()
 {
-	for(CreateMapType::iterator it=m_createprocs.begin(); it != m_createprocs.end(); ++it)
-		names.push_back(it->first);
+	if(!SupportsStreaming())
+	{
+		LogError("%s does not support streaming decode\n", GetProtocolDisplayName().c_str());
+		return;
+	}
+
+	//Output no longer corresponds to whatever is on our inputs
+	m_currentKeyValid = false;
+	SetData(NULL);
 }
 
-ProtocolDecoder* ProtocolDecoder::CreateDecoder(string protocol, string color)
+/**
+	@brief Decodes the next chunk of a stream
+ */
+void ProtocolDecoder::Push(const vector<CaptureChannelBase*>& /*chunk*/)
 {
-	if(m_createprocs.find(protocol) != m_createprocs.end())
-		return m_createprocs[protocol](color);
+	LogError("%s does not support streaming decode\n", GetProtocolDisplayName().c_str());
+}
 
-	LogError("Invalid decoder name: %s\n", protocol.c_str());
-	return NULL;
+/**
+	@brief Finishes decoding a stream, emitting anything still in progress
+ */
+void ProtocolDecoder::Flush()
+{
+	LogError("%s does not support streaming decode\n", GetProtocolDisplayName().c_str());
+}
+
+/**
+	@brief Refreshes a streaming decoder by pushing the entire contents of its inputs as a single chunk
+ */
+void ProtocolDecoder::RefreshStreaming()
+{
+	vector<CaptureChannelBase*> chunk;
+	for(auto c : m_channels)
+		chunk.push_back( (c == NULL) ? NULL : c->GetData() );
+
+	Begin();
+	Push(chunk);
+	Flush();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Sampling helpers
+// Region of interest
+
+bool ProtocolDecoder::SupportsTimeWindow()
+{
+	return false;
+}
 
 /**
-	@brief Samples a digital waveform on the rising edges of a clock
+	@brief Limits decoding to a time range, e.g. the part of the waveform currently on screen
+ */
+void ProtocolDecoder::SetTimeWindow(int64_t start, int64_t end)
+{
+	m_hasWindow = true;
+	m_windowStart = start;
+	m_windowEnd = end;
 
-	The sampling rate of the data and clock signals need not be equal or uniform.
+	//Only need to decode again if what we have doesn't cover the new window
+	if(m_partial && ( (start < m_partialStart) || (end > m_partialEnd) ) )
+		MarkDirty();
+}
 
-	The sampled waveform has a time scale in picoseconds regardless of the incoming waveform's time scale.
+void ProtocolDecoder::ClearTimeWindow()
+{
+	m_hasWindow = false;
+	if(m_partial)
+		MarkDirty();
+}
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
+/**
+	@brief If our output only covers the time window, decodes the whole input
  */
-void ProtocolDecoder::SampleOnRisingEdges(DigitalCapture* data, DigitalCapture* clock, vector<DigitalSample>& samples)
+void ProtocolDecoder::CompletePartialRefresh()
 {
-	samples.clear();
+	if(!m_partial)
+		return;
 
-	size_t ndata = 0;
-	for(size_t i=1; i<clock->m_samples.size(); i++)
-	{
-		//Throw away clock samples until we find a rising edge
-		auto csample = clock->m_samples[i];
-		auto ocsample = clock->m_samples[i-1];
-		if(!(csample.m_sample && !ocsample.m_sample))
-			continue;
+	m_fullRefresh = true;
+	m_dirty = true;
+	RefreshIfDirty();
+	m_fullRefresh = false;
+}
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = csample.m_offset * clock->m_timescale;
-		while( (ndata < data->m_samples.size()) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
-			ndata ++;
-		if(ndata >= data->m_samples.size())
-			break;
+/**
+	@brief Gets the time range to decode during the current refresh.
 
-		//Extend the previous sample's duration (if any) to our start
-		if(samples.size())
-		{
-			auto& s = samples[samples.size() - 1];
-			s.m_duration = clkstart - s.m_offset;
-		}
+	Returns false if the whole input should be decoded. If it returns true the output is marked as partial, so the
+	caller must decode at least the range returned.
+ */
+bool ProtocolDecoder::GetDecodeWindow(int64_t& start, int64_t& end)
+{
+	if(!m_hasWindow || m_fullRefresh || !SupportsTimeWindow())
+		return false;
 
-		//Add the new sample
-		samples.push_back(DigitalSample(clkstart, 1, data->m_samples[ndata].m_sample));
-	}
+	start = m_windowStart;
+	end = m_windowEnd;
+
+	m_partial = true;
+	m_partialStart = start;
+	m_partialEnd = end;
+	return true;
 }
 
 /**
-	@brief Samples a digital bus waveform on the rising edges of a clock
-
-	The sampling rate of the data and clock signals need not be equal or uniform.
+	@brief Records the time range a windowed Refresh() actually covered, if wider than the window it was asked for.
 
-	The sampled waveform has a time scale in picoseconds regardless of the incoming waveform's time scale.
+	Windows that fall inside this range can then be served without decoding again.
+ */
+void ProtocolDecoder::SetDecodedRange(int64_t start, int64_t end)
+{
+	m_partialStart = start;
+	m_partialEnd = end;
+}
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
+/**
+	@brief Finds the last sample starting at or before a given time (in picoseconds), or zero if there is none
  */
-void ProtocolDecoder::SampleOnRisingEdges(DigitalBusCapture* data, DigitalCapture* clock, vector<DigitalBusSample>& samples)
+size_t ProtocolDecoder::FindSampleAtTime(CaptureChannelBase* cap, int64_t t)
 {
-	samples.clear();
+	size_t len = cap->GetDepth();
+	if(len == 0)
+		return 0;
 
-	size_t ndata = 0;
-	for(size_t i=1; i<clock->m_samples.size(); i++)
+	//Binary search for the first sample starting after t
+	size_t lo = 0;
+	size_t hi = len;
+	while(lo < hi)
 	{
-		//Throw away clock samples until we find a rising edge
-		auto csample = clock->m_samples[i];
-		auto ocsample = clock->m_samples[i-1];
-		if(!(csample.m_sample && !ocsample.m_sample))
-			continue;
-
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = csample.m_offset * clock->m_timescale;
-		while( (ndata < data->m_samples.size()) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
-			ndata ++;
-		if(ndata >= data->m_samples.size())
-			break;
-
-		//Extend the previous sample's duration (if any) to our start
-		if(samples.size())
-		{
-			auto& s = samples[samples.size() - 1];
-			s.m_duration = clkstart - s.m_offset;
-		}
-
-		//Add the new sample
-		samples.push_back(DigitalBusSample(clkstart, 1, data->m_samples[ndata].m_sample));
+		size_t mid = lo + (hi - lo)/2;
+		if(cap->GetSampleStart(mid) * cap->m_timescale <= t)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+
+	return (lo == 0) ? 0 : lo - 1;
 }
 
-/**
-	@brief Samples a digital waveform on the falling edges of a clock
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Result cache
 
-	The sampling rate of the data and clock signals need not be equal or uniform.
+bool ProtocolDecoder::UsesResultCache()
+{
+	return false;
+}
 
-	The sampled waveform has a time scale in picoseconds regardless of the incoming waveform's time scale.
+void ProtocolDecoder::OnResultCacheHit()
+{
+}
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
+/**
+	@brief Brings our output up to date, reusing a cached result if one matches the current inputs and parameters
  */
-void ProtocolDecoder::SampleOnFallingEdges(DigitalCapture* data, DigitalCapture* clock, vector<DigitalSample>& samples)
+void ProtocolDecoder::RefreshWithCache()
 {
-	samples.clear();
+	//Set by GetDecodeWindow() if Refresh() only decodes part of the input
+	m_partial = false;
 
-	size_t ndata = 0;
-	for(size_t i=1; i<clock->m_samples.size(); i++)
+	//Something the cache key can't capture has changed, so nothing computed so far can be trusted
+	if(m_resultCacheStale.exchange(false))
 	{
-		//Throw away clock samples until we find a falling edge
-		auto csample = clock->m_samples[i];
-		auto ocsample = clock->m_samples[i-1];
-		if(!(!csample.m_sample && ocsample.m_sample))
-			continue;
+		m_currentKeyValid = false;
+		ClearResultCache();
+	}
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = csample.m_offset * clock->m_timescale;
-		while( (ndata < data->m_samples.size()) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
-			ndata ++;
-		if(ndata >= data->m_samples.size())
-			break;
+	//Partial outputs aren't cached
+	bool windowed = m_hasWindow && !m_fullRefresh && SupportsTimeWindow();
+	if(!UsesResultCache() || (m_resultCacheBudget == 0) || windowed)
+	{
+		if(windowed)
+			m_currentKeyValid = false;
+		ProfiledRefresh();
+		return;
+	}
 
-		//Extend the previous sample's duration (if any) to our start
-		if(samples.size())
-		{
-			auto& s = samples[samples.size() - 1];
-			s.m_duration = clkstart - s.m_offset;
-		}
+	ResultCacheKey key = GetResultCacheKey();
 
-		samples.push_back(DigitalSample(clkstart, 1, data->m_samples[ndata].m_sample));
-	}
-}
+	//Current output is already up to date
+	if(m_currentKeyValid && (m_data != NULL) && (key == m_currentKey))
+		return;
 
-/**
-	@brief Samples a digital waveform on all edges of a clock
+	//Save the current output under the state it was computed from
+	if(m_currentKeyValid && (m_data != NULL))
+		StoreResult(m_currentKey, Detach());
 
-	The sampling rate of the data and clock signals need not be equal or uniform.
+	auto it = m_resultIndex.find(key);
+	if(it != m_resultIndex.end())
+	{
+		auto lit = it->second;
+		CaptureChannelBase* cap = lit->second;
+		m_resultCacheSize -= cap->GetMemoryUsage();
+		m_resultCache.erase(lit);
+		m_resultIndex.erase(it);
+
+		SetData(cap);
+		OnResultCacheHit();
+	}
+	else
+		ProfiledRefresh();
 
-	The sampled waveform has a time scale in picoseconds regardless of the incoming waveform's time scale.
+	m_currentKey = key;
+	m_currentKeyValid = true;
+}
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
- */
-void ProtocolDecoder::SampleOnAnyEdges(DigitalCapture* data, DigitalCapture* clock, vector<DigitalSample>& samples)
+ProtocolDecoder::ResultCacheKey ProtocolDecoder::GetResultCacheKey()
 {
-	samples.clear();
-
-	size_t ndata = 0;
-	for(size_t i=1; i<clock->m_samples.size(); i++)
+	ResultCacheKey key;
+	for(auto c : m_channels)
 	{
-		//Throw away clock samples until we find an edge
-		auto csample = clock->m_samples[i];
-		auto ocsample = clock->m_samples[i-1];
-		if(csample.m_sample == ocsample.m_sample)
-			continue;
+		if( (c == NULL) || (c->GetData() == NULL) )
+			key.m_generations.push_back(0);
+		else
+			key.m_generations.push_back(c->GetData()->m_generation);
+	}
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = csample.m_offset * clock->m_timescale;
-		while( (ndata < data->m_samples.size()) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
-			ndata ++;
-		if(ndata >= data->m_samples.size())
-			break;
+	//Use the raw parameter values (ToString() rounds floats)
+	string& blob = key.m_params;
+	for(auto& it : m_parameters)
+	{
+		auto& p = it.second;
+		blob += it.first;
+		blob.push_back('\0');
+		blob.append(reinterpret_cast<const char*>(&p.m_intval), sizeof(p.m_intval));
+		blob.append(reinterpret_cast<const char*>(&p.m_floatval), sizeof(p.m_floatval));
+		blob += p.m_filename;
+		blob.push_back('\0');
+	}
+	key.m_paramHash = hash<string>()(blob);
 
-		//Extend the previous sample's duration (if any) to our start
-		if(samples.size())
-		{
-			auto& s = samples[samples.size() - 1];
-			s.m_duration = clkstart - s.m_offset;
-		}
+	return key;
+}
 
-		//Add the new sample
-		samples.push_back(DigitalSample(clkstart, 1, data->m_samples[ndata].m_sample));
+void ProtocolDecoder::StoreResult(const ResultCacheKey& key, CaptureChannelBase* cap)
+{
+	//Replace any existing entry for the same state
+	auto it = m_resultIndex.find(key);
+	if(it != m_resultIndex.end())
+	{
+		m_resultCacheSize -= it->second->second->GetMemoryUsage();
+		delete it->second->second;
+		m_resultCache.erase(it->second);
+		m_resultIndex.erase(it);
 	}
+
+	m_resultCache.push_front(make_pair(key, cap));
+	m_resultIndex[key] = m_resultCache.begin();
+	m_resultCacheSize += cap->GetMemoryUsage();
+
+	TrimResultCache();
 }
 
 /**
-	@brief Find zero crossings in a waveform, interpolating as necessary
+	@brief Evicts least recently used outputs until the cache fits within its budget
  */
-void ProtocolDecoder::FindZeroCrossings(AnalogCapture* data, float threshold, std::vector<int64_t>& edges)
+void ProtocolDecoder::TrimResultCache()
 {
-	//Find times of the zero crossings (TODO: extract this into reusable function)
-	bool first = true;
-	bool last = false;
-	for(size_t i=1; i<data->m_samples.size(); i++)
+	while( (m_resultCacheSize > m_resultCacheBudget) && !m_resultCache.empty() )
 	{
-		auto sin = data->m_samples[i];
-		bool value = static_cast<float>(sin) > threshold;
+		auto& entry = m_resultCache.back();
+		m_resultCacheSize -= entry.second->GetMemoryUsage();
+		m_resultIndex.erase(entry.first);
+		delete entry.second;
+		m_resultCache.pop_back();
+	}
+}
 
-		//Start time of the sample, in picoseconds
-		int64_t t = data->m_triggerPhase + data->m_timescale * sin.m_offset;
+void ProtocolDecoder::SetResultCacheBudget(size_t bytes)
+{
+	m_resultCacheBudget = bytes;
+	TrimResultCache();
+}
 
-		//Move to the middle of the sample
-		t += data->m_timescale/2;
+void ProtocolDecoder::ClearResultCache()
+{
+	for(auto& entry : m_resultCache)
+		delete entry.second;
+	m_resultCache.clear();
+	m_resultIndex.clear();
+	m_resultCacheSize = 0;
+}
 
-		//Save the last value
-		if(first)
-		{
-			last = value;
-			first = false;
-			continue;
-		}
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Enumeration
 
-		//Skip samples with no transition
-		if(last == value)
-			continue;
+void ProtocolDecoder::DoAddDecoderClass(string name, CreateProcType proc)
+{
+	m_createprocs[name] = proc;
+}
 
-		//Interpolate the time
-		t += data->m_timescale * Measurement::InterpolateTime(data, i-1, threshold);
-		edges.push_back(t);
-		last = value;
-	}
+void ProtocolDecoder::EnumProtocols(vector<string>& names)
+{
+	for(CreateMapType::iterator it=m_createprocs.begin(); it != m_createprocs.end(); ++it)
+		names.push_back(it->first);
+}
+
+ProtocolDecoder* ProtocolDecoder::CreateDecoder(string protocol, string color)
+{
+	if(m_createprocs.find(protocol) != m_createprocs.end())
+		return m_createprocs[protocol](color);
+
+	LogError("Invalid decoder name: %s\n", protocol.c_str());
+	return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampling helpers
+
+/**
+	@brief Find zero crossings in a waveform, interpolating as necessary
+
+	Copies the list shared by all users of the capture. Use EdgeDetector::FindZeroCrossings() directly to avoid the
+	copy.
+ */
+void ProtocolDecoder::FindZeroCrossings(AnalogCapture* data, float threshold, std::vector<int64_t>& edges)
+{
+	edges = *EdgeDetector::FindZeroCrossings(data, threshold);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -38,9 +38,15 @@
 
 #include "OscilloscopeChannel.h"
 #include "../scopehal/ChannelRenderer.h"
+#include <list>
+#include <atomic>
+
+class ProtocolDecoder;
 
 class ProtocolDecoderParameter
 {
+	friend class ProtocolDecoder;
+
 public:
 	enum ParameterTypes
 	{
@@ -62,8 +68,7 @@ public:
 	float GetFloatVal();
 	std::string GetFileName();
 
-	void SetBoolVal(bool b)
-	{ m_intval = b; }
+	void SetBoolVal(bool b);
 	void SetIntVal(int i);
 	void SetFloatVal(float f);
 	void SetFileName(std::string f);
@@ -74,9 +79,14 @@ public:
 protected:
 	ParameterTypes m_type;
 
+	void SetValues(int i, float f, std::string s);
+
 	int m_intval;
 	float m_floatval;
 	std::string m_filename;
+
+	///The decoder this parameter belongs to, if known (marked dirty when the value changes)
+	ProtocolDecoder* m_owner;
 };
 
 /**
@@ -84,6 +94,10 @@ protected:
  */
 class ProtocolDecoder : public OscilloscopeChannel
 {
+	friend class DecoderScheduler;
+	friend class OscilloscopeChannel;
+	friend class ProtocolDecoderParameter;
+
 public:
 
 	enum Category
@@ -119,8 +133,7 @@ public:
 
 	ProtocolDecoderParameter& GetParameter(std::string s);
 	typedef std::map<std::string, ProtocolDecoderParameter> ParameterMapType;
-	ParameterMapType::iterator GetParamBegin()
-	{ return m_parameters.begin(); }
+	ParameterMapType::iterator GetParamBegin();
 	ParameterMapType::iterator GetParamEnd()
 	{ return m_parameters.end(); }
 
@@ -138,9 +151,70 @@ public:
 
 	void RefreshIfDirty();
 	void RefreshInputsIfDirty();
+	void RefreshWithCache();
+
+	//Result cache
+	void SetResultCacheBudget(size_t bytes);
+	size_t GetResultCacheBudget()
+	{ return m_resultCacheBudget; }
+	size_t GetResultCacheSize()
+	{ return m_resultCacheSize; }
+	void ClearResultCache();
+
+	static void SetDefaultResultCacheBudget(size_t bytes)
+	{ m_defaultResultCacheBudget = bytes; }
+
+	/*
+		Streaming decode
+
+		Decoders that return true from SupportsStreaming() can be fed their input a chunk at a time, rather than
+		needing the whole waveform in memory. Call Begin() once, then Push() with each chunk, then Flush() at the end
+		of the stream. State carries over between chunks, so symbols and packets spanning a chunk boundary are decoded
+		correctly.
+
+		Each chunk has one capture per input (NULL for unused inputs). All chunks of a stream must share the same
+		timebase (timescale and start time), with sample offsets continuing on from the previous chunk.
+
+		Output accumulates in the decoder's capture, which is re-published after every Push(). Detach() it between
+		chunks to bound memory usage; the next Push() will start a new output capture.
+	 */
+	virtual bool SupportsStreaming();
+	virtual void Begin();
+	virtual void Push(const std::vector<CaptureChannelBase*>& chunk);
+	virtual void Flush();
+
+	/*
+		Region of interest
+
+		Decoders that return true from SupportsTimeWindow() can decode just part of their input. When a time window
+		is set, Refresh() resyncs at a safe boundary (idle, end of packet, etc) shortly before the window, decodes
+		through the end of it, and marks the output as partial. CompletePartialRefresh(), or
+		DecoderScheduler::CompletePartialRefreshes(), later fills in the rest, e.g. once the view has been drawn.
 
+		Times are in picoseconds from the start of the capture.
+	 */
+	virtual bool SupportsTimeWindow();
+	void SetTimeWindow(int64_t start, int64_t end);
+	void ClearTimeWindow();
+	void CompletePartialRefresh();
+
+	bool IsPartial()
+	{ return m_partial; }
+
+	/**
+		@brief Forces this decoder, and everything downstream of it, to be recomputed on the next refresh.
+
+		Use this when something the result cache can't see has changed, e.g. the contents of a file named by a
+		parameter. Every cached output of this decoder is discarded, even if its inputs and parameters are unchanged.
+	 */
 	void SetDirty()
-	{ m_dirty = true; }
+	{
+		m_resultCacheStale = true;
+		MarkDirty();
+	}
+
+	bool IsDirty()
+	{ return m_dirty; }
 
 	/**
 		@brief Gets the display name of this protocol (for use in menus, save files, etc). Must be unique.
@@ -172,17 +246,366 @@ protected:
 	///Group used for the display menu
 	Category m_category;
 
-	///Indicates if our output is out-of-sync with our input
-	bool m_dirty;
+	///Indicates if our output is out-of-sync with our input. Set by upstream decoders on DecoderScheduler threads.
+	std::atomic<bool> m_dirty;
+
+protected:
+
+	/**
+		@brief Marks this decoder, and everything downstream of it, as needing a refresh.
+
+		Unlike SetDirty(), cached outputs stay valid. Used when the change is visible in the cache key (a parameter
+		value or input), so the cache can tell for itself whether an old output still applies.
+	 */
+	void MarkDirty()
+	{
+		m_dirty = true;
+		MarkDownstreamDirty();
+	}
+
+	///Set by SetDirty() to discard the result cache on the next refresh
+	std::atomic<bool> m_resultCacheStale;
+
+	/**
+		@brief Return true (override) if this decoder's output depends only on its inputs and parameters.
+
+		Such decoders keep previously computed outputs in an LRU cache, keyed by input generation and parameter
+		values, and reuse them instead of calling Refresh() when the same state comes up again.
+	 */
+	virtual bool UsesResultCache();
+
+	/**
+		@brief Called after a cached output has been restored, to update any state Refresh() would have set
+	 */
+	virtual void OnResultCacheHit();
+
+	/**
+		@brief Identifies the state a cached output was computed from
+	 */
+	class ResultCacheKey
+	{
+	public:
+		std::vector<uint64_t> m_generations;
+
+		///Raw parameter values. Always compared in full, so a hash collision can't return the wrong output.
+		std::string m_params;
+
+		///Hash of m_params, so most mismatches are found without comparing the whole blob
+		size_t m_paramHash;
+
+		bool operator==(const ResultCacheKey& rhs) const
+		{
+			return (m_paramHash == rhs.m_paramHash) &&
+				(m_generations == rhs.m_generations) &&
+				(m_params == rhs.m_params);
+		}
+
+		bool operator<(const ResultCacheKey& rhs) const
+		{
+			if(m_paramHash != rhs.m_paramHash)
+				return m_paramHash < rhs.m_paramHash;
+			if(m_generations != rhs.m_generations)
+				return m_generations < rhs.m_generations;
+			return m_params < rhs.m_params;
+		}
+	};
+
+	void RefreshStreaming();
+	void ProfiledRefresh();
+
+	bool GetDecodeWindow(int64_t& start, int64_t& end);
+	void SetDecodedRange(int64_t start, int64_t end);
+
+	static size_t FindSampleAtTime(CaptureChannelBase* cap, int64_t t);
+
+	/**
+		@brief Makes a copy of the samples of a capture overlapping a time range
+
+		The copy keeps the original timebase, so times in it line up with the original.
+	 */
+	template<class S>
+	static CaptureChannel<S>* SliceCapture(CaptureChannel<S>* cap, int64_t start, int64_t end)
+	{
+		CaptureChannel<S>* ret = new CaptureChannel<S>;
+		ret->m_timescale = cap->m_timescale;
+		ret->m_startTimestamp = cap->m_startTimestamp;
+		ret->m_startPicoseconds = cap->m_startPicoseconds;
+		ret->m_triggerPhase = cap->m_triggerPhase;
+
+		for(size_t i = FindSampleAtTime(cap, start); i < cap->m_samples.size(); i++)
+		{
+			auto& s = cap->m_samples[i];
+			if(s.m_offset * cap->m_timescale >= end)
+				break;
+			ret->m_samples.push_back(s);
+		}
+
+		return ret;
+	}
+
+	///Time window requested by SetTimeWindow()
+	bool m_hasWindow;
+	int64_t m_windowStart;
+	int64_t m_windowEnd;
+
+	///True if our output only covers m_partialStart to m_partialEnd
+	bool m_partial;
+	int64_t m_partialStart;
+	int64_t m_partialEnd;
+
+	///True to ignore the time window for the current refresh
+	std::atomic<bool> m_fullRefresh;
+
+	ResultCacheKey GetResultCacheKey();
+	void StoreResult(const ResultCacheKey& key, CaptureChannelBase* cap);
+	void TrimResultCache();
+
+	typedef std::list< std::pair<ResultCacheKey, CaptureChannelBase*> > ResultListType;
+
+	///Cached outputs, most recently used first
+	ResultListType m_resultCache;
+
+	///Index into m_resultCache
+	std::map<ResultCacheKey, ResultListType::iterator> m_resultIndex;
+
+	///Key for the current contents of m_data
+	ResultCacheKey m_currentKey;
+	bool m_currentKeyValid;
+
+	///Total memory used by m_resultCache
+	size_t m_resultCacheSize;
+
+	///Max memory m_resultCache may use
+	size_t m_resultCacheBudget;
+
+	static size_t m_defaultResultCacheBudget;
 
 protected:
 
-	//Samples a digital channel on the edges of another channel.
-	//The two channels need not be the same sample rate.
-	void SampleOnAnyEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples);
-	void SampleOnRisingEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples);
-	void SampleOnRisingEdges(DigitalBusCapture* data, DigitalCapture* clock, std::vector<DigitalBusSample>& samples);
-	void SampleOnFallingEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples);
+	///Clock edges to sample on
+	enum EdgeType
+	{
+		EDGE_RISING,
+		EDGE_FALLING,
+		EDGE_ANY
+	};
+
+	/**
+		@brief Several digital signals sampled on the same clock edges
+
+		Each clock edge produces one word, with bit N holding the value of lane N at that edge.
+	 */
+	class MultiLaneSamples
+	{
+	public:
+		MultiLaneSamples()
+		: m_nextClock(1)
+		{}
+
+		size_t size() const
+		{ return m_words.size(); }
+
+		bool GetLane(size_t i, size_t lane) const
+		{ return (m_words[i] >> lane) & 1; }
+
+		void clear()
+		{
+			m_offsets.clear();
+			m_durations.clear();
+			m_words.clear();
+			m_nextClock = 1;
+			m_laneCursors.clear();
+		}
+
+		///Time of each edge, in picoseconds
+		std::vector<int64_t> m_offsets;
+
+		///Time from each edge to the next (1 for the last edge)
+		std::vector<int64_t> m_durations;
+
+		///Packed lane values
+		std::vector<uint64_t> m_words;
+
+		///Index of the next clock sample to look at, so ContinueSampleOnEdges() can pick up where it stopped
+		size_t m_nextClock;
+
+		///Index of the next sample to look at in each lane
+		std::vector<size_t> m_laneCursors;
+	};
+
+	template<EdgeType edge>
+	static bool IsEdge(bool prev, bool cur)
+	{
+		switch(edge)
+		{
+			case EDGE_RISING:
+				return cur && !prev;
+			case EDGE_FALLING:
+				return !cur && prev;
+			default:
+				return cur != prev;
+		}
+	}
+
+	/**
+		@brief Samples a waveform on the edges of a clock
+
+		The sampling rate of the data and clock signals need not be equal or uniform.
+
+		The sampled waveform has a time scale in picoseconds regardless of the incoming waveform's time scale.
+
+		@param data		The data signal to sample
+		@param clock	The clock signal to use
+		@param samples	Output waveform
+	 */
+	template<EdgeType edge, class T>
+	static void SampleOnEdges(CaptureChannel<T>* data, DigitalCapture* clock, std::vector<OscilloscopeSample<T>>& samples)
+	{
+		samples.clear();
+
+		size_t ndata = 0;
+		size_t len = data->m_samples.size();
+		for(size_t i=1; i<clock->m_samples.size(); i++)
+		{
+			//Throw away clock samples until we find an edge
+			if(!IsEdge<edge>(clock->m_samples[i-1].m_sample, clock->m_samples[i].m_sample))
+				continue;
+
+			//Throw away data samples until the data is synced with us
+			int64_t clkstart = clock->m_samples[i].m_offset * clock->m_timescale;
+			while( (ndata < len) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
+				ndata ++;
+			if(ndata >= len)
+				break;
+
+			//Extend the previous sample's duration (if any) to our start
+			if(!samples.empty())
+			{
+				auto& s = samples.back();
+				s.m_duration = clkstart - s.m_offset;
+			}
+
+			samples.push_back(OscilloscopeSample<T>(clkstart, 1, data->m_samples[ndata].m_sample));
+		}
+	}
+
+	/**
+		@brief Samples up to 64 digital waveforms on the edges of a shared clock
+
+		Clock edges are located once for all lanes. Sampling stops at the first edge past the end of any lane.
+
+		@param lanes	The data signals to sample. Lane N ends up in bit N of each word.
+		@param clock	The clock signal to use
+		@param samples	Output words
+	 */
+	template<EdgeType edge>
+	static void SampleOnEdges(
+		const std::vector<DigitalCapture*>& lanes,
+		DigitalCapture* clock,
+		MultiLaneSamples& samples)
+	{
+		samples.clear();
+		ContinueSampleOnEdges<edge>(lanes, clock, samples, INT64_MAX);
+	}
+
+	/**
+		@brief Prepares to sample several lanes starting partway into the capture, rather than at the beginning.
+
+		No samples are produced; call ContinueSampleOnEdges() to get them. Nothing before the given time is read, so
+		decoding a small window of a large capture only costs as much as the window.
+
+		@param lanes	The data signals to sample
+		@param clock	The clock signal to use
+		@param samples	Output words (cleared)
+		@param t		Only clock edges after this time are sampled, in picoseconds
+	 */
+	static void SeekSampleOnEdges(
+		const std::vector<DigitalCapture*>& lanes,
+		DigitalCapture* clock,
+		MultiLaneSamples& samples,
+		int64_t t)
+	{
+		samples.clear();
+		samples.m_nextClock = FindSampleAtTime(clock, t) + 1;
+		for(auto data : lanes)
+			samples.m_laneCursors.push_back(FindSampleAtTime(data, t));
+	}
+
+	/**
+		@brief Appends samples for clock edges up to a given time, continuing from where the last call stopped
+
+		@param lanes	The data signals to sample. Lane N ends up in bit N of each word.
+		@param clock	The clock signal to use
+		@param samples	Output words
+		@param tend		Time of the last clock edge to sample, in picoseconds
+
+		@return False if the clock or any lane has run out, so there's nothing more to sample
+	 */
+	template<EdgeType edge>
+	static bool ContinueSampleOnEdges(
+		const std::vector<DigitalCapture*>& lanes,
+		DigitalCapture* clock,
+		MultiLaneSamples& samples,
+		int64_t tend)
+	{
+		size_t nlanes = lanes.size();
+		if(nlanes > 64)
+		{
+			LogError("SampleOnEdges: can't pack %zu lanes into a 64-bit word\n", nlanes);
+			return false;
+		}
+		samples.m_laneCursors.resize(nlanes, 0);
+
+		size_t i = samples.m_nextClock;
+		for(; i<clock->m_samples.size(); i++)
+		{
+			if(!IsEdge<edge>(clock->m_samples[i-1].m_sample, clock->m_samples[i].m_sample))
+				continue;
+
+			int64_t clkstart = clock->m_samples[i].m_offset * clock->m_timescale;
+			if(clkstart > tend)
+				break;
+
+			//Advance each lane to the edge and pack its value
+			uint64_t word = 0;
+			for(size_t j=0; j<nlanes; j++)
+			{
+				auto data = lanes[j];
+				size_t len = data->m_samples.size();
+				size_t& n = samples.m_laneCursors[j];
+				while( (n < len) && (data->m_samples[n].m_offset * data->m_timescale < clkstart) )
+					n ++;
+				if(n >= len)
+				{
+					samples.m_nextClock = clock->m_samples.size();
+					return false;
+				}
+
+				if(data->m_samples[n].m_sample)
+					word |= (1ULL << j);
+			}
+
+			if(!samples.m_offsets.empty())
+				samples.m_durations.back() = clkstart - samples.m_offsets.back();
+
+			samples.m_offsets.push_back(clkstart);
+			samples.m_durations.push_back(1);
+			samples.m_words.push_back(word);
+		}
+
+		samples.m_nextClock = i;
+		return (i < clock->m_samples.size());
+	}
+
+	//Wrappers for the common cases
+	void SampleOnAnyEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples)
+	{ SampleOnEdges<EDGE_ANY>(data, clock, samples); }
+	void SampleOnRisingEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples)
+	{ SampleOnEdges<EDGE_RISING>(data, clock, samples); }
+	void SampleOnRisingEdges(DigitalBusCapture* data, DigitalCapture* clock, std::vector<DigitalBusSample>& samples)
+	{ SampleOnEdges<EDGE_RISING>(data, clock, samples); }
+	void SampleOnFallingEdges(DigitalCapture* data, DigitalCapture* clock, std::vector<DigitalSample>& samples)
+	{ SampleOnEdges<EDGE_FALLING>(data, clock, samples); }
 
 	//Find interpolated zero crossings of a signal
 	void FindZeroCrossings(AnalogCapture* data, float threshold, std::vector<int64_t>& edges);
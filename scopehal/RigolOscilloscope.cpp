@@ -153,7 +153,7 @@ bool RigolOscilloscope::IsChannelEnabled(size_t i)
 	if(m_channelsEnabled.find(i) != m_channelsEnabled.end())
 		return m_channelsEnabled[i];
 
-	lock_guard<recursive_mutex> lock2(m_mutex);
+	lock_guard<FairRecursiveMutex> lock2(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":DISP?");
 	string reply = m_transport->ReadReply();
@@ -171,19 +171,23 @@ bool RigolOscilloscope::IsChannelEnabled(size_t i)
 
 void RigolOscilloscope::EnableChannel(size_t i)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<recursive_mutex> lock(m_cacheMutex);
+	lock_guard<FairRecursiveMutex> lock2(m_mutex);
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":DISP ON");
+	m_channelsEnabled[i] = true;
 }
 
 void RigolOscilloscope::DisableChannel(size_t i)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<recursive_mutex> lock(m_cacheMutex);
+	lock_guard<FairRecursiveMutex> lock2(m_mutex);
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":DISP OFF");
+	m_channelsEnabled[i] = false;
 }
 
 OscilloscopeChannel::CouplingType RigolOscilloscope::GetChannelCoupling(size_t i)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":COUP?");
 	string reply = m_transport->ReadReply();
@@ -198,7 +202,7 @@ OscilloscopeChannel::CouplingType RigolOscilloscope::GetChannelCoupling(size_t i
 
 void RigolOscilloscope::SetChannelCoupling(size_t i, OscilloscopeChannel::CouplingType type)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 	switch(type)
 	{
 		case OscilloscopeChannel::COUPLE_AC_1M:
@@ -220,7 +224,7 @@ void RigolOscilloscope::SetChannelCoupling(size_t i, OscilloscopeChannel::Coupli
 
 double RigolOscilloscope::GetChannelAttenuation(size_t i)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":PROB?");
 
@@ -237,7 +241,7 @@ void RigolOscilloscope::SetChannelAttenuation(size_t i, double atten)
 
 int RigolOscilloscope::GetChannelBandwidthLimit(size_t i)
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":BWL?");
 	string reply = m_transport->ReadReply();
@@ -260,7 +264,7 @@ double RigolOscilloscope::GetChannelVoltageRange(size_t i)
 			return m_channelVoltageRanges[i];
 	}
 
-	lock_guard<recursive_mutex> lock2(m_mutex);
+	lock_guard<FairRecursiveMutex> lock2(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":RANGE?");
 
@@ -292,7 +296,7 @@ double RigolOscilloscope::GetChannelOffset(size_t i)
 			return m_channelOffsets[i];
 	}
 
-	lock_guard<recursive_mutex> lock2(m_mutex);
+	lock_guard<FairRecursiveMutex> lock2(m_mutex);
 
 	m_transport->SendCommand(m_channels[i]->GetHwname() + ":OFFS?");
 
@@ -316,10 +320,8 @@ void RigolOscilloscope::ResetTriggerConditions()
 
 Oscilloscope::TriggerMode RigolOscilloscope::PollTrigger()
 {
-	//workaround for high latency links to let the UI thread get the mutex
-	usleep(1000);
-
-	lock_guard<recursive_mutex> lock(m_mutex);
+	//m_mutex is a fair lock, so the UI thread gets its turn even if we poll in a tight loop
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	m_transport->SendCommand("TRIG:STAT?");
 	string stat = m_transport->ReadReply();
@@ -348,17 +350,32 @@ Oscilloscope::TriggerMode RigolOscilloscope::PollTrigger()
 	}
 }
 
+/**
+	@brief Requests one block of waveform memory from the current WAV:SOUR.
+
+	Points are numbered from zero and the range is half-open, [start, end). The scope uses one-based, inclusive
+	indexing, so we translate here. All three commands go out in a single write.
+ */
+void RigolOscilloscope::RequestWaveformBlock(size_t start, size_t end)
+{
+	char tmp[128];
+
+	m_transport->BeginBatch();
+	snprintf(tmp, sizeof(tmp), "WAV:STAR %zu", start + 1);
+	m_transport->SendCommand(tmp);
+	snprintf(tmp, sizeof(tmp), "WAV:STOP %zu", end);
+	m_transport->SendCommand(tmp);
+	m_transport->SendCommand("WAV:DATA?");
+	m_transport->EndBatch();
+}
+
 bool RigolOscilloscope::AcquireData(bool toQueue)
 {
 	//LogDebug("Acquiring data\n");
 
-	//TODO
-	bool enabled[4] = {true, true, true, true};
-
-	//workaround for high latency links to let the UI thread get the mutex
-	usleep(1000);
+	vector<bool> enabled = GetEnabledChannelMask(m_analogChannelCount);
 
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 	LogIndenter li;
 
 	//Grab the analog waveform data
@@ -372,8 +389,12 @@ bool RigolOscilloscope::AcquireData(bool toQueue)
 	double yincrement;
 	double yorigin;
 	double yreference;
+
+	//We can only pull 250K points at a time, so deep memory has to come down in blocks.
+	//One scratch buffer is reused for every block (plus the trailing newline the scope sends).
 	size_t maxpoints = 250*1000;
-	unsigned char* temp_buf = new unsigned char[maxpoints];
+	vector<unsigned char> temp_buf(maxpoints + 1);
+
 	map<int, vector<AnalogCapture*> > pending_waveforms;
 	for(size_t i=0; i<m_analogChannelCount; i++)
 	{
@@ -392,7 +413,7 @@ bool RigolOscilloscope::AcquireData(bool toQueue)
 		m_transport->SendCommand("WAV:PRE?");
 		string reply = m_transport->ReadReply();
 		//LogDebug("Preamble = %s\n", reply.c_str());
-		sscanf(reply.c_str(), "%d,%d,%d,%d,%lf,%lf,%lf,%lf,%lf,%lf",
+		if(10 != sscanf(reply.c_str(), "%d,%d,%d,%d,%lf,%lf,%lf,%lf,%lf,%lf",
 			&unused1,
 			&unused2,
 			&npoints,
@@ -402,63 +423,87 @@ bool RigolOscilloscope::AcquireData(bool toQueue)
 			&xreference,
 			&yincrement,
 			&yorigin,
-			&yreference);
+			&yreference))
+		{
+			//Skip this channel but keep going, so the other channels still come down and the trigger is re-armed
+			LogError("Bad waveform preamble \"%s\"\n", reply.c_str());
+			enabled[i] = false;
+			if(!toQueue)
+				m_channels[i]->SetData(NULL);
+			continue;
+		}
+		if(npoints < 0)
+			npoints = 0;
 		int64_t ps_per_sample = round(sec_per_sample * 1e12f);
 		//LogDebug("X: %d points, %f origin, ref %f ps/sample %ld\n", npoints, xorigin, xreference, ps_per_sample);
 		//LogDebug("Y: %f inc, %f origin, %f ref\n", yincrement, yorigin, yreference);
 
-		//Set up the capture we're going to store our data into
+		//Set up the capture we're going to store our data into.
+		//The preamble tells us exactly how big it'll be, so allocate once and decode blocks in place.
 		AnalogCapture* cap = new AnalogCapture;
 		cap->m_timescale = ps_per_sample;
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time(NULL);
 		double t = GetTime();
 		cap->m_startPicoseconds = (t - floor(t)) * 1e12f;
+		cap->m_samples.resize(npoints);
 
-		//Downloading the waveform is a pain in the butt, because we can only pull 250K points at a time!
-		for(size_t npoint=0; npoint < maxpoints; npoint += maxpoints)
+		//Ask for the first block
+		size_t total = npoints;
+		if(total > 0)
+			RequestWaveformBlock(0, min(maxpoints, total));
+
+		double ydelta = yorigin + yreference;
+		for(size_t npoint=0; npoint < total; npoint += maxpoints)
 		{
-			//Ask for the data
-			char tmp[128];
-			snprintf(tmp, sizeof(tmp), "WAV:STAR %zu", npoint + 1);	//ONE based indexing WTF
-			m_transport->SendCommand(tmp);
-			size_t end = npoint + maxpoints;
-			if(end > npoints)
-				end = npoints;
-			snprintf(tmp, sizeof(tmp), "WAV:STOP %zu", end + 1);
-			m_transport->SendCommand(tmp);
-
-			//Ask for the data block
-			m_transport->SendCommand("WAV:DATA?");
+			size_t end = min(npoint + maxpoints, total);
 
 			//Read block header
 			unsigned char header[12] = {0};
 			m_transport->ReadRawData(11, header);
 
 			//Look up the block size
-			//size_t blocksize = end - npoints;
-			//LogDebug("Block size = %zu\n", blocksize);
-			size_t header_blocksize;
+			size_t header_blocksize = 0;
 			sscanf((char*)header, "#9%zu", &header_blocksize);
 			//LogDebug("Header block size = %zu\n", header_blocksize);
 
-			//Read actual block content and decode it
+			//Read actual block content
+			size_t nread = min(header_blocksize, maxpoints);
+			m_transport->ReadRawData(nread, &temp_buf[0]);
+
+			//Throw away anything past what fits in the buffer, plus the trailing newline, so we stay in sync
+			size_t excess = header_blocksize - nread + 1;
+			if(excess > 1)
+				LogError("Waveform block too big (%zu points, expected at most %zu)\n", header_blocksize, maxpoints);
+			unsigned char discard[4096];
+			while(excess > 0)
+			{
+				size_t len = min(excess, sizeof(discard));
+				m_transport->ReadRawData(len, discard);
+				excess -= len;
+			}
+
+			//The transfer is complete, so queue up the next block and let the scope work on it while we decode
+			if(end < total)
+				RequestWaveformBlock(end, min(end + maxpoints, total));
+
+			//Decode straight into the capture
 			//Scale: (value - Yorigin - Yref) * Yinc
-			m_transport->ReadRawData(header_blocksize + 1, temp_buf);	//why is there a trailing byte here??
-			double ydelta = yorigin + yreference;
-			for(size_t j=0; j<header_blocksize; j++)
+			size_t blocklen = min(nread, end - npoint);
+			for(size_t j=0; j<blocklen; j++)
 			{
 				float v = (static_cast<float>(temp_buf[j]) - ydelta) * yincrement;
-				//LogDebug("V = %.3f, temp=%d, delta=%f, inc=%f\n", v, temp_buf[j], ydelta, yincrement);
-				cap->m_samples.push_back(AnalogSample(npoint+j, 1, v));
+				cap->m_samples[npoint+j] = AnalogSample(npoint+j, 1, v);
 			}
-
-			//Done, update the data
-			if(npoint == 0 && !toQueue)
-				m_channels[i]->SetData(cap);
-			else
-				pending_waveforms[i].push_back(cap);
+			for(size_t j=blocklen; j<end-npoint; j++)
+				cap->m_samples[npoint+j] = AnalogSample(npoint+j, 1, 0);
 		}
+
+		//Done, update the data
+		if(!toQueue)
+			m_channels[i]->SetData(cap);
+		else
+			pending_waveforms[i].push_back(cap);
 	}
 
 	//Now that we have all of the pending waveforms, save them in sets across all channels
@@ -478,15 +523,12 @@ bool RigolOscilloscope::AcquireData(bool toQueue)
 	}
 	m_pendingWaveformsMutex.unlock();
 
-	//Clean up
-	delete[] temp_buf;
-
 	//TODO: support digital channels
 
 	//Re-arm the trigger if not in one-shot mode
 	if(!m_triggerOneShot)
 	{
-		m_transport->SendCommand("TRIG_MODE SINGLE");
+		m_transport->SendCommand("SING");
 		m_triggerArmed = true;
 	}
 
@@ -497,7 +539,7 @@ bool RigolOscilloscope::AcquireData(bool toQueue)
 void RigolOscilloscope::Start()
 {
 	//LogDebug("Start single trigger\n");
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 	m_transport->SendCommand("SING");
 	m_triggerArmed = true;
 	m_triggerOneShot = false;
@@ -505,7 +547,7 @@ void RigolOscilloscope::Start()
 
 void RigolOscilloscope::StartSingleTrigger()
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 	m_transport->SendCommand("SING");
 	m_triggerArmed = true;
 	m_triggerOneShot = true;
@@ -513,7 +555,7 @@ void RigolOscilloscope::StartSingleTrigger()
 
 void RigolOscilloscope::Stop()
 {
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 	m_transport->SendCommand("STOP");
 	m_triggerArmed = false;
 	m_triggerOneShot = true;
@@ -531,7 +573,7 @@ size_t RigolOscilloscope::GetTriggerChannelIndex()
 	if(m_triggerChannelValid)
 		return m_triggerChannel;
 
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	//This is nasty because there are separate commands to see what the trigger source is
 	//depending on what the trigger type is!!!
@@ -566,7 +608,7 @@ float RigolOscilloscope::GetTriggerVoltage()
 	if(m_triggerLevelValid)
 		return m_triggerLevel;
 
-	lock_guard<recursive_mutex> lock(m_mutex);
+	lock_guard<FairRecursiveMutex> lock(m_mutex);
 
 	//This is nasty because there are separate commands to see what the trigger source is
 	//depending on what the trigger type is!!!
@@ -84,8 +84,11 @@ public:
 protected:
 	OscilloscopeChannel* m_extTrigChannel;
 
-	//Mutexing for thread safety
-	std::recursive_mutex m_mutex;
+	void RequestWaveformBlock(size_t start, size_t end);
+
+	//Mutexing for thread safety.
+	//m_mutex is fair so that a tight PollTrigger() loop can't starve the UI thread.
+	FairRecursiveMutex m_mutex;
 	std::recursive_mutex m_cacheMutex;
 
 	//hardware analog channel count, independent of LA option etc
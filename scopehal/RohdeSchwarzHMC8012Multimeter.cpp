@@ -43,7 +43,8 @@ RohdeSchwarzHMC8012Multimeter::RohdeSchwarzHMC8012Multimeter(SCPITransport* tran
 
 RohdeSchwarzHMC8012Multimeter::~RohdeSchwarzHMC8012Multimeter()
 {
-
+	//Stop the logger while our virtual functions are still around
+	StopLogging();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -171,6 +172,52 @@ double RohdeSchwarzHMC8012Multimeter::GetTemperature()
 	return d;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data logger
+
+bool RohdeSchwarzHMC8012Multimeter::BeginLogging(size_t blocksize)
+{
+	//Take a whole block of readings for each READ? rather than just one
+	char tmp[64];
+	snprintf(tmp, sizeof(tmp), "SAMP:COUN %zu", blocksize);
+	m_transport->SendCommand(tmp);
+	return true;
+}
+
+bool RohdeSchwarzHMC8012Multimeter::ReadLogBlock(vector<double>& values)
+{
+	//Readings come back as a single comma separated list
+	m_transport->SendCommand("READ?");
+	string str = m_transport->ReadReply();
+	if(str.empty())
+		return false;
+
+	const char* p = str.c_str();
+	while(*p)
+	{
+		char* end;
+		double d = strtod(p, &end);
+		if(end == p)
+			break;
+		values.push_back(d);
+
+		p = end;
+		if(*p == ',')
+			p++;
+	}
+
+	return !values.empty();
+}
+
+void RohdeSchwarzHMC8012Multimeter::EndLogging()
+{
+	//Back to one reading per READ? for GetVoltage() etc
+	m_transport->SendCommand("SAMP:COUN 1");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Channel info
+
 int RohdeSchwarzHMC8012Multimeter::GetMeterChannelCount()
 {
 	return 1;
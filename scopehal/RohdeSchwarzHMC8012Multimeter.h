@@ -74,6 +74,11 @@ public:
 	virtual double GetTemperature();
 
 protected:
+	//Data logger
+	virtual bool BeginLogging(size_t blocksize);
+	virtual bool ReadLogBlock(std::vector<double>& values);
+	virtual void EndLogging();
+
 	MeasurementTypes m_mode;
 };
 
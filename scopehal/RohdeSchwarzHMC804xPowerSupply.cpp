@@ -45,7 +45,8 @@ RohdeSchwarzHMC804xPowerSupply::RohdeSchwarzHMC804xPowerSupply(SCPITransport* tr
 
 RohdeSchwarzHMC804xPowerSupply::~RohdeSchwarzHMC804xPowerSupply()
 {
-
+	//Stop the poller while our virtual functions are still around
+	StopTelemetryPolling();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +83,7 @@ bool RohdeSchwarzHMC804xPowerSupply::IsPowerConstantCurrent(int chan)
 
 int RohdeSchwarzHMC804xPowerSupply::GetStatusRegister(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 
 	//Get status register
@@ -104,6 +106,7 @@ string RohdeSchwarzHMC804xPowerSupply::GetPowerChannelName(int chan)
 
 double RohdeSchwarzHMC804xPowerSupply::GetPowerVoltageActual(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("meas:volt?");
 
@@ -113,6 +116,7 @@ double RohdeSchwarzHMC804xPowerSupply::GetPowerVoltageActual(int chan)
 
 double RohdeSchwarzHMC804xPowerSupply::GetPowerVoltageNominal(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("volt?");
 
@@ -122,6 +126,7 @@ double RohdeSchwarzHMC804xPowerSupply::GetPowerVoltageNominal(int chan)
 
 double RohdeSchwarzHMC804xPowerSupply::GetPowerCurrentActual(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("meas:curr?");
 
@@ -131,6 +136,7 @@ double RohdeSchwarzHMC804xPowerSupply::GetPowerCurrentActual(int chan)
 
 double RohdeSchwarzHMC804xPowerSupply::GetPowerCurrentNominal(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("curr?");
 
@@ -140,6 +146,7 @@ double RohdeSchwarzHMC804xPowerSupply::GetPowerCurrentNominal(int chan)
 
 bool RohdeSchwarzHMC804xPowerSupply::GetPowerChannelActive(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("outp?");
 
@@ -149,6 +156,7 @@ bool RohdeSchwarzHMC804xPowerSupply::GetPowerChannelActive(int chan)
 
 bool RohdeSchwarzHMC804xPowerSupply::IsSoftStartEnabled(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("volt:ramp?");
 	string ret = m_transport->ReadReply();
@@ -157,6 +165,7 @@ bool RohdeSchwarzHMC804xPowerSupply::IsSoftStartEnabled(int chan)
 
 void RohdeSchwarzHMC804xPowerSupply::SetPowerOvercurrentShutdownEnabled(int chan, bool enable)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 
 	if(enable)
@@ -167,6 +176,7 @@ void RohdeSchwarzHMC804xPowerSupply::SetPowerOvercurrentShutdownEnabled(int chan
 
 bool RohdeSchwarzHMC804xPowerSupply::GetPowerOvercurrentShutdownEnabled(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("fuse:stat?");
 
@@ -176,6 +186,7 @@ bool RohdeSchwarzHMC804xPowerSupply::GetPowerOvercurrentShutdownEnabled(int chan
 
 bool RohdeSchwarzHMC804xPowerSupply::GetPowerOvercurrentShutdownTripped(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 	m_transport->SendCommand("fuse:trip?");
 
@@ -185,6 +196,7 @@ bool RohdeSchwarzHMC804xPowerSupply::GetPowerOvercurrentShutdownTripped(int chan
 
 void RohdeSchwarzHMC804xPowerSupply::SetPowerVoltage(int chan, double volts)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 
 	char cmd[128];
@@ -194,6 +206,7 @@ void RohdeSchwarzHMC804xPowerSupply::SetPowerVoltage(int chan, double volts)
 
 void RohdeSchwarzHMC804xPowerSupply::SetPowerCurrent(int chan, double amps)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 
 	char cmd[128];
@@ -203,6 +216,7 @@ void RohdeSchwarzHMC804xPowerSupply::SetPowerCurrent(int chan, double amps)
 
 void RohdeSchwarzHMC804xPowerSupply::SetPowerChannelActive(int chan, bool on)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	SelectChannel(chan);
 
 	if(on)
@@ -213,6 +227,7 @@ void RohdeSchwarzHMC804xPowerSupply::SetPowerChannelActive(int chan, bool on)
 
 bool RohdeSchwarzHMC804xPowerSupply::GetMasterPowerEnable()
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	//not uspported in single channel device, return "always on"
 	if(m_channelCount == 1)
 		return true;
@@ -227,6 +242,7 @@ bool RohdeSchwarzHMC804xPowerSupply::GetMasterPowerEnable()
 
 void RohdeSchwarzHMC804xPowerSupply::SetMasterPowerEnable(bool enable)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	//not supported in single channel device
 	if(m_channelCount == 1)
 		return;
@@ -237,8 +253,45 @@ void RohdeSchwarzHMC804xPowerSupply::SetMasterPowerEnable(bool enable)
 		m_transport->SendCommand("outp:mast off");
 }
 
+/**
+	@brief Reads back every channel's measurements and status in a single pipelined batch.
+
+	All of the channel select and query commands go out in one write, then the replies are read back in order.
+ */
+PowerSupplyTelemetry RohdeSchwarzHMC804xPowerSupply::GetTelemetrySnapshot()
+{
+	lock_guard<recursive_mutex> lock(m_mutex);
+
+	PowerSupplyTelemetry ret;
+	ret.m_channels.resize(m_channelCount);
+
+	m_transport->BeginBatch();
+	for(int i=0; i<m_channelCount; i++)
+	{
+		SelectChannel(i);
+		m_transport->SendCommand("meas:volt?");
+		m_transport->SendCommand("meas:curr?");
+		m_transport->SendCommand("outp?");
+		m_transport->SendCommand("stat:ques:cond?");
+	}
+	m_transport->EndBatch();
+
+	for(int i=0; i<m_channelCount; i++)
+	{
+		auto& chan = ret.m_channels[i];
+		chan.m_voltageActual = atof(m_transport->ReadReply().c_str());
+		chan.m_currentActual = atof(m_transport->ReadReply().c_str());
+		chan.m_active = atoi(m_transport->ReadReply().c_str()) ? true : false;
+		chan.m_constantCurrent = (atoi(m_transport->ReadReply().c_str()) & 0x02) ? true : false;	//CC bit
+	}
+
+	ret.m_timestamp = GetTime();
+	return ret;
+}
+
 bool RohdeSchwarzHMC804xPowerSupply::SelectChannel(int chan)
 {
+	lock_guard<recursive_mutex> lock(m_mutex);
 	//per HMC804x SCPI manual page 26, this command is neither supported nor required
 	//for the single channel device
 	if(m_channelCount == 1)
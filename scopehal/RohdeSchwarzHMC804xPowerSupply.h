@@ -74,6 +74,9 @@ public:
 
 	virtual bool IsSoftStartEnabled(int chan);
 
+	//Bulk readout
+	virtual PowerSupplyTelemetry GetTelemetrySnapshot();
+
 protected:
 	int GetStatusRegister(int chan);
 
@@ -83,6 +86,9 @@ protected:
 	int m_channelCount;
 
 	int m_activeChannel;
+
+	//Serializes access to the instrument, since telemetry may be polled from a background thread
+	std::recursive_mutex m_mutex;
 };
 
 #endif
@@ -402,36 +402,33 @@ bool RohdeSchwarzOscilloscope::AcquireData(bool toQueue)
 {
 	//LogDebug("Acquiring data\n");
 
+	vector<size_t> channels;
+	vector<bool> enabled = GetEnabledChannelMask(m_analogChannelCount, channels);
+
 	lock_guard<recursive_mutex> lock(m_mutex);
 	LogIndenter li;
 
-	double xstart;
-	double xstop;
-	size_t length;
-	int ignored;
+	//Fetch one channel at a time, reading each reply before sending the next query.
+	//An IEEE 488.2 instrument discards an unread response (and flags a query error) if another query arrives first.
 	map<int, vector<AnalogCapture*> > pending_waveforms;
-	for(size_t i=0; i<m_analogChannelCount; i++)
+	for(auto i : channels)
 	{
-		if(!IsChannelEnabled(i))
-		{
-			if(!toQueue)
-				m_channels[i]->SetData(NULL);
-			continue;
-		}
-
+		//Get the header.
 		//This is basically the same function as a LeCroy WAVEDESC, but much less detailed
 		m_transport->SendCommand(m_channels[i]->GetHwname() + ":DATA:HEAD?");
 		string reply = m_transport->ReadReply();
-		sscanf(reply.c_str(), "%lf,%lf,%zu,%d", &xstart, &xstop, &length, &ignored);
+		double xstart = 0;
+		double xstop = 0;
+		size_t expected = 0;
+		int ignored;
+		sscanf(reply.c_str(), "%lf,%lf,%zu,%d", &xstart, &xstop, &expected, &ignored);
 
 		//Figure out the sample rate
 		double capture_len_sec = xstop - xstart;
-		double sec_per_sample = capture_len_sec / length;
+		double sec_per_sample = (expected != 0) ? capture_len_sec / expected : 0;
 		int64_t ps_per_sample = round(sec_per_sample * 1e12f);
 		//LogDebug("%ld ps/sample\n", ps_per_sample);
 
-		float* temp_buf = new float[length];
-
 		//Set up the capture we're going to store our data into (no high res timer on R&S scopes)
 		AnalogCapture* cap = new AnalogCapture;
 		cap->m_timescale = ps_per_sample;
@@ -440,31 +437,34 @@ bool RohdeSchwarzOscilloscope::AcquireData(bool toQueue)
 		double t = GetTime();
 		cap->m_startPicoseconds = (t - floor(t)) * 1e12f;
 
-		//Ask for the data
+		//Ask for the data and read the length header
 		m_transport->SendCommand(m_channels[i]->GetHwname() + ":DATA?");
-
-		//Read and discard the length header
 		char tmp[16] = {0};
 		m_transport->ReadRawData(2, (unsigned char*)tmp);
 		int num_digits = atoi(tmp+1);
 		m_transport->ReadRawData(num_digits, (unsigned char*)tmp);
-		int actual_len = atoi(tmp);
+		tmp[num_digits] = 0;
+		size_t actual_len = strtoul(tmp, NULL, 10);
+
+		//Trust the block header over DATA:HEAD? if they disagree, since that's what's actually on the wire
+		size_t length = actual_len / sizeof(float);
+		if(length != expected)
+			LogWarning("%s: expected %zu points, got %zu\n", m_channels[i]->GetHwname().c_str(), expected, length);
 
-		//Read the actual data
-		m_transport->ReadRawData(length*sizeof(float), (unsigned char*)temp_buf);
+		//Read the actual data straight into the capture
+		ReadAnalogBlock<float>(cap, length);
 
-		//Format the capture
-		for(size_t i=0; i<length; i++)
-			cap->m_samples.push_back(AnalogSample(i, 1, temp_buf[i]));
+		//Discard any odd trailing bytes, plus the newline terminating the block
+		size_t used = length*sizeof(float);
+		size_t extra = (actual_len > used) ? (actual_len - used) : 0;
+		unsigned char trailer[sizeof(float) + 1];
+		m_transport->ReadRawData(extra + 1, trailer);
 
 		//Done, update the data
 		if(!toQueue)
 			m_channels[i]->SetData(cap);
 		else
 			pending_waveforms[i].push_back(cap);
-
-		//Clean up
-		delete[] temp_buf;
 	}
 
 	//Now that we have all of the pending waveforms, save them in sets across all channels
@@ -477,13 +477,23 @@ bool RohdeSchwarzOscilloscope::AcquireData(bool toQueue)
 		SequenceSet s;
 		for(size_t j=0; j<m_analogChannelCount; j++)
 		{
-			if(IsChannelEnabled(j))
+			if(enabled[j])
 				s[m_channels[j]] = pending_waveforms[j][i];
 		}
 		m_pendingWaveforms.push_back(s);
 	}
 	m_pendingWaveformsMutex.unlock();
 
+	//Disabled channels get cleared
+	if(!toQueue)
+	{
+		for(size_t i=0; i<m_analogChannelCount; i++)
+		{
+			if(!enabled[i])
+				m_channels[i]->SetData(NULL);
+		}
+	}
+
 	//TODO: support digital channels
 
 	//Re-arm the trigger if not in one-shot mode
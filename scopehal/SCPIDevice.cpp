@@ -39,8 +39,27 @@ SCPIDevice::SCPIDevice()
 	//mostly used by not-quite-really-scpi devices that use SCPITransport but don't implement *IDN?
 }
 
-SCPIDevice::SCPIDevice(SCPITransport* transport)
+SCPIDevice::SCPIDevice(SCPITransport* transport, bool identify)
 	: m_transport(transport)
+{
+	//Drivers which need to configure the instrument before *IDN? can be parsed (e.g. turning off headers)
+	//skip this and call Identify() themselves, so we don't waste a round trip asking twice
+	if(identify)
+		Identify();
+}
+
+SCPIDevice::~SCPIDevice()
+{
+	delete m_transport;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Identification
+
+/**
+	@brief Queries *IDN? and fills in the vendor, model, serial, and firmware version fields
+ */
+void SCPIDevice::Identify()
 {
 	//Ask for the ID
 	m_transport->SendCommand("*IDN?");
@@ -59,8 +78,3 @@ SCPIDevice::SCPIDevice(SCPITransport* transport)
 	m_serial = serial;
 	m_fwVersion = version;
 }
-
-SCPIDevice::~SCPIDevice()
-{
-	delete m_transport;
-}
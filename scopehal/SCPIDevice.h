@@ -37,10 +37,12 @@ class SCPIDevice
 {
 public:
 	SCPIDevice();
-	SCPIDevice(SCPITransport* transport);
+	SCPIDevice(SCPITransport* transport, bool identify = true);
 	virtual ~SCPIDevice();
 
 protected:
+	void Identify();
+
 	SCPITransport* m_transport;
 
 	//standard *IDN? fields
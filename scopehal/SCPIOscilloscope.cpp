@@ -34,8 +34,8 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
-SCPIOscilloscope::SCPIOscilloscope(SCPITransport* transport)
-	: SCPIDevice(transport)
+SCPIOscilloscope::SCPIOscilloscope(SCPITransport* transport, bool identify)
+	: SCPIDevice(transport, identify)
 {
 
 }
@@ -58,6 +58,41 @@ string SCPIOscilloscope::GetTransportConnectionString()
 	return m_transport->GetConnectionString();
 }
 
+/**
+	@brief Snapshots which analog channels are enabled, for use by AcquireData().
+
+	Lock order: drivers' IsChannelEnabled() takes the config cache mutex and then the main mutex, so it must not be
+	called with the main mutex already held or two threads can deadlock. AcquireData() must therefore call this
+	before locking m_mutex. The result is normally served from the cache, so this costs nothing on the wire.
+
+	@param count	Number of channels to check, starting from channel 0 (normally the analog channel count)
+	@param channels	Set to the indexes of the enabled channels, in order
+
+	@return One entry per channel checked, true if enabled
+ */
+vector<bool> SCPIOscilloscope::GetEnabledChannelMask(size_t count, vector<size_t>& channels)
+{
+	vector<bool> enabled;
+	channels.clear();
+	for(size_t i=0; i<count; i++)
+	{
+		bool en = IsChannelEnabled(i);
+		enabled.push_back(en);
+		if(en)
+			channels.push_back(i);
+	}
+	return enabled;
+}
+
+/**
+	@brief Snapshots which analog channels are enabled, without the index list. Same locking rules as above.
+ */
+vector<bool> SCPIOscilloscope::GetEnabledChannelMask(size_t count)
+{
+	vector<size_t> channels;
+	return GetEnabledChannelMask(count, channels);
+}
+
 string SCPIOscilloscope::GetName()
 {
 	return m_model;
@@ -72,3 +107,29 @@ string SCPIOscilloscope::GetSerial()
 {
 	return m_serial;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Serialization
+
+/**
+	@brief Load the configuration of a single channel from a save file.
+
+	Each channel's setup commands are sent as one batch, rather than one write per setting. Batching is per channel
+	and not per instrument: if a channel's config is malformed, the commands already queued for that channel are
+	still sent, channels before it keep their new settings, and channels after it are left untouched.
+ */
+void SCPIOscilloscope::LoadChannelConfiguration(const YAML::Node& cnode, IDTable& idmap)
+{
+	m_transport->BeginBatch();
+	try
+	{
+		Oscilloscope::LoadChannelConfiguration(cnode, idmap);
+	}
+	catch(...)
+	{
+		//Don't leave the transport stuck in batch mode if the save file is malformed
+		m_transport->EndBatch();
+		throw;
+	}
+	m_transport->EndBatch();
+}
@@ -30,6 +30,8 @@
 #ifndef SCPIOscilloscope_h
 #define SCPIOscilloscope_h
 
+#include <cstring>
+
 /**
 	@brief An SCPI-based oscilloscope
  */
@@ -37,7 +39,7 @@ class SCPIOscilloscope 	: public Oscilloscope
 						, public SCPIDevice
 {
 public:
-	SCPIOscilloscope(SCPITransport* transport);
+	SCPIOscilloscope(SCPITransport* transport, bool identify = true);
 	virtual ~SCPIOscilloscope();
 
 	virtual std::string GetTransportConnectionString();
@@ -46,6 +48,97 @@ public:
 	virtual std::string GetName();
 	virtual std::string GetVendor();
 	virtual std::string GetSerial();
+
+protected:
+	virtual void LoadChannelConfiguration(const YAML::Node& cnode, IDTable& idmap);
+
+	std::vector<bool> GetEnabledChannelMask(size_t count, std::vector<size_t>& channels);
+	std::vector<bool> GetEnabledChannelMask(size_t count);
+
+	template<class T>
+	void ReadAnalogBlock(AnalogCapture* cap, size_t nsamples, float scale = 1, float offset = 0);
+
+	template<class T>
+	void ReadRawBlock(AnalogCapture* cap, size_t nsamples);
+
+	template<class T>
+	static void ExpandAnalogBlock(AnalogCapture* cap, size_t nsamples, float scale = 1, float offset = 0);
 };
 
+/**
+	@brief Reads a binary block of raw samples straight into a capture, with no intermediate buffer.
+
+	Equivalent to ReadRawBlock() followed by ExpandAnalogBlock(). Drivers that pipeline requests should call the two
+	halves separately, and send the next request in between once the transport is idle.
+
+	@param cap		Capture to fill. It is resized to nsamples points.
+	@param nsamples	Number of points in the block
+	@param scale	Volts per LSB
+	@param offset	Volts at a raw value of zero
+ */
+template<class T>
+void SCPIOscilloscope::ReadAnalogBlock(AnalogCapture* cap, size_t nsamples, float scale, float offset)
+{
+	ReadRawBlock<T>(cap, nsamples);
+	ExpandAnalogBlock<T>(cap, nsamples, scale, offset);
+}
+
+/**
+	@brief Reads nsamples raw values (of type T, in host byte order) into the front of the capture's sample array.
+
+	The capture is resized to nsamples points. Its contents are not valid samples until ExpandAnalogBlock() runs.
+ */
+template<class T>
+void SCPIOscilloscope::ReadRawBlock(AnalogCapture* cap, size_t nsamples)
+{
+	static_assert(sizeof(AnalogSample) >= sizeof(T), "AnalogSample must be at least as big as a raw sample");
+
+	cap->m_samples.resize(nsamples);
+	if(nsamples == 0)
+		return;
+
+	m_transport->ReadRawData(nsamples * sizeof(T), reinterpret_cast<unsigned char*>(&cap->m_samples[0]));
+}
+
+/**
+	@brief Expands raw values left at the front of a capture by ReadRawBlock() into scaled AnalogSamples, in place.
+
+	Works backwards from the end. Sample k occupies bytes [k*sizeof(AnalogSample), (k+1)*sizeof(AnalogSample)) and
+	its raw value lives at [k*sizeof(T), (k+1)*sizeof(T)), so every raw value a block of samples overwrites has
+	already been consumed.
+
+	Each sample is computed as raw*scale + offset. The conversion runs over small blocks on the stack so the
+	compiler can vectorize it.
+ */
+template<class T>
+void SCPIOscilloscope::ExpandAnalogBlock(AnalogCapture* cap, size_t nsamples, float scale, float offset)
+{
+	static_assert(sizeof(AnalogSample) >= sizeof(T), "AnalogSample must be at least as big as a raw sample");
+
+	if(nsamples == 0)
+		return;
+	unsigned char* base = reinterpret_cast<unsigned char*>(&cap->m_samples[0]);
+
+	const size_t blocksize = 1024;
+	T raw[blocksize];
+	float volts[blocksize];
+	size_t end = nsamples;
+	while(end > 0)
+	{
+		size_t start = (end > blocksize) ? (end - blocksize) : 0;
+		size_t len = end - start;
+
+		memcpy(raw, base + start*sizeof(T), len*sizeof(T));
+
+		#pragma omp simd
+		for(size_t j=0; j<len; j++)
+			volts[j] = raw[j]*scale + offset;
+
+		for(size_t j=0; j<len; j++)
+			cap->m_samples[start+j] = AnalogSample(start+j, 1, volts[j]);
+
+		end = start;
+	}
+}
+
 #endif
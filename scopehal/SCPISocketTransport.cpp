@@ -94,11 +94,18 @@ bool SCPISocketTransport::SendCommand(string cmd)
 {
 	LogTrace("Sending %s\n", cmd.c_str());
 	string tempbuf = cmd + "\n";
+	if(m_batchDepth)
+	{
+		m_batchBuffer += tempbuf;
+		return true;
+	}
 	return m_socket.SendLooped((unsigned char*)tempbuf.c_str(), tempbuf.length());
 }
 
 string SCPISocketTransport::ReadReply()
 {
+	FlushBatch();
+
 	//FIXME: there *has* to be a more efficient way to do this...
 	char tmp = ' ';
 	string ret;
@@ -117,10 +124,14 @@ string SCPISocketTransport::ReadReply()
 
 void SCPISocketTransport::SendRawData(size_t len, const unsigned char* buf)
 {
-	m_socket.SendLooped(buf, len);
+	if(m_batchDepth)
+		m_batchBuffer.append((const char*)buf, len);
+	else
+		m_socket.SendLooped(buf, len);
 }
 
 void SCPISocketTransport::ReadRawData(size_t len, unsigned char* buf)
 {
+	FlushBatch();
 	m_socket.RecvLooped(buf, len);
 }
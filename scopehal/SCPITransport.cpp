@@ -40,6 +40,7 @@ using namespace std;
 SCPITransport::CreateMapType SCPITransport::m_createprocs;
 
 SCPITransport::SCPITransport()
+	: m_batchDepth(0)
 {
 }
 
@@ -47,6 +48,42 @@ SCPITransport::~SCPITransport()
 {
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Command batching
+
+void SCPITransport::EndBatch()
+{
+	if(m_batchDepth == 0)
+	{
+		LogWarning("SCPITransport::EndBatch called without matching BeginBatch\n");
+		return;
+	}
+
+	m_batchDepth --;
+	if(m_batchDepth == 0)
+		FlushBatch();
+}
+
+/**
+	@brief Sends any batched data.
+
+	Transports which support batching append to m_batchBuffer in SendRawData() while m_batchDepth is nonzero, so
+	batching is temporarily turned off while the buffered data is pushed out.
+ */
+void SCPITransport::FlushBatch()
+{
+	if(m_batchBuffer.empty())
+		return;
+
+	string buf;
+	buf.swap(m_batchBuffer);
+
+	unsigned int depth = m_batchDepth;
+	m_batchDepth = 0;
+	SendRawData(buf.size(), (const unsigned char*)buf.c_str());
+	m_batchDepth = depth;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Enumeration
 
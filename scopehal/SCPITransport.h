@@ -53,6 +53,27 @@ public:
 	virtual void ReadRawData(size_t len, unsigned char* buf) =0;
 	virtual void SendRawData(size_t len, const unsigned char* buf) =0;
 
+	/**
+		@brief Starts batching outbound data.
+
+		Until the matching EndBatch() call, commands are buffered locally instead of being sent one at a time, and the
+		whole batch goes out in as few writes as possible. Any read flushes the batch first, so replies are never
+		waited on for commands that have not yet been sent. Batches may be nested.
+	 */
+	void BeginBatch()
+	{ m_batchDepth ++; }
+
+	void EndBatch();
+
+protected:
+	void FlushBatch();
+
+	///Nesting depth of BeginBatch() calls (zero if not batching)
+	unsigned int m_batchDepth;
+
+	///Data waiting to be sent at the end of the current batch
+	std::string m_batchBuffer;
+
 public:
 	typedef SCPITransport* (*CreateProcType)(std::string args);
 	static void DoAddTransportClass(std::string name, CreateProcType proc);
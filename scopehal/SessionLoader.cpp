@@ -0,0 +1,177 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of SessionLoader
+ */
+
+#include "scopehal.h"
+#include <thread>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+SessionLoader::SessionLoader()
+	: m_totalTime(0)
+{
+}
+
+SessionLoader::~SessionLoader()
+{
+	//Instruments are owned by the caller
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+
+/**
+	@brief Connects to every instrument in a saved session and loads its configuration.
+
+	@param node		The "instruments" block of the save file (one child per instrument, as written by
+					Oscilloscope::SerializeConfiguration())
+	@param table	ID table to add the instruments and their channels to
+
+	@return True if every instrument was loaded, false if any failed
+ */
+bool SessionLoader::LoadInstruments(const YAML::Node& node, IDTable& table)
+{
+	double start = GetTime();
+
+	vector<YAML::Node> nodes;
+	for(auto it : node)
+		nodes.push_back(it.second);
+
+	//IDTable isn't thread safe, so give each thread a private table and merge them afterwards
+	m_status.clear();
+	m_status.resize(nodes.size());
+	vector<IDTable> tables(nodes.size());
+	vector<thread> threads;
+	for(size_t i=0; i<nodes.size(); i++)
+		threads.push_back(thread(&SessionLoader::LoadInstrument, this, nodes[i], ref(tables[i]), ref(m_status[i])));
+	for(auto& t : threads)
+		t.join();
+
+	bool ok = true;
+	for(size_t i=0; i<nodes.size(); i++)
+	{
+		if(m_status[i].m_scope == NULL)
+		{
+			ok = false;
+			continue;
+		}
+
+		for(auto it : tables[i])
+		{
+			if(it.first != 0)
+				table.emplace(it.first, it.second);
+		}
+	}
+
+	m_totalTime = GetTime() - start;
+	return ok;
+}
+
+/**
+	@brief Connects to and configures a single instrument (runs in its own thread)
+ */
+void SessionLoader::LoadInstrument(const YAML::Node& node, IDTable& table, InstrumentStatus& status)
+{
+	Oscilloscope* scope = NULL;
+	try
+	{
+		status.m_nickname = node["nick"].as<string>();
+		string transport = node["transport"].as<string>();
+		string args = node["args"].as<string>();
+		string driver = node["driver"].as<string>();
+
+		//Connect to the instrument
+		double start = GetTime();
+		auto ptransport = SCPITransport::CreateTransport(transport, args);
+		if(ptransport == NULL)
+		{
+			LogError("Couldn't create transport %s for instrument %s\n", transport.c_str(), status.m_nickname.c_str());
+			return;
+		}
+		scope = Oscilloscope::CreateOscilloscope(driver, ptransport);
+		if(scope == NULL)
+		{
+			LogError("Couldn't create driver %s for instrument %s\n", driver.c_str(), status.m_nickname.c_str());
+			delete ptransport;
+			return;
+		}
+		status.m_connectTime = GetTime() - start;
+
+		//Sanity check that it's the same instrument we saved
+		string serial = node["serial"].as<string>();
+		if(scope->GetSerial() != serial)
+		{
+			LogWarning("Instrument %s has serial number %s, but save file expected %s\n",
+				status.m_nickname.c_str(), scope->GetSerial().c_str(), serial.c_str());
+		}
+
+		//Apply the saved configuration
+		start = GetTime();
+		scope->m_nickname = status.m_nickname;
+		table.emplace(node["id"].as<int>(), scope);
+		scope->LoadConfiguration(node, table);
+		status.m_configTime = GetTime() - start;
+
+		status.m_scope = scope;
+	}
+	catch(const YAML::Exception& e)
+	{
+		LogError("Malformed configuration for instrument %s: %s\n", status.m_nickname.c_str(), e.what());
+		delete scope;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reporting
+
+void SessionLoader::LogTimingReport()
+{
+	LogDebug("Session load took %.3f ms\n", m_totalTime * 1000);
+	LogIndenter li;
+	for(auto& s : m_status)
+	{
+		if(s.m_scope == NULL)
+			LogDebug("%-20s failed\n", s.m_nickname.c_str());
+		else
+		{
+			LogDebug("%-20s connect %8.3f ms, configure %8.3f ms\n",
+				s.m_nickname.c_str(),
+				s.m_connectTime * 1000,
+				s.m_configTime * 1000);
+		}
+	}
+}
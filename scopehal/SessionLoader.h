@@ -0,0 +1,94 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of SessionLoader
+ */
+
+#ifndef SessionLoader_h
+#define SessionLoader_h
+
+/**
+	@brief Connects to and configures all of the instruments in a saved session.
+
+	Every instrument is connected and configured on its own thread, so the time to load a session is that of the
+	slowest instrument rather than the sum of all of them. Each channel's configuration is sent to the instrument
+	as a single batch (see SCPIOscilloscope::LoadChannelConfiguration()).
+ */
+class SessionLoader
+{
+public:
+	SessionLoader();
+	virtual ~SessionLoader();
+
+	/**
+		@brief Load status and timing for a single instrument
+	 */
+	class InstrumentStatus
+	{
+	public:
+		InstrumentStatus()
+		: m_scope(NULL)
+		, m_connectTime(0)
+		, m_configTime(0)
+		{}
+
+		///Nickname from the save file
+		std::string m_nickname;
+
+		///The instrument, or NULL if we couldn't connect to it
+		Oscilloscope* m_scope;
+
+		///Time spent creating the transport and driver (including identification), in seconds
+		double m_connectTime;
+
+		///Time spent applying the saved configuration, in seconds
+		double m_configTime;
+	};
+
+	bool LoadInstruments(const YAML::Node& node, IDTable& table);
+
+	const std::vector<InstrumentStatus>& GetStatus()
+	{ return m_status; }
+
+	void LogTimingReport();
+
+protected:
+	void LoadInstrument(const YAML::Node& node, IDTable& table, InstrumentStatus& status);
+
+	///Status of each instrument, in the same order as the save file
+	std::vector<InstrumentStatus> m_status;
+
+	///Total wall clock time for the most recent load, in seconds
+	double m_totalTime;
+};
+
+#endif
@@ -91,6 +91,29 @@ void SiglentSCPIOscilloscope::ReadWaveDescriptorBlock(SiglentWaveformDesc_t *des
 	m_transport->ReadReply();
 }
 
+/**
+	@brief Selects a segment and asks for one channel's data from it.
+
+	WAVEFORM_SETUP is sticky, so it only needs to be sent once per segment rather than once per channel. The other
+	channels of the segment are requested one at a time, as each previous reply is read.
+ */
+void SiglentSCPIOscilloscope::RequestSegment(unsigned int segment, unsigned int num_sequences, unsigned int channel)
+{
+	m_transport->BeginBatch();
+
+	//Select the segment of interest (segment number is ignored for non-segmented waveforms)
+	if(num_sequences > 1)
+	{
+		char tmp[128];
+		snprintf(tmp, sizeof(tmp), "WAVEFORM_SETUP SP,0,NP,0,FP,0,SN,%u", segment + 1);	//0 = "all", 1 = first segment
+		m_transport->SendCommand(tmp);
+	}
+
+	m_transport->SendCommand(m_channels[channel]->GetHwname() + ":WF? DAT2");
+
+	m_transport->EndBatch();
+}
+
 bool SiglentSCPIOscilloscope::AcquireData(bool toQueue)
 {
 	lock_guard<recursive_mutex> lock(m_mutex);
@@ -99,147 +122,175 @@ bool SiglentSCPIOscilloscope::AcquireData(bool toQueue)
 
 	double start = GetTime();
 
-
-	//Read the wavedesc for every enabled channel in batch mode first
-	vector<struct SiglentWaveformDesc_t*> wavedescs;
-	char tmp[128];
-	string cmd;
+	//Read the wavedesc for every enabled channel first
 	bool enabled[4] = {false};
 	BulkCheckChannelEnableState();
 	for(unsigned int i=0; i<m_analogChannelCount; i++)
 		enabled[i] = IsChannelEnabled(i);
 
+	vector<struct SiglentWaveformDesc_t> wavedescs(m_analogChannelCount);
+	int firstEnabledChannel = -1;
 	for(unsigned int i=0; i<m_analogChannelCount; i++)
 	{
-		wavedescs.push_back(new struct SiglentWaveformDesc_t);
-		if(enabled[i])
-		{
-			m_transport->SendCommand(m_channels[i]->GetHwname() + ":WF? DESC");
-			ReadWaveDescriptorBlock(wavedescs[i], i);
-			LogDebug("name %s, number: %u\n",wavedescs[i]->InstrumentName,
-				wavedescs[i]->InstrumentNumber);
+		if(!enabled[i])
+			continue;
 
-		}
+		m_transport->SendCommand(m_channels[i]->GetHwname() + ":WF? DESC");
+		ReadWaveDescriptorBlock(&wavedescs[i], i);
+		LogDebug("name %s, number: %u\n",wavedescs[i].InstrumentName,
+			wavedescs[i].InstrumentNumber);
 	}
 
-	// grab the actual waveforms
-
-	//TODO: WFSU in outer loop and WF in inner loop
-	unsigned int num_sequences = 1;
+	//If the channel is invisible, don't waste time capturing data
 	for(unsigned int i=0; i<m_analogChannelCount; i++)
 	{
-		//If the channel is invisible, don't waste time capturing data
-		struct SiglentWaveformDesc_t *wavedesc = wavedescs[i];
-		if(string(wavedesc->DescName).empty())
-		{
+		if(enabled[i] && string(wavedescs[i].DescName).empty())
+			enabled[i] = false;
+		if(!enabled[i] && !toQueue)
 			m_channels[i]->SetData(NULL);
-			continue;
+
+		if(enabled[i] && (firstEnabledChannel < 0) )
+			firstEnabledChannel = i;
+	}
+
+	//Nothing to download, but this still counts as a completed acquisition. Keep the trigger going.
+	if(firstEnabledChannel < 0)
+	{
+		if(!m_triggerOneShot)
+		{
+			m_transport->SendCommand("TRIG_MODE SINGLE");
+			m_triggerArmed = true;
 		}
+		return true;
+	}
+
+	//Figure out how many sequences we have (16 bytes of trigger time per segment)
+	struct SiglentWaveformDesc_t* firstdesc = &wavedescs[firstEnabledChannel];
+	unsigned int num_sequences = 1;
+	if(firstdesc->TriggerTimeArrayLen >= 16)
+		num_sequences = firstdesc->TriggerTimeArrayLen / 16;
+	LogDebug("    Trigtime len: %d (%u segments)\n", firstdesc->TriggerTimeArrayLen, num_sequences);
+
+	//Timestamp is a somewhat complex format that needs some shuffling around.
+	double fseconds = firstdesc->Timestamp.Seconds;
+	uint8_t seconds = floor(firstdesc->Timestamp.Seconds);
+	double basetime = fseconds - seconds;
+	time_t tnow = time(NULL);
+	struct tm* now = localtime(&tnow);
+	struct tm tstruc;
+	tstruc.tm_sec = seconds;
+	tstruc.tm_min = firstdesc->Timestamp.Minutes;
+	tstruc.tm_hour = firstdesc->Timestamp.Hours;
+	tstruc.tm_mday = firstdesc->Timestamp.Days;
+	tstruc.tm_mon = firstdesc->Timestamp.Months;
+	tstruc.tm_year = firstdesc->Timestamp.Years;
+	tstruc.tm_wday = now->tm_wday;
+	tstruc.tm_yday = now->tm_yday;
+	tstruc.tm_isdst = now->tm_isdst;
+	time_t ttime = mktime(&tstruc);
+
+	//If a multi-segment capture, grab the trigger time of every segment in one go.
+	//This is pairs of doubles: trigger time relative to the first segment, then offset to point 0.
+	char header[17] = {0};
+	vector<double> wavetime;
+	if(num_sequences > 1)
+	{
+		m_transport->SendCommand(m_channels[firstEnabledChannel]->GetHwname() + ":WF? TIME");
+		size_t timesize = ReadWaveHeader(header);
+		wavetime.resize( (timesize + sizeof(double) - 1) / sizeof(double) );
+		m_transport->ReadRawData(timesize, (unsigned char*)&wavetime[0]);
+		// \n
+		m_transport->ReadReply();
+		if(wavetime.size() < num_sequences*2)
+			wavetime.resize(num_sequences*2, 0);
+	}
 
-		//Set up the capture we're going to store our data into
-		AnalogCapture* cap = new AnalogCapture;
-
-		//TODO: get sequence count from wavedesc
-		//TODO: sequence mode should be multiple captures, one per sequence, with some kind of fifo or something?
-
-		//Parse the wavedesc headers
-		LogDebug("    Wavedesc len: %d\n", wavedesc->WaveDescLen);
-		LogDebug("    Usertext len: %d\n", wavedesc->UserTextLen);
-		LogDebug("    Trigtime len: %d\n", wavedesc->TriggerTimeArrayLen);
-
-		if(wavedesc->TriggerTimeArrayLen != 0)
-			num_sequences = wavedesc->TriggerTimeArrayLen;
-		float v_gain = wavedesc->VerticalGain;
-		float v_off = wavedesc->VerticalOffset;
-		float interval = wavedesc->HorizontalInterval * 1e12f;
-		double h_off = wavedesc->HorizontalOffset * 1e12f;	//ps from start of waveform to trigger
-		double h_off_frac = fmodf(h_off, interval);						//fractional sample position, in ps
-		if(h_off_frac < 0)
-			h_off_frac = interval + h_off_frac;
-		cap->m_triggerPhase = h_off_frac;	//TODO: handle this properly in segmented mode?
-											//We might have multiple offsets
-		//double h_unit = *reinterpret_cast<double*>(pdesc + 244);
-
-		//Timestamp is a somewhat complex format that needs some shuffling around.
-		double fseconds = wavedesc->Timestamp.Seconds;
-		uint8_t seconds = floor(wavedesc->Timestamp.Seconds);
-		cap->m_startPicoseconds = static_cast<int64_t>( (fseconds - seconds) * 1e12f );
-		time_t tnow = time(NULL);
-		struct tm* now = localtime(&tnow);
-		struct tm tstruc;
-		tstruc.tm_sec = seconds;
-		tstruc.tm_min = wavedesc->Timestamp.Minutes;
-		tstruc.tm_hour = wavedesc->Timestamp.Hours;
-		tstruc.tm_mday = wavedesc->Timestamp.Days;
-		tstruc.tm_mon = wavedesc->Timestamp.Months;
-		tstruc.tm_year = wavedesc->Timestamp.Years;
-		tstruc.tm_wday = now->tm_wday;
-		tstruc.tm_yday = now->tm_yday;
-		tstruc.tm_isdst = now->tm_isdst;
-		cap->m_startTimestamp = mktime(&tstruc);
-		cap->m_timescale = round(interval);
-		for(unsigned int j=0; j<num_sequences; j++)
+	//Find the last channel we read in each segment
+	unsigned int lastEnabledChannel = firstEnabledChannel;
+	for(unsigned int i=0; i<m_analogChannelCount; i++)
+	{
+		if(enabled[i])
+			lastEnabledChannel = i;
+	}
+
+	//Pull down the waveforms one segment at a time, and one channel at a time within each segment.
+	//Each query is only sent once the previous reply has been read in full. The exception is the first channel of
+	//the next segment, which is requested as soon as the last block of this one is read, before we convert it.
+	map<int, vector<AnalogCapture*> > pending_waveforms;
+	RequestSegment(0, num_sequences, firstEnabledChannel);
+	for(unsigned int j=0; j<num_sequences; j++)
+	{
+		for(unsigned int i=0; i<m_analogChannelCount; i++)
 		{
-			LogDebug("Channel %u block %u\n", i, j);
+			if(!enabled[i])
+				continue;
 
-			//Ask for the segment of interest
-			//(segment number is ignored for non-segmented waveforms)
-			cmd = "WAVEFORM_SETUP SP,0,NP,0,FP,0,SN,";
+			LogDebug("Channel %u block %u\n", i, j);
+			if(i != (unsigned int)firstEnabledChannel)
+				m_transport->SendCommand(m_channels[i]->GetHwname() + ":WF? DAT2");
+
+			//Parse the wavedesc headers
+			struct SiglentWaveformDesc_t *wavedesc = &wavedescs[i];
+			float v_gain = wavedesc->VerticalGain;
+			float v_off = wavedesc->VerticalOffset;
+			float interval = wavedesc->HorizontalInterval * 1e12f;
+			double h_off = wavedesc->HorizontalOffset * 1e12f;	//ps from start of waveform to trigger
+			double h_off_frac = fmodf(h_off, interval);						//fractional sample position, in ps
+			if(h_off_frac < 0)
+				h_off_frac = interval + h_off_frac;
+			//double h_unit = *reinterpret_cast<double*>(pdesc + 244);
+
+			//Set up the capture we're going to store our data into.
+			//Each segment gets its own capture, timestamped with its own trigger time.
+			AnalogCapture* cap = new AnalogCapture;
+			cap->m_timescale = round(interval);
+			cap->m_triggerPhase = h_off_frac;
+			//Segment trigger offsets can be more than a second, so carry whole seconds into the timestamp
+			double tstart = basetime;
 			if(num_sequences > 1)
-			{
-				snprintf(tmp, sizeof(tmp), "%u", j + 1);	//segment 0 = "all", 1 = first part of capture
-				cmd += tmp;
-				m_transport->SendCommand(cmd);
-			}
-
-			//Read the actual waveform data
-			cmd = "C1:WF? DAT2";
-			cmd[1] += i;
-			m_transport->SendCommand(cmd);
-			char header[17] = {0};
+				tstart += wavetime[j*2];
+			double tsec = floor(tstart);
+			cap->m_startTimestamp = ttime + static_cast<time_t>(tsec);
+			cap->m_startPicoseconds = static_cast<int64_t>( (tstart - tsec) * 1e12 );
+
+			//Read the actual waveform data straight into the capture
 			size_t wavesize = ReadWaveHeader(header);
-			uint8_t *data = new uint8_t[wavesize];
-			m_transport->ReadRawData(wavesize, data);
+			ReadRawBlock<uint8_t>(cap, wavesize);
+			LogDebug("Got %zu samples\n", wavesize);
+
 			// two \n...
-			m_transport->ReadReply();
-			m_transport->ReadReply();
-
-			double trigtime = 0;
-			if( (num_sequences > 1) && (j > 0) )
-			{
-				//If a multi-segment capture, ask for the trigger time data
-				cmd = "C1:WF? TIME";
-				cmd[1] += i;
-				m_transport->SendCommand(cmd);
-
-				trigtime = ReadWaveHeader(header);
-				// \n
-				m_transport->ReadReply();
-				//double trigoff = ptrigtime[1];	//offset to point 0 from trigger time
-			}
-
-			int64_t trigtime_samples = trigtime * 1e12f / interval;
-			//int64_t trigoff_samples = trigoff * 1e12f / interval;
-			//LogDebug("    Trigger time: %.3f sec (%lu samples)\n", trigtime, trigtime_samples);
-			//LogDebug("    Trigger offset: %.3f sec (%lu samples)\n", trigoff, trigoff_samples);
-
-			//If we have samples already in the capture, stretch the final one to our trigger offset
-			if(cap->m_samples.size())
-			{
-				auto& last_sample = cap->m_samples[cap->m_samples.size()-1];
-				last_sample.m_duration = trigtime_samples - last_sample.m_offset;
-			}
-
-			//Decode the samples
-			unsigned int num_samples = wavesize;
-			LogDebug("Got %u samples\n", num_samples);
-			for(unsigned int i=0; i<num_samples; i++)
-				cap->m_samples.push_back(AnalogSample(i + trigtime_samples, 1, data[i] * v_gain - v_off));
+			unsigned char trailer[2];
+			m_transport->ReadRawData(2, trailer);
+
+			if( (i == lastEnabledChannel) && (j+1 < num_sequences) )
+				RequestSegment(j+1, num_sequences, firstEnabledChannel);
+
+			ExpandAnalogBlock<uint8_t>(cap, wavesize, v_gain, -v_off);
+
+			//Done, update the data
+			if(j == 0 && !toQueue)
+				m_channels[i]->SetData(cap);
+			else
+				pending_waveforms[i].push_back(cap);
 		}
+	}
 
-		//Done, update the data
-		m_channels[i]->SetData(cap);
+	//Now that we have all of the pending waveforms, save them in sets across all channels
+	m_pendingWaveformsMutex.lock();
+	size_t num_pending = num_sequences-1;
+	if(toQueue)				//if saving to queue, the 0'th segment counts too
+		num_pending ++;
+	for(size_t i=0; i<num_pending; i++)
+	{
+		SequenceSet s;
+		for(size_t j=0; j<m_channels.size(); j++)
+		{
+			if(pending_waveforms.find(j) != pending_waveforms.end())
+				s[m_channels[j]] = pending_waveforms[j][i];
+		}
+		m_pendingWaveforms.push_back(s);
 	}
+	m_pendingWaveformsMutex.unlock();
 
 	double dt = GetTime() - start;
 	LogTrace("Waveform download took %.3f ms\n", dt * 1000);
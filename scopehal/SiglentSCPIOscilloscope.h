@@ -56,6 +56,7 @@ protected:
 
 	void ReadWaveDescriptorBlock(SiglentWaveformDesc_t *descriptor, unsigned int channel);
 	uint32_t ReadWaveHeader(char *header);
+	void RequestSegment(unsigned int segment, unsigned int num_sequences, unsigned int channel);
 
 public:
 	static std::string GetDriverNameInternal();
@@ -195,10 +195,15 @@ string VICPSocketTransport::ReadReply()
 
 void VICPSocketTransport::SendRawData(size_t len, const unsigned char* buf)
 {
-	m_socket.SendLooped(buf, len);
+	//Each command is a complete VICP frame, so a batch is just the frames back to back
+	if(m_batchDepth)
+		m_batchBuffer.append((const char*)buf, len);
+	else
+		m_socket.SendLooped(buf, len);
 }
 
 void VICPSocketTransport::ReadRawData(size_t len, unsigned char* buf)
 {
+	FlushBatch();
 	m_socket.RecvLooped(buf, len);
 }
@@ -52,11 +52,14 @@
 #include "Unit.h"
 #include "Bijection.h"
 #include "IDTable.h"
+#include "FairMutex.h"
+#include "Profiler.h"
 
 #include "SCPITransport.h"
 #include "SCPISocketTransport.h"
 #include "VICPSocketTransport.h"
 #include "SCPIDevice.h"
+#include "CapabilityCache.h"
 
 #include "Instrument.h"
 #include "FunctionGenerator.h"
@@ -64,9 +67,12 @@
 #include "OscilloscopeChannel.h"
 #include "Oscilloscope.h"
 #include "SCPIOscilloscope.h"
+#include "AcquisitionGroup.h"
+#include "SessionLoader.h"
 #include "PowerSupply.h"
 
 #include "Measurement.h"
+#include "EdgeDetector.h"
 
 uint64_t ConvertVectorSignalToScalar(std::vector<bool> bits);
 
@@ -76,7 +76,7 @@ bool AvgVoltageMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chann
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool AvgVoltageMeasurement::Refresh()
+bool AvgVoltageMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
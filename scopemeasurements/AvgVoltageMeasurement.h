@@ -43,7 +43,7 @@ public:
 	AvgVoltageMeasurement();
 	virtual ~AvgVoltageMeasurement();
 
-	virtual bool Refresh();
+	virtual bool DoRefresh();
 
 	static std::string GetMeasurementName();
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
@@ -76,7 +76,7 @@ bool BaseMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channel)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool BaseMeasurement::Refresh()
+bool BaseMeasurement::DoRefresh()
 {
 	m_value = FLT_MAX;
 
@@ -77,7 +77,7 @@ bool EyeBitRateMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chann
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool EyeBitRateMeasurement::Refresh()
+bool EyeBitRateMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -77,7 +77,7 @@ bool EyeHeightMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channe
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool EyeHeightMeasurement::Refresh()
+bool EyeHeightMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -77,7 +77,7 @@ bool EyeJitterMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channe
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool EyeJitterMeasurement::Refresh()
+bool EyeJitterMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -77,7 +77,7 @@ bool EyePeriodMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channe
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool EyePeriodMeasurement::Refresh()
+bool EyePeriodMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
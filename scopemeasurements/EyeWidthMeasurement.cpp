@@ -77,7 +77,7 @@ bool EyeWidthMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool EyeWidthMeasurement::Refresh()
+bool EyeWidthMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
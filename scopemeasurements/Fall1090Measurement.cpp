@@ -76,7 +76,7 @@ bool Fall1090Measurement::ValidateChannel(size_t i, OscilloscopeChannel* channel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool Fall1090Measurement::Refresh()
+bool Fall1090Measurement::DoRefresh()
 {
 	m_value = 0;
 
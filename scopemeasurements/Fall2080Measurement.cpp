@@ -76,7 +76,7 @@ bool Fall2080Measurement::ValidateChannel(size_t i, OscilloscopeChannel* channel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool Fall2080Measurement::Refresh()
+bool Fall2080Measurement::DoRefresh()
 {
 	m_value = 0;
 
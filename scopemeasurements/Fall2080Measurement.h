@@ -43,7 +43,7 @@ public:
 	Fall2080Measurement();
 	virtual ~Fall2080Measurement();
 
-	virtual bool Refresh();
+	virtual bool DoRefresh();
 
 	static std::string GetMeasurementName();
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
@@ -76,7 +76,7 @@ bool FrequencyMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channe
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool FrequencyMeasurement::Refresh()
+bool FrequencyMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -76,7 +76,7 @@ bool MaxVoltageMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chann
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool MaxVoltageMeasurement::Refresh()
+bool MaxVoltageMeasurement::DoRefresh()
 {
 	m_value = FLT_MIN;
 
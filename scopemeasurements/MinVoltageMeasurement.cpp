@@ -76,7 +76,7 @@ bool MinVoltageMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chann
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool MinVoltageMeasurement::Refresh()
+bool MinVoltageMeasurement::DoRefresh()
 {
 	m_value = FLT_MAX;
 
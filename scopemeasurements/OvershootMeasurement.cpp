@@ -76,7 +76,7 @@ bool OvershootMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channe
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool OvershootMeasurement::Refresh()
+bool OvershootMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -76,7 +76,7 @@ bool PeriodMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channel)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool PeriodMeasurement::Refresh()
+bool PeriodMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -76,7 +76,7 @@ bool PkPkVoltageMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chan
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool PkPkVoltageMeasurement::Refresh()
+bool PkPkVoltageMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
@@ -76,7 +76,7 @@ bool Rise1090Measurement::ValidateChannel(size_t i, OscilloscopeChannel* channel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool Rise1090Measurement::Refresh()
+bool Rise1090Measurement::DoRefresh()
 {
 	m_value = 0;
 
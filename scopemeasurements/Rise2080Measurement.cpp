@@ -76,7 +76,7 @@ bool Rise2080Measurement::ValidateChannel(size_t i, OscilloscopeChannel* channel
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool Rise2080Measurement::Refresh()
+bool Rise2080Measurement::DoRefresh()
 {
 	m_value = 0;
 
@@ -43,7 +43,7 @@ public:
 	Rise2080Measurement();
 	virtual ~Rise2080Measurement();
 
-	virtual bool Refresh();
+	virtual bool DoRefresh();
 
 	static std::string GetMeasurementName();
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
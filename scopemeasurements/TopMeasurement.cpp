@@ -76,7 +76,7 @@ bool TopMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* channel)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool TopMeasurement::Refresh()
+bool TopMeasurement::DoRefresh()
 {
 	m_value = FLT_MAX;
 
@@ -76,7 +76,7 @@ bool UndershootMeasurement::ValidateChannel(size_t i, OscilloscopeChannel* chann
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Measurement processing
 
-bool UndershootMeasurement::Refresh()
+bool UndershootMeasurement::DoRefresh()
 {
 	//Get the input data
 	if(m_channels[0] == NULL)
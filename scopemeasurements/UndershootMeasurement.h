@@ -43,7 +43,7 @@ public:
 	UndershootMeasurement();
 	virtual ~UndershootMeasurement();
 
-	virtual bool Refresh();
+	virtual bool DoRefresh();
 
 	static std::string GetMeasurementName();
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
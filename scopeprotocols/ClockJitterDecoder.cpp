@@ -134,8 +134,8 @@ void ClockJitterDecoder::Refresh()
 	AnalogCapture* cap = new AnalogCapture;
 
 	//Timestamps of the edges
-	vector<int64_t> edges;
-	FindZeroCrossings(clk, 0, edges);
+	EdgeListPtr pedges = EdgeDetector::FindZeroCrossings(clk, 0);
+	auto& edges = *pedges;
 
 	m_maxTie = 1;
 
@@ -59,6 +59,11 @@ ClockRecoveryDecoder::ClockRecoveryDecoder(string color)
 	m_nominalPeriod = 0;
 }
 
+ClockRecoveryDecoder::~ClockRecoveryDecoder()
+{
+	delete m_phaseErrorCapture;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factory methods
 
@@ -104,6 +109,18 @@ bool ClockRecoveryDecoder::IsOverlay()
 	return true;
 }
 
+bool ClockRecoveryDecoder::UsesResultCache()
+{
+	return true;
+}
+
+void ClockRecoveryDecoder::OnResultCacheHit()
+{
+	//The phase error debug capture isn't cached, only the recovered clock
+	int64_t baud = m_parameters[m_baudname].GetIntVal();
+	m_nominalPeriod = static_cast<int64_t>(1.0e12f / baud);
+}
+
 bool ClockRecoveryDecoder::NeedsConfig()
 {
 	//we have need the base symbol rate configured
@@ -135,104 +152,236 @@ void ClockRecoveryDecoder::Refresh()
 		return;
 	}
 
-	DigitalCapture* gate = NULL;
-	if(m_channels[1] != NULL)
-		gate = dynamic_cast<DigitalCapture*>(m_channels[1]->GetData());
+	RefreshStreaming();
+}
+
+bool ClockRecoveryDecoder::SupportsStreaming()
+{
+	return true;
+}
+
+void ClockRecoveryDecoder::Begin()
+{
+	ProtocolDecoder::Begin();
 
 	//Look up the nominal baud rate and convert to time
 	int64_t baud = m_parameters[m_baudname].GetIntVal();
-	int64_t ps = static_cast<int64_t>(1.0e12f / baud);
-	m_nominalPeriod = ps;
-
-	//Create the output waveform and copy our timescales
-	DigitalCapture* cap = new DigitalCapture;
-	cap->m_startTimestamp = din->m_startTimestamp;
-	cap->m_startPicoseconds = din->m_startPicoseconds;
-	cap->m_triggerPhase = 0;
-	cap->m_timescale = 1;		//recovered clock time scale is single picoseconds
-
-	//Create debug capture
-	if(m_phaseErrorCapture != NULL)
-		m_phaseErrorCapture = NULL;
-	m_phaseErrorCapture = new AnalogCapture;
-	m_phaseErrorCapture->m_startTimestamp = din->m_startTimestamp;
-	m_phaseErrorCapture->m_startPicoseconds = din->m_startPicoseconds;
-	m_phaseErrorCapture->m_triggerPhase = 0;
-	m_phaseErrorCapture->m_timescale = 1;
-
-	double start = GetTime();
-
-	//Timestamps of the edges
-	vector<int64_t> edges;
-	FindZeroCrossings(din, m_parameters[m_threshname].GetFloatVal(), edges);
+	m_nominalPeriod = static_cast<int64_t>(1.0e12f / baud);
 
-	if(edges.empty())
+	//Discard the debug capture if nobody picked it up
+	delete m_phaseErrorCapture;
+	m_phaseErrorCapture = NULL;
+
+	auto& st = m_stream;
+	st.m_threshold = m_parameters[m_threshname].GetFloatVal();
+	st.m_timescale = 1;
+	st.m_tend = 0;
+	st.m_samplesSeen = 0;
+	st.m_lastValue = false;
+	st.m_lastVoltage = 0;
+	st.m_edges.clear();
+	st.m_edgeCount = 0;
+	st.m_gate.clear();
+	st.m_locked = false;
+	st.m_edgepos = 0;
+	st.m_period = m_nominalPeriod;
+	st.m_value = false;
+	st.m_gating = false;
+	st.m_cyclesOpenLoop = 0;
+	st.m_totalError = 0;
+}
+
+void ClockRecoveryDecoder::Push(const vector<CaptureChannelBase*>& chunk)
+{
+	if(chunk.empty())
+		return;
+	AnalogCapture* din = dynamic_cast<AnalogCapture*>(chunk[0]);
+	if( (din == NULL) || din->m_samples.empty() )
+		return;
+	DigitalCapture* gate = NULL;
+	if(chunk.size() > 1)
+		gate = dynamic_cast<DigitalCapture*>(chunk[1]);
+
+	auto& st = m_stream;
+	st.m_timescale = din->m_timescale;
+
+	//Append to the current output, if any
+	DigitalCapture* cap = dynamic_cast<DigitalCapture*>(GetData());
+	if(cap == NULL)
+	{
+		cap = new DigitalCapture;
+		cap->m_startTimestamp = din->m_startTimestamp;
+		cap->m_startPicoseconds = din->m_startPicoseconds;
+		cap->m_triggerPhase = 0;
+		cap->m_timescale = 1;		//recovered clock time scale is single picoseconds
+	}
+
+	//If this is the start of the stream (always the case for a normal refresh), use the capture's shared edge list.
+	//The first sample is ignored and the second is the initial state.
+	size_t len = din->m_samples.size();
+	size_t istart = 0;
+	if( (st.m_samplesSeen == 0) && (len >= 2) )
+	{
+		auto pedges = EdgeDetector::FindZeroCrossings(din, st.m_threshold);
+		st.m_edges.insert(st.m_edges.end(), pedges->begin(), pedges->end());
+		st.m_edgeCount += pedges->size();
+
+		float v = din->m_samples[len-1];
+		st.m_samplesSeen = len;
+		st.m_lastValue = v > st.m_threshold;
+		st.m_lastVoltage = v;
+		istart = len;
+	}
+
+	//Otherwise find interpolated zero crossings as the samples come in
+	for(size_t i=istart; i<len; i++)
+	{
+		auto& sin = din->m_samples[i];
+		float v = sin;
+		bool value = v > st.m_threshold;
+
+		if(st.m_samplesSeen < 2)
+		{
+			st.m_samplesSeen ++;
+			st.m_lastValue = value;
+			st.m_lastVoltage = v;
+			continue;
+		}
+
+		if(value != st.m_lastValue)
+		{
+			//Start time of the sample, in picoseconds, moved to the middle of the sample
+			int64_t t = din->m_triggerPhase + din->m_timescale * sin.m_offset;
+			t += din->m_timescale/2;
+
+			//Interpolate the time (sample spacing is normalized to 1 timebase unit)
+			float frac = (st.m_threshold - st.m_lastVoltage) / (v - st.m_lastVoltage);
+			t += din->m_timescale * frac;
+
+			st.m_edges.push_back(t);
+			st.m_edgeCount ++;
+		}
+
+		st.m_lastValue = value;
+		st.m_lastVoltage = v;
+	}
+
+	//Queue up gating regions
+	if(gate != NULL)
+	{
+		for(auto& g : gate->m_samples)
+		{
+			st.m_gate.push_back(DigitalSample(
+				g.m_offset * gate->m_timescale,
+				g.m_duration * gate->m_timescale,
+				g.m_sample));
+		}
+	}
+
+	st.m_tend = din->m_samples[din->m_samples.size() - 1].m_offset * din->m_timescale;
+
+	RunNCO(cap, false);
+	SetData(cap);
+}
+
+void ClockRecoveryDecoder::Flush()
+{
+	auto& st = m_stream;
+	DigitalCapture* cap = dynamic_cast<DigitalCapture*>(GetData());
+	if( (cap == NULL) || (st.m_edgeCount == 0) )
 	{
 		SetData(NULL);
 		return;
 	}
 
-	double dt = GetTime() - start;
-	start = GetTime();
-	//LogTrace("Zero crossing: %.3f ms\n", dt * 1000);
+	RunNCO(cap, true);
+
+	LogTrace("average phase error %.1f\n", st.m_totalError / st.m_edgeCount);
+
+	SetData(cap);
+}
+
+/**
+	@brief Runs the NCO over as many of the pending edges as possible
+
+	@param cap		Output waveform
+	@param flush	True at the end of the stream. If false, we stop early rather than let the NCO act on an edge
+					whose successor hasn't arrived yet, so the result is the same no matter how the input is chunked.
+ */
+void ClockRecoveryDecoder::RunNCO(DigitalCapture* cap, bool flush)
+{
+	auto& st = m_stream;
+	auto& edges = st.m_edges;
+	if(edges.empty())
+		return;
+
+	//Start the NCO on the first edge
+	if(!st.m_locked)
+	{
+		st.m_edgepos = edges.front();
+		edges.pop_front();
+		st.m_locked = true;
+	}
+
+	if(m_phaseErrorCapture == NULL)
+	{
+		m_phaseErrorCapture = new AnalogCapture;
+		m_phaseErrorCapture->m_startTimestamp = cap->m_startTimestamp;
+		m_phaseErrorCapture->m_startPicoseconds = cap->m_startPicoseconds;
+		m_phaseErrorCapture->m_triggerPhase = 0;
+		m_phaseErrorCapture->m_timescale = 1;
+	}
 
 	//The actual PLL NCO
 	//TODO: use the real fibre channel PLL.
-	int64_t tend = din->m_samples[din->m_samples.size() - 1].m_offset * din->m_timescale;
-	float period = ps;
-	size_t nedge = 1;
-	//LogDebug("n,delta,period\n");
-	double edgepos = edges[0];
-	bool value = false;
-	double total_error = 0;
-	cap->m_samples.reserve(edges.size());
-	size_t igate = 0;
-	bool gating = false;
-	int cycles_open_loop = 0;
-	for(; (edgepos < tend) && (nedge < edges.size()-1); edgepos += period)
+	double& edgepos = st.m_edgepos;
+	float& period = st.m_period;
+	bool& gating = st.m_gating;
+	int& cycles_open_loop = st.m_cyclesOpenLoop;
+	for(; (edgepos < st.m_tend) && (edges.size() >= 2); edgepos += period)
 	{
 		float center = period/2;
 		double edgepos_orig = edgepos;
 
+		//Wait for more edges if the ones we have might not cover this UI
+		if(!flush && (edges.back() + center < edgepos) )
+			break;
+
 		//See if the current edge position is within a gating region
 		bool was_gating = gating;
-		if(gate != NULL)
+		while(!st.m_gate.empty())
 		{
-			while(igate < edges.size()-1)
+			//See if this edge is within the region
+			auto& g = st.m_gate.front();
+			int64_t a = g.m_offset;
+			int64_t b = a + g.m_duration;
+
+			//We went too far, stop
+			if(edgepos < a)
+				break;
+
+			//Keep looking
+			else if(edgepos > b)
+				st.m_gate.pop_front();
+
+			//Good alignment
+			else
 			{
-				//See if this edge is within the region
-				int64_t a = gate->m_samples[igate].m_offset;
-				int64_t b = a + gate->m_samples[igate].m_duration;
-				a *= gate->m_timescale;
-				b *= gate->m_timescale;
-
-				//We went too far, stop
-				if(edgepos < a)
-					break;
-
-				//Keep looking
-				else if(edgepos > b)
-					igate ++;
-
-				//Good alignment
-				else
-				{
-					gating = !gate->m_samples[igate].m_sample;
-					break;
-				}
+				gating = !g.m_sample;
+				break;
 			}
 		}
 
 		//See if the next edge occurred in this UI.
 		//If not, just run the NCO open loop.
 		//Allow multiple edges in the UI if the frequency is way off.
-		int64_t tnext = edges[nedge];
+		int64_t tnext = edges.front();
 		cycles_open_loop ++;
-		while( (tnext + center < edgepos) && (nedge+1 < edges.size()) )
+		while( (tnext + center < edgepos) && (edges.size() >= 2) )
 		{
 			//Find phase error
 			int64_t delta = (edgepos - tnext) - period;
-			total_error += fabs(delta);
+			st.m_totalError += fabs(delta);
 
 			//Extend the previous debug sample to now
 			if(!m_phaseErrorCapture->m_samples.empty())
@@ -267,26 +416,17 @@ void ClockRecoveryDecoder::Refresh()
 
 			cycles_open_loop = 0;
 
-			//LogDebug("%ld,%ld,%.2f\n", nedge, delta, period);
-			tnext = edges[++nedge];
+			edges.pop_front();
+			tnext = edges.front();
 		}
 
 		//Add the sample
 		if(!gating)
 		{
-			value = !value;
+			st.m_value = !st.m_value;
 			cap->m_samples.push_back(DigitalSample(
-				static_cast<int64_t>(round(edgepos_orig + period/2 - din->m_timescale*1.5)),
-				(int64_t)period, value));
+				static_cast<int64_t>(round(edgepos_orig + period/2 - st.m_timescale*1.5)),
+				(int64_t)period, st.m_value));
 		}
 	}
-
-	dt = GetTime() - start;
-	start = GetTime();
-	LogTrace("NCO: %.3f ms\n", dt * 1000);
-
-	total_error /= edges.size();
-	LogTrace("average phase error %.1f\n", total_error);
-
-	SetData(cap);
 }
@@ -36,11 +36,13 @@
 #define ClockRecoveryDecoder_h
 
 #include "../scopehal/ProtocolDecoder.h"
+#include <deque>
 
 class ClockRecoveryDecoder : public ProtocolDecoder
 {
 public:
 	ClockRecoveryDecoder(std::string color);
+	virtual ~ClockRecoveryDecoder();
 
 	virtual void Refresh();
 	virtual ChannelRenderer* CreateRenderer();
@@ -55,6 +57,11 @@ public:
 
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
+	virtual bool SupportsStreaming();
+	virtual void Begin();
+	virtual void Push(const std::vector<CaptureChannelBase*>& chunk);
+	virtual void Flush();
+
 	PROTOCOL_DECODER_INITPROC(ClockRecoveryDecoder)
 
 	//Debug
@@ -62,8 +69,49 @@ public:
 	int64_t m_nominalPeriod;
 
 protected:
+	virtual bool UsesResultCache();
+	virtual void OnResultCacheHit();
+
 	std::string m_baudname;
 	std::string m_threshname;
+
+	void RunNCO(DigitalCapture* cap, bool flush);
+
+	/**
+		@brief PLL state carried between chunks of a stream
+	 */
+	class StreamState
+	{
+	public:
+		float m_threshold;
+
+		///Input timebase
+		int64_t m_timescale;
+
+		///Time of the last input sample seen, in picoseconds
+		int64_t m_tend;
+
+		//Zero crossing detector
+		size_t m_samplesSeen;
+		bool m_lastValue;
+		float m_lastVoltage;
+
+		///Edges not yet consumed by the NCO (front is the next one)
+		std::deque<int64_t> m_edges;
+		size_t m_edgeCount;
+
+		///Gate samples not yet passed by the NCO (offsets in picoseconds)
+		std::deque<DigitalSample> m_gate;
+
+		//NCO
+		bool m_locked;
+		double m_edgepos;
+		float m_period;
+		bool m_value;
+		bool m_gating;
+		int m_cyclesOpenLoop;
+		double m_totalError;
+	} m_stream;
 };
 
 #endif
@@ -126,20 +126,11 @@ void DDR3Decoder::Refresh()
 		caps[i] = cap;
 	}
 
-	//Sample all of the inputs
+	//Sample all of the inputs on the same clock edges.
+	//Bits 0-5 are WE, RAS, CAS, CS, A12, A10.
 	DigitalCapture* cclk = caps[0];
-	vector<DigitalSample> we;
-	vector<DigitalSample> ras;
-	vector<DigitalSample> cas;
-	vector<DigitalSample> cs;
-	vector<DigitalSample> a12;
-	vector<DigitalSample> a10;
-	SampleOnRisingEdges(caps[1], cclk, we);
-	SampleOnRisingEdges(caps[2], cclk, ras);
-	SampleOnRisingEdges(caps[3], cclk, cas);
-	SampleOnRisingEdges(caps[4], cclk, cs);
-	SampleOnRisingEdges(caps[5], cclk, a12);
-	SampleOnRisingEdges(caps[6], cclk, a10);
+	MultiLaneSamples samples;
+	SampleOnEdges<EDGE_RISING>({caps[1], caps[2], caps[3], caps[4], caps[5], caps[6]}, cclk, samples);
 
 	//Create the capture
 	DDR3Capture* cap = new DDR3Capture;
@@ -148,24 +139,15 @@ void DDR3Decoder::Refresh()
 	cap->m_startPicoseconds = 0;
 
 	//Loop over the data and look for events on clock edges
-	for(size_t i=0; i<we.size(); i++)
+	for(size_t i=0; i<samples.size(); i++)
 	{
-		//Abort if one of the other waveforms ends earlier
-		if( (i >= ras.size()) ||
-			(i >= cas.size()) ||
-			(i >= cs.size()) ||
-			(i >= a12.size()) ||
-			(i >= a10.size()) )
-		{
-			break;
-		}
-
-		bool swe = we[i];
-		bool sras = ras[i];
-		bool scas = cas[i];
-		bool scs = cs[i];
-		bool sa12 = a12[i];
-		bool sa10 = a10[i];
+		uint64_t word = samples.m_words[i];
+		bool swe = (word & 0x01) != 0;
+		bool sras = (word & 0x02) != 0;
+		bool scas = (word & 0x04) != 0;
+		bool scs = (word & 0x08) != 0;
+		bool sa12 = (word & 0x10) != 0;
+		bool sa10 = (word & 0x20) != 0;
 
 		if(!scs)
 		{
@@ -207,8 +189,8 @@ void DDR3Decoder::Refresh()
 
 			//Create the symbol
 			cap->m_samples.push_back(DDR3Sample(
-				we[i].m_offset,
-				we[i].m_duration,
+				samples.m_offsets[i],
+				samples.m_durations[i],
 				sym));
 		}
 	}
@@ -42,12 +42,6 @@
 
 using namespace std;
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-VideoScanlinePacket::~VideoScanlinePacket()
-{
-}
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
@@ -151,7 +145,7 @@ void DVIDecoder::Refresh()
 
 	TMDSSymbol::TMDSType last_type = TMDSSymbol::TMDS_TYPE_ERROR;
 
-	VideoScanlinePacket* current_packet = NULL;
+	//Scanline packets carry RGB pixels as payload
 	int current_pixels = 0;
 
 	//Decode the actual data
@@ -163,16 +157,11 @@ void DVIDecoder::Refresh()
 		if(sblue.m_sample.m_type == TMDSSymbol::TMDS_TYPE_CONTROL)
 		{
 			//If the last sample was data, save the packet for the scanline or data island
-			if( (last_type == TMDSSymbol::TMDS_TYPE_DATA) && (current_packet != NULL) )
+			if( (last_type == TMDSSymbol::TMDS_TYPE_DATA) && m_packets.IsPacketOpen() )
 			{
-				current_packet->m_len = sblue.m_offset + sblue.m_duration - current_packet->m_offset;
-				char tmp[32];
-				snprintf(tmp, sizeof(tmp), "%d", current_pixels);
-				current_packet->m_headers["Width"] = tmp;
-				m_packets.push_back(current_packet);
-
+				m_packets.SetInt(COL_WIDTH, current_pixels);
+				m_packets.EndPacket(sblue.m_offset + sblue.m_duration - m_packets.GetOffset(m_packets.size()));
 				current_pixels = 0;
-				current_packet = NULL;
 			}
 
 			//Extract synchronization signals from blue channel
@@ -190,10 +179,9 @@ void DVIDecoder::Refresh()
 
 			else if(vsync)
 			{
-				auto pack = new Packet;
-				pack->m_offset = sblue.m_offset;
-				pack->m_headers["Type"] = "VSYNC";
-				m_packets.push_back(pack);
+				m_packets.BeginPacket(sblue.m_offset);
+				m_packets.SetEnum(COL_TYPE, "VSYNC");
+				m_packets.EndPacket(sblue.m_duration);
 
 				cap->m_samples.push_back(DVISample(
 					sblue.m_offset, sblue.m_duration,
@@ -259,9 +247,8 @@ void DVIDecoder::Refresh()
 				}
 
 				//Start a new packet
-				current_packet = new VideoScanlinePacket;
-				current_packet->m_offset = sblue.m_offset;
-				current_packet->m_headers["Type"] = "Video";
+				m_packets.BeginPacket(sblue.m_offset);
+				m_packets.SetEnum(COL_TYPE, "Video");
 				current_pixels = 0;
 			}
 
@@ -277,11 +264,11 @@ void DVIDecoder::Refresh()
 
 			//In-memory packet data is RGB order for compatibility with Gdk::Pixbuf
 			//may be null if waveform starts halfway through a scan line. Don't make a packet for that.
-			if(current_packet != NULL)
+			if(m_packets.IsPacketOpen())
 			{
-				current_packet->m_data.push_back(sred.m_sample.m_data);
-				current_packet->m_data.push_back(sgreen.m_sample.m_data);
-				current_packet->m_data.push_back(sblue.m_sample.m_data);
+				m_packets.AppendPayload(sred.m_sample.m_data);
+				m_packets.AppendPayload(sgreen.m_sample.m_data);
+				m_packets.AppendPayload(sblue.m_sample.m_data);
 				current_pixels ++;
 			}
 		}
@@ -295,8 +282,8 @@ void DVIDecoder::Refresh()
 		ired ++;
 	}
 
-	if(current_packet)
-		delete current_packet;
+	//Discard the last scanline if the capture ended partway through it
+	m_packets.AbortPacket();
 
 	SetData(cap);
 }
@@ -68,12 +68,6 @@ public:
 	}
 };
 
-class VideoScanlinePacket : public Packet
-{
-public:
-	virtual ~VideoScanlinePacket();
-};
-
 typedef OscilloscopeSample<DVISymbol> DVISample;
 typedef CaptureChannel<DVISymbol> DVICapture;
 
@@ -98,6 +92,12 @@ public:
 	PROTOCOL_DECODER_INITPROC(DVIDecoder)
 
 protected:
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_TYPE,
+		COL_WIDTH
+	};
 };
 
 #endif
@@ -117,52 +117,167 @@ void EthernetGMIIDecoder::Refresh()
 		return;
 	}
 
-	//Sample everything on the clock edges
-	vector<DigitalSample> den;
-	vector<DigitalSample> der;
-	vector<DigitalBusSample> ddata;
-	SampleOnRisingEdges(en, clk, den);
-	SampleOnRisingEdges(er, clk, der);
-	SampleOnRisingEdges(data, clk, ddata);
-
-	//Create the output capture
-	EthernetCapture* cap = new EthernetCapture;
-	cap->m_timescale = 1;
-	cap->m_startTimestamp = data->m_startTimestamp;
-	cap->m_startPicoseconds = data->m_startPicoseconds;
-
-	for(size_t i=0; i<den.size(); i++)
+	//If we only need part of the capture, decode from the interframe gap before the window
+	//through the end of the frame in progress at the end of it
+	int64_t tstart;
+	int64_t tend;
+	if(GetDecodeWindow(tstart, tend) && !en->m_samples.empty())
 	{
-		bool cur_en = den[i].m_sample;
-		if(!cur_en)
-			continue;
+		size_t istart = FindSampleAtTime(en, tstart);
+		while( (istart > 0) && en->m_samples[istart].m_sample)
+			istart --;
+		size_t iend = FindSampleAtTime(en, tend);
+		while( (iend+1 < en->m_samples.size()) && en->m_samples[iend].m_sample)
+			iend ++;
 
-		//Set of recovered bytes and timestamps
-		vector<uint8_t> bytes;
-		vector<uint64_t> starts;
-		vector<uint64_t> ends;
+		auto& first = en->m_samples[istart];
+		auto& last = en->m_samples[iend];
+		int64_t t0 = first.m_offset * en->m_timescale;
+		int64_t t1 = (last.m_offset + last.m_duration) * en->m_timescale;
 
-		//TODO: handle error signal (ignored for now)
+		vector<CaptureChannelBase*> chunk;
+		chunk.push_back(SliceCapture(data, t0, t1));
+		chunk.push_back(SliceCapture(clk, t0, t1));
+		chunk.push_back(SliceCapture(en, t0, t1));
+		chunk.push_back(SliceCapture(er, t0, t1));
 
-		while( (i < den.size()) && (den[i].m_sample) )
+		Begin();
+		Push(chunk);
+		Flush();
+
+		for(auto c : chunk)
+			delete c;
+		return;
+	}
+
+	RefreshStreaming();
+}
+
+bool EthernetGMIIDecoder::SupportsTimeWindow()
+{
+	return true;
+}
+
+bool EthernetGMIIDecoder::SupportsStreaming()
+{
+	return true;
+}
+
+void EthernetGMIIDecoder::Begin()
+{
+	ProtocolDecoder::Begin();
+	ClearPackets();
+
+	m_frame.m_bytes.clear();
+	m_frame.m_starts.clear();
+	m_frame.m_ends.clear();
+
+	m_stream.m_haveClock = false;
+	m_stream.m_lastClock = false;
+	m_stream.m_edges.clear();
+	m_stream.m_haveBeat = false;
+}
+
+void EthernetGMIIDecoder::Push(const vector<CaptureChannelBase*>& chunk)
+{
+	if(chunk.size() < 4)
+		return;
+	DigitalBusCapture* data = dynamic_cast<DigitalBusCapture*>(chunk[0]);
+	DigitalCapture* clk = dynamic_cast<DigitalCapture*>(chunk[1]);
+	DigitalCapture* en = dynamic_cast<DigitalCapture*>(chunk[2]);
+	DigitalCapture* er = dynamic_cast<DigitalCapture*>(chunk[3]);
+	if( (data == NULL) || (clk == NULL) || (en == NULL) || (er == NULL) )
+		return;
+
+	auto& st = m_stream;
+
+	//Append to the current output, if any
+	EthernetCapture* cap = dynamic_cast<EthernetCapture*>(GetData());
+	if(cap == NULL)
+	{
+		cap = new EthernetCapture;
+		cap->m_timescale = 1;
+		cap->m_startTimestamp = data->m_startTimestamp;
+		cap->m_startPicoseconds = data->m_startPicoseconds;
+	}
+
+	//Find rising clock edges, including one right at the start of this chunk
+	for(auto& csample : clk->m_samples)
+	{
+		if(st.m_haveClock && csample.m_sample && !st.m_lastClock)
+			st.m_edges.push_back(csample.m_offset * clk->m_timescale);
+		st.m_lastClock = csample.m_sample;
+		st.m_haveClock = true;
+	}
+
+	//Sample everything on the clock edges.
+	//Edges with no data after them in this chunk wait for the next one.
+	//TODO: handle error signal (ignored for now)
+	size_t ndata = 0;
+	size_t nen = 0;
+	while(!st.m_edges.empty())
+	{
+		//Throw away data samples until the data is synced with us
+		int64_t clkstart = st.m_edges.front();
+		while( (ndata < data->m_samples.size()) && (data->m_samples[ndata].m_offset * data->m_timescale < clkstart) )
+			ndata ++;
+		while( (nen < en->m_samples.size()) && (en->m_samples[nen].m_offset * en->m_timescale < clkstart) )
+			nen ++;
+		if( (ndata >= data->m_samples.size()) || (nen >= en->m_samples.size()) )
+			break;
+		st.m_edges.pop_front();
+
+		//The previous cycle ends where this one starts
+		if(st.m_haveBeat)
+			ProcessBeat(cap, clkstart);
+
+		//Convert bits to bytes
+		uint8_t dval = 0;
+		auto& dsample = data->m_samples[ndata].m_sample;
+		for(size_t j=0; j<8; j++)
 		{
-			//Convert bits to bytes
-			uint8_t dval = 0;
-			for(size_t j=0; j<8; j++)
-			{
-				if(ddata[i].m_sample[j])
-					dval |= (1 << j);
-			}
-
-			bytes.push_back(dval);
-			starts.push_back(ddata[i].m_offset);
-			ends.push_back(ddata[i].m_offset + ddata[i].m_duration);
-			i++;
+			if(dsample[j])
+				dval |= (1 << j);
 		}
 
-		//Crunch the data
-		BytesToFrames(bytes, starts, ends, cap);
+		st.m_haveBeat = true;
+		st.m_beatTime = clkstart;
+		st.m_beatEnable = en->m_samples[nen].m_sample;
+		st.m_beatData = dval;
+	}
+
+	SetData(cap);
+}
+
+void EthernetGMIIDecoder::Flush()
+{
+	EthernetCapture* cap = dynamic_cast<EthernetCapture*>(GetData());
+	if(cap == NULL)
+	{
+		cap = new EthernetCapture;
+		cap->m_timescale = 1;
+	}
+
+	//Last cycle has no following edge, give it unit length
+	if(m_stream.m_haveBeat)
+	{
+		ProcessBeat(cap, m_stream.m_beatTime + 1);
+		m_stream.m_haveBeat = false;
 	}
 
+	//Crunch whatever is left
+	EndFrame(cap);
+
 	SetData(cap);
 }
+
+/**
+	@brief Adds the last sampled clock cycle to the current frame, or ends the frame if EN is low
+ */
+void EthernetGMIIDecoder::ProcessBeat(EthernetCapture* cap, int64_t end)
+{
+	if(m_stream.m_beatEnable)
+		AddFrameByte(m_stream.m_beatData, m_stream.m_beatTime, end);
+	else
+		EndFrame(cap);
+}
@@ -36,6 +36,7 @@
 #define EthernetGMIIDecoder_h
 
 #include "../scopehal/ProtocolDecoder.h"
+#include <deque>
 
 class EthernetGMIIDecoder : public EthernetProtocolDecoder
 {
@@ -48,7 +49,36 @@ public:
 
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
+	virtual bool SupportsTimeWindow();
+	virtual bool SupportsStreaming();
+	virtual void Begin();
+	virtual void Push(const std::vector<CaptureChannelBase*>& chunk);
+	virtual void Flush();
+
 	PROTOCOL_DECODER_INITPROC(EthernetGMIIDecoder)
+
+protected:
+	void ProcessBeat(EthernetCapture* cap, int64_t end);
+
+	/**
+		@brief Decoder state carried between chunks of a stream
+	 */
+	class StreamState
+	{
+	public:
+		///Clock state at the end of the previous chunk
+		bool m_haveClock;
+		bool m_lastClock;
+
+		///Rising clock edges (in picoseconds) still waiting for data samples
+		std::deque<int64_t> m_edges;
+
+		///The last clock cycle sampled. Not processed until the next edge, which gives its end time.
+		bool m_haveBeat;
+		int64_t m_beatTime;
+		bool m_beatEnable;
+		uint8_t m_beatData;
+	} m_stream;
 };
 
 #endif
@@ -79,17 +79,95 @@ vector<string> EthernetProtocolDecoder::GetHeaders()
 	return ret;
 }
 
+void EthernetProtocolDecoder::InitColumns()
+{
+	m_packets.SetIntFormat(COL_ETHERTYPE, "%04" PRIx64);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Export
+
+int EthernetProtocolDecoder::GetPcapLinkType()
+{
+	return PcapNGWriter::LINKTYPE_ETHERNET;
+}
+
+/**
+	@brief Writes each complete frame (destination MAC through end of payload, without FCS) as one pcapng record
+
+	Frames are reassembled from the segments in our output capture.
+ */
+void EthernetProtocolDecoder::WritePcap(PcapNGWriter& writer, int64_t tbase)
+{
+	auto cap = dynamic_cast<EthernetCapture*>(GetData());
+	if(cap == NULL)
+		return;
+
+	for(auto& s : cap->m_samples)
+	{
+		auto& seg = s.m_sample;
+		switch(seg.m_type)
+		{
+			//Timestamp is the start of the preamble, same as the packet table
+			case EthernetFrameSegment::TYPE_PREAMBLE:
+				writer.BeginPacket(tbase + s.m_offset * cap->m_timescale);
+				break;
+
+			case EthernetFrameSegment::TYPE_DST_MAC:
+			case EthernetFrameSegment::TYPE_SRC_MAC:
+			case EthernetFrameSegment::TYPE_ETHERTYPE:
+			case EthernetFrameSegment::TYPE_VLAN_TAG:
+			case EthernetFrameSegment::TYPE_PAYLOAD:
+				writer.Append(seg.m_data.data(), seg.m_data.size());
+				break;
+
+			case EthernetFrameSegment::TYPE_FCS:
+				writer.EndPacket();
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	//Drop a truncated frame at the end of the capture
+	writer.AbortPacket();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual protocol decoding
 
+/**
+	@brief Adds a byte to the frame currently being received
+ */
+void EthernetProtocolDecoder::AddFrameByte(uint8_t b, uint64_t start, uint64_t end)
+{
+	m_frame.m_bytes.push_back(b);
+	m_frame.m_starts.push_back(start);
+	m_frame.m_ends.push_back(end);
+}
+
+/**
+	@brief Decodes the frame currently being received (if any) and starts a new one
+ */
+void EthernetProtocolDecoder::EndFrame(EthernetCapture* cap)
+{
+	if(m_frame.m_bytes.empty())
+		return;
+
+	BytesToFrames(m_frame.m_bytes, m_frame.m_starts, m_frame.m_ends, cap);
+
+	m_frame.m_bytes.clear();
+	m_frame.m_starts.clear();
+	m_frame.m_ends.clear();
+}
+
 void EthernetProtocolDecoder::BytesToFrames(
 		vector<uint8_t>& bytes,
 		vector<uint64_t>& starts,
 		vector<uint64_t>& ends,
 		EthernetCapture* cap)
 {
-	Packet* pack = NULL;
-
 	EthernetFrameSegment garbage;
 	EthernetSample sample(-1, -1, garbage);	//ctor needs args even though we're gonna overwrite them
 	sample.m_sample.m_type = EthernetFrameSegment::TYPE_INVALID;
@@ -114,8 +192,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 					sample.m_sample.m_data.push_back(0x55);
 
 					//Start a new packet
-					pack = new Packet;
-					pack->m_offset = starts[i];
+					m_packets.BeginPacket(starts[i]);
 				}
 				break;
 
@@ -183,7 +260,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 						sample.m_sample.m_data[3],
 						sample.m_sample.m_data[4],
 						sample.m_sample.m_data[5]);
-					pack->m_headers["Dest MAC"] = tmp;
+					m_packets.SetString(COL_DST_MAC, tmp);
 				}
 
 				break;
@@ -216,7 +293,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 						sample.m_sample.m_data[3],
 						sample.m_sample.m_data[4],
 						sample.m_sample.m_data[5]);
-					pack->m_headers["Src MAC"] = tmp;
+					m_packets.SetString(COL_SRC_MAC, tmp);
 				}
 
 				break;
@@ -242,30 +319,26 @@ void EthernetProtocolDecoder::BytesToFrames(
 
 					//Format the content for display
 					uint16_t ethertype = (sample.m_sample.m_data[0] << 8) | sample.m_sample.m_data[1];
-					char tmp[64];
 					switch(ethertype)
 					{
 						case 0x0800:
-							pack->m_headers["Ethertype"] = "IPv4";
+							m_packets.SetEnum(COL_ETHERTYPE, "IPv4");
 							break;
 
 						case 0x0806:
-							pack->m_headers["Ethertype"] = "ARP";
+							m_packets.SetEnum(COL_ETHERTYPE, "ARP");
 							break;
 
 						case 0x8100:
-							pack->m_headers["Ethertype"] = "802.1q";
+							m_packets.SetEnum(COL_ETHERTYPE, "802.1q");
 							break;
 
 						case 0x86DD:
-							pack->m_headers["Ethertype"] = "IPv6";
+							m_packets.SetEnum(COL_ETHERTYPE, "IPv6");
 							break;
 
 						default:
-							snprintf(tmp, sizeof(tmp), "%02x%02x",
-							sample.m_sample.m_data[0],
-							sample.m_sample.m_data[1]);
-							pack->m_headers["Ethertype"] = tmp;
+							m_packets.SetInt(COL_ETHERTYPE, ethertype);
 							break;
 					}
 				}
@@ -290,7 +363,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 					sample.m_sample.m_type = EthernetFrameSegment::TYPE_FCS;
 				}
 				else
-					pack->m_data.push_back(bytes[i]);
+					m_packets.AppendPayload(bytes[i]);
 				break;
 
 			case EthernetFrameSegment::TYPE_FCS:
@@ -308,8 +381,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 					sample.m_duration = (ends[i] / cap->m_timescale) - sample.m_offset;
 					cap->m_samples.push_back(sample);
 
-					pack->m_len = ends[i] - pack->m_offset;
-					m_packets.push_back(pack);
+					m_packets.EndPacket(ends[i] - m_packets.GetOffset(m_packets.size()));
 				}
 
 				break;
@@ -318,4 +390,7 @@ void EthernetProtocolDecoder::BytesToFrames(
 				break;
 		}
 	}
+
+	//Drop the frame if it was truncated
+	m_packets.AbortPacket();
 }
@@ -80,12 +80,40 @@ public:
 
 	virtual std::vector<std::string> GetHeaders();
 
+	virtual int GetPcapLinkType();
+	virtual void WritePcap(PcapNGWriter& writer, int64_t tbase);
+
 protected:
+	virtual void InitColumns();
+
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_DST_MAC,
+		COL_SRC_MAC,
+		COL_ETHERTYPE
+	};
+
 	void BytesToFrames(
 		std::vector<uint8_t>& bytes,
 		std::vector<uint64_t>& starts,
 		std::vector<uint64_t>& ends,
 		EthernetCapture* cap);
+
+	//Frame assembly for streaming decoders
+	void AddFrameByte(uint8_t b, uint64_t start, uint64_t end);
+	void EndFrame(EthernetCapture* cap);
+
+	/**
+		@brief The frame currently being received, which may span several chunks of a stream
+	 */
+	class FrameState
+	{
+	public:
+		std::vector<uint8_t> m_bytes;
+		std::vector<uint64_t> m_starts;
+		std::vector<uint64_t> m_ends;
+	} m_frame;
 };
 
 #endif
@@ -349,9 +349,6 @@ bool EyeDecoder::DetectModulationLevels(AnalogCapture* din, EyeCapture* cap)
 
 void EyeDecoder2::Refresh()
 {
-	static double total_time = 0;
-	static double total_frames = 0;
-
 	LogIndenter li;
 
 	//Get the input data
@@ -376,8 +373,6 @@ void EyeDecoder2::Refresh()
 		return;
 	}
 
-	double start = GetTime();
-
 	//Initialize the capture
 	//TODO: timestamps? do we need those?
 	EyeCapture2* cap = dynamic_cast<EyeCapture2*>(m_data);
@@ -449,9 +444,4 @@ void EyeDecoder2::Refresh()
 
 	cap->Normalize();
 	SetData(cap);
-
-	double dt = GetTime() - start;
-	total_frames ++;
-	total_time += dt;
-	LogTrace("Refresh took %.3f ms (avg %.3f)\n", dt * 1000, (total_time * 1000) / total_frames);
 }
@@ -53,6 +53,38 @@ FFTDecoder::FFTDecoder(string color)
 	//Set up channels
 	m_signalNames.push_back("din");
 	m_channels.push_back(NULL);
+
+	//See WindowFunction
+	m_windowName = "Window";
+	m_parameters[m_windowName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_windowName].SetIntVal(WINDOW_RECTANGULAR);
+
+	//Zero-pad each segment up to a power of two rather than truncating it
+	m_padName = "Zero pad";
+	m_parameters[m_padName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_BOOL);
+	m_parameters[m_padName].SetBoolVal(false);
+
+	//Welch averaging: points per segment (0 for a single FFT of the whole capture) and overlap between segments
+	m_segmentName = "Segment length";
+	m_parameters[m_segmentName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_segmentName].SetIntVal(0);
+
+	m_overlapName = "Segment overlap (%)";
+	m_parameters[m_overlapName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_overlapName].SetIntVal(50);
+
+	//Exponential averaging across acquisitions (1 for none)
+	m_averagesName = "Exp. averages";
+	m_parameters[m_averagesName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_averagesName].SetIntVal(1);
+
+	m_windowType = WINDOW_RECTANGULAR;
+	m_windowLen = 0;
+	m_avgBinHz = 0;
+	m_avgFFTLen = 0;
+	m_avgSegLen = 0;
+	m_avgWindowType = WINDOW_RECTANGULAR;
+	m_avgGeneration = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -94,6 +126,12 @@ bool FFTDecoder::IsOverlay()
 	return false;
 }
 
+bool FFTDecoder::UsesResultCache()
+{
+	//output is a pure function of the input waveform, unless we're averaging across acquisitions
+	return m_parameters[m_averagesName].GetIntVal() <= 1;
+}
+
 bool FFTDecoder::NeedsConfig()
 {
 	//we auto-select the midpoint as our threshold
@@ -111,6 +149,123 @@ void FFTDecoder::SetDefaultName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+/**
+	@brief Recalculates the window coefficients if the window type or length changed
+
+	Keyed on the requested type and length rather than on what MakeWindow() produced, so an unknown type (which
+	falls back to rectangular) is only warned about once rather than on every refresh.
+ */
+void FFTDecoder::UpdateWindow(int type, size_t len)
+{
+	if( (type == m_windowType) && (len == m_windowLen) )
+		return;
+
+	m_windowType = type;
+	m_windowLen = len;
+	MakeWindow(type, len, m_window);
+}
+
+/**
+	@brief Calculates coefficients for a window function
+
+	@param type		One of WindowFunction
+	@param len		Number of points
+	@param window	Coefficients. Left empty for a rectangular window, so callers can skip the multiply.
+ */
+void FFTDecoder::MakeWindow(int type, size_t len, vector<float>& window)
+{
+	window.clear();
+	if( (type == WINDOW_RECTANGULAR) || (len < 2) )
+		return;
+
+	//Cosine-sum windows
+	float a[5] = {0};
+	switch(type)
+	{
+		case WINDOW_HANN:
+			a[0] = 0.5f;
+			a[1] = 0.5f;
+			break;
+
+		case WINDOW_BLACKMAN_HARRIS:
+			a[0] = 0.35875f;
+			a[1] = 0.48829f;
+			a[2] = 0.14128f;
+			a[3] = 0.01168f;
+			break;
+
+		case WINDOW_FLAT_TOP:
+			a[0] = 0.21557895f;
+			a[1] = 0.41663158f;
+			a[2] = 0.277263158f;
+			a[3] = 0.083578947f;
+			a[4] = 0.006947368f;
+			break;
+
+		default:
+			LogWarning("FFTDecoder: unknown window function %d, using rectangular\n", type);
+			return;
+	}
+
+	window.resize(len);
+	double scale = 2 * M_PI / (len - 1);
+	for(size_t i=0; i<len; i++)
+	{
+		double x = scale * i;
+		window[i] = a[0] - a[1]*cos(x) + a[2]*cos(2*x) - a[3]*cos(3*x) + a[4]*cos(4*x);
+	}
+}
+
+/**
+	@brief Runs one FFT and adds its power spectrum (excluding DC) to an accumulator
+
+	@param samples	First input sample of the segment
+	@param len		Number of input samples
+	@param nfft		FFT size (len is zero-padded up to this)
+	@param window	Window coefficients (len of them), or NULL for rectangular
+	@param rdin		Work buffer of nfft floats
+	@param rdout	Work buffer of nfft+2 floats
+	@param plan		Forward real FFT plan of size nfft
+	@param power	Accumulator of nfft/2 bins
+ */
+void FFTDecoder::ProcessSegment(
+	const AnalogSample* samples,
+	size_t len,
+	size_t nfft,
+	const float* window,
+	float* rdin,
+	float* rdout,
+	ffts_plan_t* plan,
+	float* power)
+{
+	if(window)
+	{
+		#pragma omp simd
+		for(size_t i=0; i<len; i++)
+			rdin[i] = samples[i].m_sample * window[i];
+	}
+	else
+	{
+		#pragma omp simd
+		for(size_t i=0; i<len; i++)
+			rdin[i] = samples[i].m_sample;
+	}
+	for(size_t i=len; i<nfft; i++)
+		rdin[i] = 0;
+
+	ffts_execute(plan, rdin, rdout);
+
+	const float* bins = rdout + 2;
+	const size_t nbins = nfft/2;
+	#pragma omp simd
+	for(size_t i=0; i<nbins; i++)
+	{
+		float a = bins[i*2];
+		float b = bins[i*2 + 1];
+		power[i] += a*a + b*b;
+	}
+}
+
 void FFTDecoder::Refresh()
 {
 	//Get the input data
@@ -122,68 +277,169 @@ void FFTDecoder::Refresh()
 	AnalogCapture* din = dynamic_cast<AnalogCapture*>(m_channels[0]->GetData());
 
 	//We need meaningful data
-	if(din->GetDepth() == 0)
+	if( (din == NULL) || (din->GetDepth() < 4) )
 	{
 		SetData(NULL);
 		return;
 	}
 
-	LogTrace("FFTDecoder: processing %zu raw points\n", din->m_samples.size());
-
-	//Truncate to next power of 2 down
 	const size_t npoints_raw = din->m_samples.size();
-	const size_t npoints = pow(2,floor(log2(npoints_raw)));
-	LogTrace("Rounded to %zu\n", npoints);
-
-	//Format the input data as raw samples for the FFT
-	//TODO: handle non-uniform sample rates
-	float* rdin;
-	posix_memalign((void**)&rdin, 32, npoints * sizeof(float));
-	for(size_t i=0; i<npoints; i++)
-		rdin[i] 		= din->m_samples[i];
-
-	float* rdout;
-	const size_t nouts = npoints/2 + 1;
-	posix_memalign((void**)&rdout, 32, 2 * nouts * sizeof(float));
+	LogTrace("FFTDecoder: processing %zu raw points\n", npoints_raw);
+
+	//Figure out how to split up the input.
+	//Each segment is truncated to the next power of 2 down, or zero-padded to the next power of 2 up.
+	size_t seglen = m_parameters[m_segmentName].GetIntVal();
+	if( (seglen < 4) || (seglen > npoints_raw) )
+		seglen = npoints_raw;
+	size_t nfft;
+	if(m_parameters[m_padName].GetBoolVal())
+		nfft = pow(2, ceil(log2(seglen)));
+	else
+	{
+		nfft = pow(2, floor(log2(seglen)));
+		seglen = nfft;
+	}
+	int overlap = max(0, min(m_parameters[m_overlapName].GetIntVal(), 99));
+	size_t hop = max(static_cast<size_t>(1), seglen * (100 - overlap) / 100);
+	size_t nseg = (npoints_raw - seglen) / hop + 1;
+	const size_t nouts = nfft/2 + 1;
+	const size_t nbins = nouts - 1;
+	LogTrace("%zu segments of %zu points, FFT size %zu\n", nseg, seglen, nfft);
 
-	//Calculate the FFT
-	auto plan = ffts_init_1d_real(npoints, FFTS_FORWARD);
-	ffts_execute(plan, &rdin[0], &rdout[0]);
-	ffts_free(plan);
+	UpdateWindow(m_parameters[m_windowName].GetIntVal(), seglen);
+	const float* window = m_window.empty() ? NULL : &m_window[0];
 
 	//Set up output and copy timestamps
 	FFTCapture* cap = new FFTCapture;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startPicoseconds = din->m_startPicoseconds;
 
-	//Calculate size of each bin
-	double ps = din->m_timescale * (din->GetSampleStart(1) - din->GetSampleStart(0));
+	//Calculate size of each bin.
+	//TODO: handle non-uniform sample rates. For now use the mean sample interval over the whole capture.
+	double ps = din->m_timescale * static_cast<double>(din->GetSampleStart(npoints_raw-1) - din->GetSampleStart(0)) /
+		(npoints_raw - 1);
 	double sample_ghz = 1000 / ps;
 	double bin_hz = round((0.5f * sample_ghz * 1e9f) / nouts);
 	cap->m_timescale = bin_hz;
 
-	//Normalize magnitudes
-	vector<float> mags;
+	//Output holds the power spectrum while we work on it
+	cap->m_samples.resize(nbins);
+	AnalogSample* out = &cap->m_samples[0];
+	vector<float> power(nbins, 0.0f);
+	const AnalogSample* samples = &din->m_samples[0];
+
+	//Single FFT: use our persistent buffers
+	if(nseg == 1)
+	{
+		float* rdin = m_rdin.Reserve(nfft);
+		float* rdout = m_rdout.Reserve(nfft + 2);
+		FFTPlanCache::Lease plan(nfft, FFTS_FORWARD);
+		if( (rdin == NULL) || (rdout == NULL) || (plan.get() == NULL) )
+		{
+			LogError("FFTDecoder: couldn't set up a %zu point FFT\n", nfft);
+			delete cap;
+			SetData(NULL);
+			return;
+		}
+		ProcessSegment(samples, seglen, nfft, window, rdin, rdout, plan.get(), &power[0]);
+	}
+
+	//Welch averaging: each thread works on its own subset of the segments
+	else
+	{
+		bool ok = true;
+		#pragma omp parallel
+		{
+			FFTWorkBuffer rdin;
+			FFTWorkBuffer rdout;
+			FFTPlanCache::Lease plan(nfft, FFTS_FORWARD);
+			vector<float> local(nbins, 0.0f);
+			bool tok = (rdin.Reserve(nfft) != NULL) && (rdout.Reserve(nfft + 2) != NULL) && (plan.get() != NULL);
+
+			#pragma omp for
+			for(size_t i=0; i<nseg; i++)
+			{
+				if(tok)
+				{
+					ProcessSegment(samples + i*hop, seglen, nfft, window,
+						rdin.GetData(), rdout.GetData(), plan.get(), &local[0]);
+				}
+			}
+
+			#pragma omp critical
+			{
+				if(!tok)
+					ok = false;
+				for(size_t i=0; i<nbins; i++)
+					power[i] += local[i];
+			}
+		}
+
+		if(!ok)
+		{
+			LogError("FFTDecoder: couldn't set up a %zu point FFT\n", nfft);
+			delete cap;
+			SetData(NULL);
+			return;
+		}
+
+		float scale = 1.0f / nseg;
+		#pragma omp simd
+		for(size_t i=0; i<nbins; i++)
+			power[i] *= scale;
+	}
+
+	//Exponential averaging across acquisitions.
+	//Start over if the bins moved or the FFT length or window changed, since the old spectra aren't comparable.
+	//Only fold in a new spectrum when the input is a new acquisition: refreshing for some other reason (e.g. a
+	//parameter change elsewhere in the graph) must not weight the same capture twice. A capture that was never
+	//published has generation zero and we can't tell, so it's always treated as new.
+	int navg = m_parameters[m_averagesName].GetIntVal();
+	if(navg > 1)
+	{
+		int wtype = m_parameters[m_windowName].GetIntVal();
+		if( (m_avgPower.size() != nbins) || (m_avgBinHz != bin_hz) || (m_avgFFTLen != nfft) ||
+			(m_avgSegLen != seglen) || (m_avgWindowType != wtype) )
+		{
+			m_avgPower = power;
+		}
+		else if( (din->m_generation == 0) || (din->m_generation != m_avgGeneration) )
+		{
+			float alpha = 1.0f / navg;
+			float* avg = &m_avgPower[0];
+			#pragma omp simd
+			for(size_t i=0; i<nbins; i++)
+				avg[i] += alpha * (power[i] - avg[i]);
+		}
+		m_avgBinHz = bin_hz;
+		m_avgFFTLen = nfft;
+		m_avgSegLen = seglen;
+		m_avgWindowType = wtype;
+		m_avgGeneration = din->m_generation;
+		power = m_avgPower;
+	}
+	else
+		m_avgPower.clear();
+
+	//Convert to magnitude, straight into the output.
+	//Term 0 (DC offset) isn't output. The real FFT has symmetric output, so the redundant image is already gone.
 	float maxmag = 1;
-	for(size_t i=1; i<nouts; i++)	//don't print (DC offset?) term 0
-									//real fft has symmetric output, ignore the redundant image of the data
+	const float* ppower = &power[0];
+	#pragma omp simd reduction(max:maxmag)
+	for(size_t i=0; i<nbins; i++)
 	{
-		float a = rdout[i*2];
-		float b = rdout[i*2 + 1];
-		float mag = sqrtf(a*a + b*b);
-		//float freq = (0.5f * i * sample_ghz * 1000) / nouts;
-
-		mags.push_back(mag);
-		if(mag > maxmag)
-			maxmag = mag;
+		float mag = sqrtf(ppower[i]);
+		out[i].m_offset = i+1;
+		out[i].m_duration = 1;
+		out[i].m_sample = mag;
+		maxmag = (mag > maxmag) ? mag : maxmag;
 	}
 
-	for(size_t i=1; i<nouts; i++)
-		cap->m_samples.push_back(AnalogSample(i, 1, mags[i-1] / maxmag));
+	//Normalize
+	float scale = 1.0f / maxmag;
+	#pragma omp simd
+	for(size_t i=0; i<nbins; i++)
+		out[i].m_sample *= scale;
 
 	SetData(cap);
-
-	//Clean up
-	free(rdin);
-	free(rdout);
 }
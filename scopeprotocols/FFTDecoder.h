@@ -36,6 +36,7 @@
 #define FFTDecoder_h
 
 #include "../scopehal/ProtocolDecoder.h"
+#include "FFTPlanCache.h"
 
 class FFTCapture : public AnalogCapture
 {
@@ -63,7 +64,56 @@ public:
 
 	PROTOCOL_DECODER_INITPROC(FFTDecoder)
 
+	///Values of the "Window" parameter
+	enum WindowFunction
+	{
+		WINDOW_RECTANGULAR,
+		WINDOW_HANN,
+		WINDOW_BLACKMAN_HARRIS,
+		WINDOW_FLAT_TOP
+	};
+
+	static void MakeWindow(int type, size_t len, std::vector<float>& window);
+
+	static void ProcessSegment(
+		const AnalogSample* samples,
+		size_t len,
+		size_t nfft,
+		const float* window,
+		float* rdin,
+		float* rdout,
+		ffts_plan_t* plan,
+		float* power);
+
 protected:
+	virtual bool UsesResultCache();
+
+	void UpdateWindow(int type, size_t len);
+
+	std::string m_windowName;
+	std::string m_padName;
+	std::string m_segmentName;
+	std::string m_overlapName;
+	std::string m_averagesName;
+
+	//FFT input and output, reused between refreshes
+	FFTWorkBuffer m_rdin;
+	FFTWorkBuffer m_rdout;
+
+	///Window coefficients for the current segment length (empty if rectangular)
+	std::vector<float> m_window;
+	int m_windowType;
+	size_t m_windowLen;
+
+	///Exponentially averaged power spectrum
+	std::vector<float> m_avgPower;
+
+	//Settings and input the average was last updated with
+	double m_avgBinHz;
+	size_t m_avgFFTLen;
+	size_t m_avgSegLen;
+	int m_avgWindowType;
+	uint64_t m_avgGeneration;
 };
 
 #endif
@@ -0,0 +1,163 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of FFTPlanCache
+ */
+
+#include "../scopehal/scopehal.h"
+#include "FFTPlanCache.h"
+#include <ffts.h>
+#include <thread>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+FFTPlanCache::FFTPlanCache()
+	: m_idlePoints(0)
+	, m_maxPerSize(max(1U, thread::hardware_concurrency()))	//enough for every thread to run the same size at once
+	, m_maxPoints(32 * 1024 * 1024)								//a couple of plans for the deepest captures
+{
+}
+
+FFTPlanCache::~FFTPlanCache()
+{
+	Clear();
+}
+
+FFTPlanCache& FFTPlanCache::GetDefault()
+{
+	static FFTPlanCache cache;
+	return cache;
+}
+
+/**
+	@brief Frees every idle plan. Leased plans are freed when they come back.
+ */
+void FFTPlanCache::Clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	for(auto& it : m_idle)
+		ffts_free(it.second);
+	m_idle.clear();
+	m_idleCount.clear();
+	m_idlePoints = 0;
+}
+
+/**
+	@brief Sets how many idle plans are kept, freeing the least recently used ones if over the new limits
+
+	@param maxPerSize	Maximum number of idle plans of any one size and direction
+	@param maxPoints	Maximum total size of all idle plans, in points
+ */
+void FFTPlanCache::SetLimits(size_t maxPerSize, size_t maxPoints)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_maxPerSize = maxPerSize;
+	m_maxPoints = maxPoints;
+	Trim();
+}
+
+/**
+	@brief Frees the least recently used idle plans until both limits are met. Must be called with m_mutex held.
+ */
+void FFTPlanCache::Trim()
+{
+	//Walk from the oldest end so the least recently used plans of each size go first
+	for(auto it = m_idle.end(); it != m_idle.begin(); )
+	{
+		--it;
+		auto key = it->first;
+		if( (m_idlePoints <= m_maxPoints) && (m_idleCount[key] <= m_maxPerSize) )
+			continue;
+
+		ffts_free(it->second);
+		m_idlePoints -= key.first;
+		if(--m_idleCount[key] == 0)
+			m_idleCount.erase(key);
+		it = m_idle.erase(it);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Leasing
+
+/**
+	@brief Gets a real-input 1D plan for exclusive use, creating one if none are idle
+
+	@param npoints		Number of real input points
+	@param direction	FFTS_FORWARD or FFTS_BACKWARD
+ */
+ffts_plan_t* FFTPlanCache::Acquire(size_t npoints, int direction)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		KeyType key(npoints, direction);
+		for(auto it = m_idle.begin(); it != m_idle.end(); ++it)
+		{
+			if(it->first != key)
+				continue;
+
+			auto plan = it->second;
+			m_idle.erase(it);
+			m_idlePoints -= npoints;
+			if(--m_idleCount[key] == 0)
+				m_idleCount.erase(key);
+			return plan;
+		}
+	}
+
+	//Plan creation can take a while, don't hold the lock for it
+	LogTrace("FFTPlanCache: creating %s plan for %zu points\n",
+		(direction == FFTS_FORWARD) ? "forward" : "backward", npoints);
+	auto plan = ffts_init_1d_real(npoints, direction);
+	if(plan == NULL)
+		LogError("FFTPlanCache: couldn't create plan for %zu points\n", npoints);
+	return plan;
+}
+
+/**
+	@brief Returns a plan obtained from Acquire()
+ */
+void FFTPlanCache::Release(size_t npoints, int direction, ffts_plan_t* plan)
+{
+	if(plan == NULL)
+		return;
+
+	lock_guard<mutex> lock(m_mutex);
+	KeyType key(npoints, direction);
+	m_idle.push_front(IdleListType::value_type(key, plan));
+	m_idleCount[key] ++;
+	m_idlePoints += npoints;
+	Trim();
+}
@@ -0,0 +1,170 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of FFTPlanCache and FFTWorkBuffer
+ */
+#ifndef FFTPlanCache_h
+#define FFTPlanCache_h
+
+#include <mutex>
+#include <list>
+
+//Don't pull ffts.h into our public headers
+struct _ffts_plan_t;
+typedef struct _ffts_plan_t ffts_plan_t;
+
+/**
+	@brief Process-wide pool of FFTS plans, keyed by size and direction
+
+	Creating a plan is far more expensive than executing it for the sizes we use, so plans are kept around once
+	they're returned. An FFTS plan has internal scratch space and can't be executed by two threads at once, so each
+	plan is leased to one caller at a time and a new one is created if every plan of the right size is busy.
+
+	Idle plans are capped both per size and in total (counted in points, since a plan's memory is proportional to its
+	size), and the least recently used plans are freed first. Changing the memory depth back and forth therefore
+	doesn't leave every size ever used resident.
+ */
+class FFTPlanCache
+{
+public:
+	FFTPlanCache();
+	~FFTPlanCache();
+
+	static FFTPlanCache& GetDefault();
+
+	ffts_plan_t* Acquire(size_t npoints, int direction);
+	void Release(size_t npoints, int direction, ffts_plan_t* plan);
+	void Clear();
+
+	void SetLimits(size_t maxPerSize, size_t maxPoints);
+
+	/**
+		@brief Scoped lease of a real-input 1D plan
+	 */
+	class Lease
+	{
+	public:
+		Lease(size_t npoints, int direction, FFTPlanCache& cache = FFTPlanCache::GetDefault())
+		: m_cache(cache)
+		, m_npoints(npoints)
+		, m_direction(direction)
+		, m_plan(cache.Acquire(npoints, direction))
+		{}
+
+		~Lease()
+		{ m_cache.Release(m_npoints, m_direction, m_plan); }
+
+		ffts_plan_t* get()
+		{ return m_plan; }
+
+	protected:
+		FFTPlanCache& m_cache;
+		size_t m_npoints;
+		int m_direction;
+		ffts_plan_t* m_plan;
+
+	private:
+		Lease(const Lease&);
+		Lease& operator=(const Lease&);
+	};
+
+protected:
+	void Trim();
+
+	std::mutex m_mutex;
+
+	typedef std::pair<size_t, int> KeyType;
+	typedef std::list< std::pair<KeyType, ffts_plan_t*> > IdleListType;
+
+	///Plans not currently leased, most recently returned first
+	IdleListType m_idle;
+
+	///Number of idle plans of each size and direction
+	std::map<KeyType, size_t> m_idleCount;
+
+	///Total size of all idle plans, in points
+	size_t m_idlePoints;
+
+	///Maximum number of idle plans of any one size and direction
+	size_t m_maxPerSize;
+
+	///Maximum total size of all idle plans, in points
+	size_t m_maxPoints;
+};
+
+/**
+	@brief A float buffer aligned for SIMD loads that only reallocates when it has to grow
+ */
+class FFTWorkBuffer
+{
+public:
+	FFTWorkBuffer()
+	: m_data(NULL)
+	, m_size(0)
+	{}
+
+	~FFTWorkBuffer()
+	{ free(m_data); }
+
+	///Makes sure the buffer holds at least n floats and returns it. Contents are not preserved.
+	float* Reserve(size_t n)
+	{
+		if(n > m_size)
+		{
+			free(m_data);
+			if(0 != posix_memalign((void**)&m_data, 32, n * sizeof(float)))
+			{
+				m_data = NULL;
+				m_size = 0;
+				return NULL;
+			}
+			m_size = n;
+		}
+		return m_data;
+	}
+
+	float* GetData()
+	{ return m_data; }
+
+	size_t GetSize()
+	{ return m_size; }
+
+protected:
+	float* m_data;
+	size_t m_size;
+
+private:
+	FFTWorkBuffer(const FFTWorkBuffer&);
+	FFTWorkBuffer& operator=(const FFTWorkBuffer&);
+};
+
+#endif
@@ -110,36 +110,111 @@ void IBM8b10bDecoder::Refresh()
 		return;
 	}
 
-	//Create the capture
-	IBM8b10bCapture* cap = new IBM8b10bCapture;
-	cap->m_timescale = 1;
-	cap->m_startTimestamp = din->m_startTimestamp;
-	cap->m_startPicoseconds = din->m_startPicoseconds;
-
-	//Record the value of the data stream at each clock edge
-	vector<DigitalSample> data;
-	size_t ndata = 0;
-	bool old_clk = false;
-	for(size_t i=0; i<clkin->m_samples.size(); i++)
+	RefreshStreaming();
+}
+
+bool IBM8b10bDecoder::SupportsStreaming()
+{
+	return true;
+}
+
+void IBM8b10bDecoder::Begin()
+{
+	ProtocolDecoder::Begin();
+
+	m_stream.m_lastClock = false;
+	m_stream.m_clockEdges.clear();
+	m_stream.m_bits.clear();
+	m_stream.m_aligned = false;
+	m_stream.m_offset = 0;
+	m_stream.m_first = true;
+	m_stream.m_lastDisp = -1;
+}
+
+void IBM8b10bDecoder::Push(const vector<CaptureChannelBase*>& chunk)
+{
+	if(chunk.size() < 2)
+		return;
+	DigitalCapture* din = dynamic_cast<DigitalCapture*>(chunk[0]);
+	DigitalCapture* clkin = dynamic_cast<DigitalCapture*>(chunk[1]);
+	if( (din == NULL) || (clkin == NULL) )
+		return;
+
+	auto& st = m_stream;
+
+	//Append to the current output, if any
+	IBM8b10bCapture* cap = dynamic_cast<IBM8b10bCapture*>(GetData());
+	if(cap == NULL)
 	{
-		//Throw away clock samples until we find an edge
-		//For now, reference clock is always DDR.
-		//TODO: support single rate reference clocks
-		auto csample = clkin->m_samples[i];
-		if(old_clk == csample.m_sample)
-			break;
-		old_clk = csample.m_sample;
+		cap = new IBM8b10bCapture;
+		cap->m_timescale = 1;
+		cap->m_startTimestamp = din->m_startTimestamp;
+		cap->m_startPicoseconds = din->m_startPicoseconds;
+	}
 
+	//Throw away clock samples until we find an edge
+	//For now, reference clock is always DDR.
+	//TODO: support single rate reference clocks
+	for(auto& csample : clkin->m_samples)
+	{
+		if(st.m_lastClock == csample.m_sample)
+			continue;
+		st.m_lastClock = csample.m_sample;
+		st.m_clockEdges.push_back(csample.m_offset * clkin->m_timescale);
+	}
+
+	//Record the value of the data stream at each clock edge.
+	//Edges with no data sample after them in this chunk wait for the next one.
+	size_t ndata = 0;
+	while(!st.m_clockEdges.empty())
+	{
 		//Throw away data samples until the data is synced with us
-		int64_t clkstart = csample.m_offset * clkin->m_timescale;
+		int64_t clkstart = st.m_clockEdges.front();
 		while( (ndata < din->m_samples.size()) && (din->m_samples[ndata].m_offset * din->m_timescale < clkstart) )
 			ndata ++;
 		if(ndata >= din->m_samples.size())
 			break;
 
-		data.push_back(DigitalSample(clkstart, 1, din->m_samples[ndata].m_sample));
+		st.m_bits.push_back(DigitalSample(clkstart, 1, din->m_samples[ndata].m_sample));
+		st.m_clockEdges.pop_front();
+	}
+
+	if(!st.m_aligned && (st.m_bits.size() >= COMMA_SEARCH_BITS) )
+		Align();
+	if(st.m_aligned)
+		DecodeSymbols(cap);
+
+	SetData(cap);
+}
+
+void IBM8b10bDecoder::Flush()
+{
+	//Short stream, align on whatever we have
+	if(!m_stream.m_aligned)
+		Align();
+
+	IBM8b10bCapture* cap = dynamic_cast<IBM8b10bCapture*>(GetData());
+	if(cap == NULL)
+	{
+		cap = new IBM8b10bCapture;
+		cap->m_timescale = 1;
 	}
 
+	if(m_stream.m_aligned)
+		DecodeSymbols(cap);
+
+	SetData(cap);
+}
+
+/**
+	@brief Picks the symbol alignment with the most commas in the bits collected so far
+ */
+void IBM8b10bDecoder::Align()
+{
+	auto& bits = m_stream.m_bits;
+	if(bits.size() <= 20)
+		return;
+
 	//Look for commas in the data stream
 	//TODO: make this more efficient?
 	size_t max_commas = 0;
@@ -147,14 +222,14 @@ void IBM8b10bDecoder::Refresh()
 	for(size_t offset=0; offset < 10; offset ++)
 	{
 		size_t num_commas = 0;
-		for(size_t i=0; i<data.size() - 20; i += 10)
+		for(size_t i=0; i<bits.size() - 20; i += 10)
 		{
 			//Check if we have a comma (five identical bits) anywhere in the data stream
 			//Commas are always at positions 2...6 within the symbol (left-right bit ordering)
 			bool comma = true;
 			for(int j=3; j<=6; j++)
 			{
-				if(data[i+offset+j].m_sample != data[i+offset+2].m_sample)
+				if(bits[i+offset+j].m_sample != bits[i+offset+2].m_sample)
 				{
 					comma = false;
 					break;
@@ -171,19 +246,30 @@ void IBM8b10bDecoder::Refresh()
 		//LogDebug("Found %zu commas at offset %zu\n", num_commas, offset);
 	}
 
-	//Decode the actual data
-	bool first = true;
-	int last_disp = -1;
-	for(size_t i=max_offset; i<data.size()-11; i+= 10)
+	m_stream.m_offset = max_offset;
+	m_stream.m_aligned = true;
+}
+
+/**
+	@brief Decodes all complete symbols collected so far, then discards their bits
+ */
+void IBM8b10bDecoder::DecodeSymbols(IBM8b10bCapture* cap)
+{
+	auto& st = m_stream;
+	auto& bits = st.m_bits;
+
+	//Each symbol needs the start of the next one to get its duration
+	size_t i = st.m_offset;
+	for(; i + 11 < bits.size(); i += 10)
 	{
 		//5b/6b decode
 		uint8_t code6 =
-			(data[i].m_sample << 5) |
-			(data[i+1].m_sample << 4) |
-			(data[i+2].m_sample << 3) |
-			(data[i+3].m_sample << 2) |
-			(data[i+4].m_sample << 1) |
-			(data[i+5].m_sample << 0);
+			(bits[i].m_sample << 5) |
+			(bits[i+1].m_sample << 4) |
+			(bits[i+2].m_sample << 3) |
+			(bits[i+3].m_sample << 2) |
+			(bits[i+4].m_sample << 1) |
+			(bits[i+5].m_sample << 0);
 
 		static const int code5_table[64] =
 		{
@@ -240,10 +326,10 @@ void IBM8b10bDecoder::Refresh()
 
 		//3b/4b decode
 		uint8_t code4 =
-			(data[i+6].m_sample << 3) |
-			(data[i+7].m_sample << 2) |
-			(data[i+8].m_sample << 1) |
-			(data[i+9].m_sample << 0);
+			(bits[i+6].m_sample << 3) |
+			(bits[i+7].m_sample << 2) |
+			(bits[i+8].m_sample << 1) |
+			(bits[i+9].m_sample << 0);
 
 		static const bool err3_ctl_table[16] =
 		{
@@ -308,35 +394,36 @@ void IBM8b10bDecoder::Refresh()
 
 		//Disparity tracking
 		int total_disp = disp3 + disp5;
-		if(first)
+		if(st.m_first)
 		{
 			if(total_disp < 0)
-				last_disp = 1;
+				st.m_lastDisp = 1;
 			else
-				last_disp = -1;
-			first = false;
+				st.m_lastDisp = -1;
+			st.m_first = false;
 		}
 
 		bool disperr = false;
-		if(total_disp > 0 && last_disp > 0)
+		if(total_disp > 0 && st.m_lastDisp > 0)
 		{
 			disperr = true;
-			last_disp = 1;
+			st.m_lastDisp = 1;
 		}
-		else if(total_disp < 0 && last_disp < 0)
+		else if(total_disp < 0 && st.m_lastDisp < 0)
 		{
 			disperr = true;
-			last_disp = -1;
+			st.m_lastDisp = -1;
 		}
 		else
-			last_disp += total_disp;
+			st.m_lastDisp += total_disp;
 
 
 		cap->m_samples.push_back(IBM8b10bSample(
-			data[i].m_offset,
-			data[i+10].m_offset - data[i].m_offset,
+			bits[i].m_offset,
+			bits[i+10].m_offset - bits[i].m_offset,
 			IBM8b10bSymbol(ctl5, err5 || err3 || disperr, (code3 << 5) | code5)));
 	}
 
-	SetData(cap);
+	bits.erase(bits.begin(), bits.begin() + i);
+	st.m_offset = 0;
 }
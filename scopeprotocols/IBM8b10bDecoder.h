@@ -37,6 +37,7 @@
 #define IBM8b10bDecoder_h
 
 #include "../scopehal/ProtocolDecoder.h"
+#include <deque>
 
 class IBM8b10bSymbol
 {
@@ -74,9 +75,45 @@ public:
 
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
+	virtual bool SupportsStreaming();
+	virtual void Begin();
+	virtual void Push(const std::vector<CaptureChannelBase*>& chunk);
+	virtual void Flush();
+
 	PROTOCOL_DECODER_INITPROC(IBM8b10bDecoder)
 
 protected:
+	void Align();
+	void DecodeSymbols(IBM8b10bCapture* cap);
+
+	///Number of bits to collect before picking the comma alignment of a stream
+	static const size_t COMMA_SEARCH_BITS = 20480;
+
+	/**
+		@brief Decoder state carried between chunks of a stream
+	 */
+	class StreamState
+	{
+	public:
+		///Clock state at the end of the previous chunk
+		bool m_lastClock;
+
+		///Clock edges (in picoseconds) still waiting for a data sample
+		std::deque<int64_t> m_clockEdges;
+
+		///Recovered bits not yet decoded
+		std::vector<DigitalSample> m_bits;
+
+		///True once we've picked the symbol alignment
+		bool m_aligned;
+
+		///Position of the next symbol in m_bits
+		size_t m_offset;
+
+		//Disparity tracking
+		bool m_first;
+		int m_lastDisp;
+	} m_stream;
 };
 
 #endif
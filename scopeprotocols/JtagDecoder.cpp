@@ -96,6 +96,11 @@ JtagDecoder::JtagDecoder(string color)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factory methods
 
+bool JtagDecoder::SupportsTimeWindow()
+{
+	return true;
+}
+
 bool JtagDecoder::NeedsConfig()
 {
 	//need to set channel configuration
@@ -159,13 +164,38 @@ void JtagDecoder::Refresh()
 		return;
 	}
 
+	//If we only need part of the capture, resync at the last TAP reset before the window.
+	//Without one we can't know the TAP state, so start from the beginning as usual.
+	//Past the end of the window, keep decoding until any shift in progress completes.
+	JtagSymbol::JtagState initial_state = JtagSymbol::RUN_TEST_IDLE;
+	int64_t tstart;
+	int64_t tend;
+	bool windowed = GetDecodeWindow(tstart, tend);
+
 	//Sample the data stream at each clock edge
-	vector<DigitalSample> dtdi;
-	vector<DigitalSample> dtdo;
-	vector<DigitalSample> dtms;
-	SampleOnRisingEdges(tdi, tck, dtdi);
-	SampleOnRisingEdges(tdo, tck, dtdo);
-	SampleOnRisingEdges(tms, tck, dtms);
+	//Bit 0 is TDI, bit 1 is TDO, bit 2 is TMS
+	vector<DigitalCapture*> lanes = {tdi, tdo, tms};
+	MultiLaneSamples samples;
+	bool more_samples = false;
+	int64_t tsync = 0;
+	int64_t tsampled = 0;
+	if(windowed)
+	{
+		//Only sample up to the end of the window for now. If a shift is still running there, we sample more below.
+		//Back off by 1ps so the first edge of the reset is included.
+		bool synced = FindTapReset(tms, tck, tstart, tsync);
+		if(synced)
+			initial_state = JtagSymbol::UNKNOWN_0;
+		SeekSampleOnEdges(lanes, tck, samples, tsync - 1);
+		more_samples = ContinueSampleOnEdges<EDGE_RISING>(lanes, tck, samples, tend);
+		tsampled = tend;
+
+		//Without a reset we decode from the start of the capture
+		if(!synced)
+			tsync = INT64_MIN;
+	}
+	else
+		SampleOnEdges<EDGE_RISING>(lanes, tck, samples);
 
 	//Create the capture
 	JtagCapture* cap = new JtagCapture;
@@ -227,8 +257,8 @@ void JtagDecoder::Refresh()
 	};
 
 	//Main decode loop
-	//Assume we're in RTI before we get any TMS edges
-	JtagSymbol::JtagState state = JtagSymbol::RUN_TEST_IDLE;
+	//Assume we're in RTI before we get any TMS edges (unless we resynced on a reset)
+	JtagSymbol::JtagState state = initial_state;
 	size_t istart = 0;
 	size_t packstart = 0;
 	size_t nbits = 0;
@@ -237,11 +267,36 @@ void JtagDecoder::Refresh()
 	vector<uint8_t> ibytes;
 	vector<uint8_t> obytes;
 	string irval = "??";
-	for(size_t i=0; i<dtms.size(); i++)
+	int64_t tdecoded = INT64_MAX;
+	for(size_t i=0; ; i++)
 	{
+		//Out of samples, but more of the capture remains. If not shifting we've covered the window, so stop.
+		//Otherwise the shift runs on past what we sampled: sample some more, twice as far each time.
+		if( (i >= samples.size()) && more_samples &&
+			(state != JtagSymbol::SHIFT_IR) && (state != JtagSymbol::SHIFT_DR) )
+		{
+			tdecoded = tsampled;
+			break;
+		}
+		while( (i >= samples.size()) && more_samples)
+		{
+			int64_t chunk = max(tsampled - tstart, static_cast<int64_t>(1));
+			tsampled = (tsampled > INT64_MAX - chunk) ? INT64_MAX : tsampled + chunk;
+			more_samples = ContinueSampleOnEdges<EDGE_RISING>(lanes, tck, samples, tsampled);
+		}
+		if(i >= samples.size())
+			break;
+
+		//Past the end of the window and not shifting, we're done
+		if(windowed && (samples.m_offsets[i] > tend) && (state != JtagSymbol::SHIFT_IR) && (state != JtagSymbol::SHIFT_DR) )
+		{
+			tdecoded = samples.m_offsets[i];
+			break;
+		}
+
 		//Update the state
 		JtagSymbol::JtagState next_state;
-		if(dtms[i])
+		if(samples.GetLane(i, 2))
 			next_state = state_if_tms_high[state];
 		else
 			next_state = state_if_tms_low[state];
@@ -249,10 +304,10 @@ void JtagDecoder::Refresh()
 		if( (state == JtagSymbol::SHIFT_IR) || (state == JtagSymbol::SHIFT_DR) )
 		{
 			idata = (idata >> 1);
-			if(dtdi[i])
+			if(samples.GetLane(i, 0))
 				idata |= 0x80;
 			odata = (odata << 1);
-			if(dtdo[i])
+			if(samples.GetLane(i, 1))
 				odata |= 0x1;
 			nbits ++;
 		}
@@ -261,8 +316,8 @@ void JtagDecoder::Refresh()
 		{
 			//Add a sample for the previous state
 			cap->m_samples.push_back(JtagSample(
-				dtms[istart].m_offset,
-				dtms[i].m_offset - dtms[istart].m_offset,
+				samples.m_offsets[istart],
+				samples.m_offsets[i] - samples.m_offsets[istart],
 				JtagSymbol(state, idata, odata, nbits)));
 
 			//Add packets for the IR/DR change
@@ -275,33 +330,31 @@ void JtagDecoder::Refresh()
 				ibytes.push_back(idata);
 				obytes.push_back(odata);
 
+				int64_t packoff = samples.m_offsets[packstart];
+				int64_t packlen = samples.m_offsets[i] - packoff;
+				int64_t bits = ibytes.size()*8 - 8 + nbits;
+
 				//Write side
-				Packet* pack = new Packet;
-				pack->m_offset = dtms[packstart].m_offset;
+				m_packets.BeginPacket(packoff);
 				if(state == JtagSymbol::SHIFT_IR)
-					pack->m_headers["Operation"] = "IR write";
+					m_packets.SetEnum(COL_OPERATION, "IR write");
 				else
-					pack->m_headers["Operation"] = "DR write";
-				pack->m_headers["IR"] = irval;
-				snprintf(tmp, sizeof(tmp), "%zu", ibytes.size()*8 - 8 + nbits);
-				pack->m_headers["Bits"] = tmp;
-				pack->m_data = ibytes;
-				pack->m_len = dtms[i].m_offset - pack->m_offset;
-				m_packets.push_back(pack);
+					m_packets.SetEnum(COL_OPERATION, "DR write");
+				m_packets.SetEnum(COL_IR, irval.c_str());
+				m_packets.SetInt(COL_BITS, bits);
+				m_packets.AppendPayload(ibytes.data(), ibytes.size());
+				m_packets.EndPacket(packlen);
 
 				//Read side
-				pack = new Packet;
-				pack->m_offset = dtms[packstart].m_offset;
+				m_packets.BeginPacket(packoff);
 				if(state == JtagSymbol::SHIFT_IR)
-					pack->m_headers["Operation"] = "IR read";
+					m_packets.SetEnum(COL_OPERATION, "IR read");
 				else
-					pack->m_headers["Operation"] = "DR read";
-				pack->m_headers["IR"] = irval;
-				snprintf(tmp, sizeof(tmp), "%zu", ibytes.size()*8 - 8 + nbits);
-				pack->m_headers["Bits"] = tmp;
-				pack->m_data = obytes;
-				pack->m_len = dtms[i].m_offset - pack->m_offset;
-				m_packets.push_back(pack);
+					m_packets.SetEnum(COL_OPERATION, "DR read");
+				m_packets.SetEnum(COL_IR, irval.c_str());
+				m_packets.SetInt(COL_BITS, bits);
+				m_packets.AppendPayload(obytes.data(), obytes.size());
+				m_packets.EndPacket(packlen);
 
 				//Update current IR
 				if(state == JtagSymbol::SHIFT_IR)
@@ -334,8 +387,8 @@ void JtagDecoder::Refresh()
 			if(nbits == 8)
 			{
 				cap->m_samples.push_back(JtagSample(
-					dtms[istart].m_offset,
-					dtms[i].m_offset - dtms[istart].m_offset,
+					samples.m_offsets[istart],
+					samples.m_offsets[i] - samples.m_offsets[istart],
 					JtagSymbol(state, idata, odata, 8)));
 
 				ibytes.push_back(idata);
@@ -349,5 +402,47 @@ void JtagDecoder::Refresh()
 
 	//LogDebug("%zu packets\n", m_packets.size());
 
+	//Our output covers everything from the resync point to wherever we stopped, which may be well past the window
+	if(windowed)
+		SetDecodedRange(tsync, tdecoded);
+
 	SetData(cap);
 }
+
+/**
+	@brief Looks back from a given time for the last TAP reset (TMS high for five TCK rising edges in a row)
+
+	@param tms		TMS signal
+	@param tck		TCK signal
+	@param t		Time to search back from
+	@param tsync	Set to the time of the first of the five edges. The TAP is in an unknown state until then.
+
+	@return True if a reset was found
+ */
+bool JtagDecoder::FindTapReset(DigitalCapture* tms, DigitalCapture* tck, int64_t t, int64_t& tsync)
+{
+	if(tms->m_samples.empty())
+		return false;
+
+	size_t nhigh = 0;
+	for(size_t i = FindSampleAtTime(tck, t); i > 0; i--)
+	{
+		//Skip everything but rising edges
+		if(!tck->m_samples[i].m_sample || tck->m_samples[i-1].m_sample)
+			continue;
+
+		int64_t tedge = tck->m_samples[i].m_offset * tck->m_timescale;
+		if(tms->m_samples[FindSampleAtTime(tms, tedge)].m_sample)
+			nhigh ++;
+		else
+			nhigh = 0;
+
+		if(nhigh == 5)
+		{
+			tsync = tedge;
+			return true;
+		}
+	}
+
+	return false;
+}
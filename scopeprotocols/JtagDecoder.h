@@ -111,9 +111,20 @@ public:
 
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
+	virtual bool SupportsTimeWindow();
+
 	PROTOCOL_DECODER_INITPROC(JtagDecoder)
 
 protected:
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_OPERATION,
+		COL_IR,
+		COL_BITS
+	};
+
+	bool FindTapReset(DigitalCapture* tms, DigitalCapture* tck, int64_t t, int64_t& tsync);
 };
 
 #endif
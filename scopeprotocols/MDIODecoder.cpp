@@ -164,15 +164,15 @@ void MDIODecoder::Refresh()
 			MDIOSymbol(MDIOSymbol::TYPE_PREAMBLE, 0)));
 
 		//Create the packet
-		Packet* pack = new Packet;
-		pack->m_offset = start;
+		int64_t packstart = start;
+		m_packets.BeginPacket(packstart);
 
 		//TODO: safely ignore extra preamble bits
 
 		//Next 2 bits are start delimiter
 		if(i+2 >= dmdio.size())
 		{
-			delete pack;
+			m_packets.AbortPacket();
 			break;
 		}
 		uint16_t sof = 0;
@@ -184,7 +184,7 @@ void MDIODecoder::Refresh()
 		//MDIO Clause 22 frame
 		if(sof == 0x01)
 		{
-			pack->m_headers["Clause"] = "22";
+			m_packets.SetInt(COL_CLAUSE, 22);
 
 			//Add the start symbol
 			cap->m_samples.push_back(MDIOSample(
@@ -196,7 +196,7 @@ void MDIODecoder::Refresh()
 			//Next 2 bits are opcode
 			if(i+2 >= dmdio.size())
 			{
-				delete pack;
+				m_packets.AbortPacket();
 				break;
 			}
 			uint16_t op = 0;
@@ -206,11 +206,11 @@ void MDIODecoder::Refresh()
 				op |= 1;
 
 			if(op == 1)
-				pack->m_headers["Op"] = "Write";
+				m_packets.SetEnum(COL_OP, "Write");
 			else if(op == 2)
-				pack->m_headers["Op"] = "Read";
+				m_packets.SetEnum(COL_OP, "Read");
 			else
-				pack->m_headers["Op"] = "ERROR";
+				m_packets.SetEnum(COL_OP, "ERROR");
 
 			cap->m_samples.push_back(MDIOSample(
 				dmdio[i].m_offset,
@@ -236,14 +236,12 @@ void MDIODecoder::Refresh()
 				MDIOSymbol(MDIOSymbol::TYPE_PHYADDR, addr)));
 			i += 5;
 
-			char tmp[32];
-			snprintf(tmp, sizeof(tmp), "%02x", addr);
-			pack->m_headers["PHY"] = tmp;
+			m_packets.SetInt(COL_PHY, addr);
 
 			//Next 5 bits are reg address
 			if(i+5 >= dmdio.size())
 			{
-				delete pack;
+				m_packets.AbortPacket();
 				break;
 			}
 			addr = 0;
@@ -261,8 +259,7 @@ void MDIODecoder::Refresh()
 				MDIOSymbol(MDIOSymbol::TYPE_REGADDR, addr)));
 			i += 5;
 
-			snprintf(tmp, sizeof(tmp), "%02x", addr);
-			pack->m_headers["Reg"] = tmp;
+			m_packets.SetInt(COL_REG, addr);
 
 			//Next 2 bits are bus turnaround
 			if(i+2 >= dmdio.size())
@@ -276,7 +273,7 @@ void MDIODecoder::Refresh()
 			//Next 16 bits are frame data
 			if(i+16 >= dmdio.size())
 			{
-				delete pack;
+				m_packets.AbortPacket();
 				break;
 			}
 			uint16_t value = 0;
@@ -294,8 +291,7 @@ void MDIODecoder::Refresh()
 				MDIOSymbol(MDIOSymbol::TYPE_DATA, value)));
 			i += 16;
 
-			snprintf(tmp, sizeof(tmp), "%04x", value);
-			pack->m_headers["Value"] = tmp;
+			m_packets.SetInt(COL_VALUE, value);
 
 			//Add extra information to the decode if it's a known register
 			//TODO: share this between clause 22 and 45 decoders
@@ -464,21 +460,23 @@ void MDIODecoder::Refresh()
 
 				//TODO: support for PHY vendor specific registers if we know the PHY ID (or are told)
 			}
-			pack->m_headers["Info"] = info;
+			m_packets.SetString(COL_INFO, info);
 
 			//Done, add the packet
-			m_packets.push_back(pack);
+			m_packets.EndPacket(start + len - packstart);
 		}
 
 		//MDIO Clause 45 frame
 		else if(sof == 0x00)
 		{
 			LogWarning("MDIO Clause 45 not yet supported");
+			m_packets.AbortPacket();
 		}
 
 		//Invalid frame format
 		else
 		{
+			m_packets.AbortPacket();
 			cap->m_samples.push_back(MDIOSample(
 				dmdio[i].m_offset,
 				(dmdio[i+1].m_offset - dmdio[i].m_offset) + dmdio[i+1].m_duration,
@@ -487,9 +485,19 @@ void MDIODecoder::Refresh()
 		}
 	}
 
+	//Discard the last frame if it was truncated
+	m_packets.AbortPacket();
+
 	SetData(cap);
 }
 
+void MDIODecoder::InitColumns()
+{
+	m_packets.SetIntFormat(COL_PHY, "%02" PRIx64);
+	m_packets.SetIntFormat(COL_REG, "%02" PRIx64);
+	m_packets.SetIntFormat(COL_VALUE, "%04" PRIx64);
+}
+
 vector<string> MDIODecoder::GetHeaders()
 {
 	vector<string> ret;
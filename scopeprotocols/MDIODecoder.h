@@ -89,6 +89,18 @@ public:
 	PROTOCOL_DECODER_INITPROC(MDIODecoder)
 
 protected:
+	virtual void InitColumns();
+
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_CLAUSE,
+		COL_OP,
+		COL_PHY,
+		COL_REG,
+		COL_VALUE,
+		COL_INFO
+	};
 };
 
 #endif
@@ -130,8 +130,8 @@ void PeriodMeasurementDecoder::Refresh()
 	}
 
 	//Timestamps of the edges
-	vector<int64_t> edges;
-	FindZeroCrossings(din, 0, edges);
+	EdgeListPtr pedges = EdgeDetector::FindZeroCrossings(din, 0);
+	auto& edges = *pedges;
 	if(edges.size() < 2)
 	{
 		SetData(NULL);
@@ -0,0 +1,303 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of SpectrogramDecoder
+ */
+
+#include "../scopehal/scopehal.h"
+#include "SpectrogramDecoder.h"
+#include "FFTDecoder.h"
+#include "../scopehal/AnalogRenderer.h"
+#include <ffts.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SpectrogramCapture
+
+SpectrogramCapture::SpectrogramCapture(size_t width, size_t height)
+	: m_binHz(0)
+	, m_rowPeriod(0)
+	, m_rowDuration(0)
+	, m_width(width)
+	, m_height(height)
+	, m_outdata(width*height, 0.0f)
+{
+}
+
+SpectrogramCapture::~SpectrogramCapture()
+{
+}
+
+size_t SpectrogramCapture::GetDepth() const
+{
+	return 0;
+}
+
+int64_t SpectrogramCapture::GetEndTime() const
+{
+	return 0;
+}
+
+int64_t SpectrogramCapture::GetSampleStart(size_t /*i*/) const
+{
+	return 0;
+}
+
+int64_t SpectrogramCapture::GetSampleLen(size_t /*i*/) const
+{
+	return 0;
+}
+
+bool SpectrogramCapture::EqualityTest(size_t /*i*/, size_t /*j*/) const
+{
+	return false;
+}
+
+bool SpectrogramCapture::SamplesAdjacent(size_t /*i*/, size_t /*j*/) const
+{
+	return false;
+}
+
+size_t SpectrogramCapture::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_outdata.capacity() * sizeof(float);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+SpectrogramDecoder::SpectrogramDecoder(string color)
+	: ProtocolDecoder(OscilloscopeChannel::CHANNEL_TYPE_ANALOG, color, CAT_MATH)
+	, m_windowType(-1)
+	, m_windowLen(0)
+{
+	m_xAxisUnit = Unit(Unit::UNIT_HZ);
+
+	//Set up channels
+	m_signalNames.push_back("din");
+	m_channels.push_back(NULL);
+
+	//Number of time slices. The FFT size is the largest power of two that fits this many overlapping windows.
+	m_rowsName = "Rows";
+	m_parameters[m_rowsName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_rowsName].SetIntVal(256);
+
+	m_overlapName = "Overlap (%)";
+	m_parameters[m_overlapName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_overlapName].SetIntVal(50);
+
+	//See FFTDecoder::WindowFunction
+	m_windowName = "Window";
+	m_parameters[m_windowName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_INT);
+	m_parameters[m_windowName].SetIntVal(FFTDecoder::WINDOW_HANN);
+
+	//Dynamic range of the output, below the strongest bin
+	m_rangeName = "Range (dB)";
+	m_parameters[m_rangeName] = ProtocolDecoderParameter(ProtocolDecoderParameter::TYPE_FLOAT);
+	m_parameters[m_rangeName].SetFloatVal(70);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Factory methods
+
+ChannelRenderer* SpectrogramDecoder::CreateRenderer()
+{
+	//Placeholder only, the client draws the image (see class comment)
+	return new AnalogRenderer(this);
+}
+
+bool SpectrogramDecoder::ValidateChannel(size_t i, OscilloscopeChannel* channel)
+{
+	if( (i == 0) && (channel->GetType() == OscilloscopeChannel::CHANNEL_TYPE_ANALOG) )
+		return true;
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Accessors
+
+double SpectrogramDecoder::GetOffset()
+{
+	return 0;
+}
+
+double SpectrogramDecoder::GetVoltageRange()
+{
+	return 1;
+}
+
+string SpectrogramDecoder::GetProtocolName()
+{
+	return "Spectrogram";
+}
+
+bool SpectrogramDecoder::IsOverlay()
+{
+	//we create a new analog channel
+	return false;
+}
+
+bool SpectrogramDecoder::NeedsConfig()
+{
+	//defaults are fine
+	return false;
+}
+
+bool SpectrogramDecoder::UsesResultCache()
+{
+	//output is a pure function of the input waveform
+	return true;
+}
+
+void SpectrogramDecoder::SetDefaultName()
+{
+	char hwname[256];
+	snprintf(hwname, sizeof(hwname), "Spectrogram(%s)", m_channels[0]->m_displayname.c_str());
+	m_hwname = hwname;
+	m_displayname = m_hwname;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Actual decoder logic
+
+void SpectrogramDecoder::Refresh()
+{
+	//Get the input data
+	if(m_channels[0] == NULL)
+	{
+		SetData(NULL);
+		return;
+	}
+	AnalogCapture* din = dynamic_cast<AnalogCapture*>(m_channels[0]->GetData());
+
+	//We need meaningful data
+	if( (din == NULL) || (din->GetDepth() < 8) )
+	{
+		SetData(NULL);
+		return;
+	}
+	const size_t npoints = din->m_samples.size();
+
+	//Pick the largest power of two window such that nrows windows overlapping by the requested amount fit
+	size_t nrows = max(1, m_parameters[m_rowsName].GetIntVal());
+	nrows = min(nrows, npoints / 4);
+	int overlap = max(0, min(m_parameters[m_overlapName].GetIntVal(), 99));
+	double span = 1 + (nrows - 1) * (100 - overlap) / 100.0;
+	size_t nfft = pow(2, floor(log2(max(4.0, npoints / span))));
+	const size_t nbins = nfft / 2;
+
+	//Spread the rows evenly across the capture, so overlap is only approximate
+	size_t hop = (nrows > 1) ? (npoints - nfft) / (nrows - 1) : 0;
+	LogTrace("SpectrogramDecoder: %zu rows of %zu point FFTs, %zu points apart\n", nrows, nfft, hop);
+
+	int wtype = m_parameters[m_windowName].GetIntVal();
+	if( (wtype != m_windowType) || (nfft != m_windowLen) )
+	{
+		FFTDecoder::MakeWindow(wtype, nfft, m_window);
+		m_windowType = wtype;
+		m_windowLen = nfft;
+	}
+	const float* window = m_window.empty() ? NULL : &m_window[0];
+
+	//Set up the output
+	SpectrogramCapture* cap = new SpectrogramCapture(nbins, nrows);
+	cap->m_startTimestamp = din->m_startTimestamp;
+	cap->m_startPicoseconds = din->m_startPicoseconds;
+
+	//Same bin size calculation as FFTDecoder (assumes uniform sampling)
+	double ps = din->m_timescale * static_cast<double>(din->GetSampleStart(npoints-1) - din->GetSampleStart(0)) /
+		(npoints - 1);
+	double sample_ghz = 1000 / ps;
+	cap->m_binHz = round((0.5f * sample_ghz * 1e9f) / (nbins + 1));
+	cap->m_timescale = cap->m_binHz;
+	cap->m_rowPeriod = hop * ps;
+	cap->m_rowDuration = nfft * ps;
+
+	//Each thread takes a batch of rows, with its own plan and work buffers.
+	//Power spectra are accumulated straight into the image (which starts out zeroed).
+	const AnalogSample* samples = &din->m_samples[0];
+	float* img = cap->GetData();
+	bool ok = true;
+	#pragma omp parallel
+	{
+		FFTWorkBuffer rdin;
+		FFTWorkBuffer rdout;
+		FFTPlanCache::Lease plan(nfft, FFTS_FORWARD);
+		bool tok = (rdin.Reserve(nfft) != NULL) && (rdout.Reserve(nfft + 2) != NULL) && (plan.get() != NULL);
+
+		#pragma omp for
+		for(size_t row=0; row<nrows; row++)
+		{
+			if(tok)
+			{
+				FFTDecoder::ProcessSegment(samples + row*hop, nfft, nfft, window,
+					rdin.GetData(), rdout.GetData(), plan.get(), img + row*nbins);
+			}
+		}
+
+		if(!tok)
+		{
+			#pragma omp critical
+			ok = false;
+		}
+	}
+
+	if(!ok)
+	{
+		LogError("SpectrogramDecoder: couldn't set up a %zu point FFT\n", nfft);
+		delete cap;
+		SetData(NULL);
+		return;
+	}
+
+	//Normalize to the strongest bin anywhere in the image
+	const size_t npix = nbins * nrows;
+	float maxpower = 0;
+	#pragma omp parallel for reduction(max:maxpower)
+	for(size_t i=0; i<npix; i++)
+		maxpower = (img[i] > maxpower) ? img[i] : maxpower;
+
+	//Convert to dB, mapping the requested range onto 0-1.
+	//Cap values to prevent going off-scale-low with our color ramps (same as WaterfallDecoder).
+	float range = max(1.0f, m_parameters[m_rangeName].GetFloatVal());
+	float scale = 1.0f / max(maxpower, FLT_MIN);
+	float vmin = 1.0 / 255.0;
+	#pragma omp parallel for
+	for(size_t i=0; i<npix; i++)
+	{
+		float value = 1 + 10 * log10f(img[i] * scale + FLT_MIN) / range;
+		img[i] = (value < vmin) ? vmin : value;
+	}
+
+	SetData(cap);
+}
@@ -0,0 +1,126 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of SpectrogramDecoder
+ */
+#ifndef SpectrogramDecoder_h
+#define SpectrogramDecoder_h
+
+#include "../scopehal/ProtocolDecoder.h"
+
+/**
+	@brief A time-frequency image. Each row is the spectrum of one window of the input, oldest at the top.
+ */
+class SpectrogramCapture : public CaptureChannelBase
+{
+public:
+	SpectrogramCapture(size_t width, size_t height);
+	virtual ~SpectrogramCapture();
+
+	float* GetData()
+	{ return &m_outdata[0]; }
+
+	size_t GetWidth() const
+	{ return m_width; }
+
+	size_t GetHeight() const
+	{ return m_height; }
+
+	///Width of each frequency bin (one pixel), in Hz
+	double m_binHz;
+
+	///Time from the start of one row's window to the next, in picoseconds
+	int64_t m_rowPeriod;
+
+	///Length of the window used for each row, in picoseconds
+	int64_t m_rowDuration;
+
+protected:
+	size_t m_width;
+	size_t m_height;
+
+	std::vector<float> m_outdata;
+
+public:
+	//Not really applicable for spectrograms
+	virtual size_t GetDepth() const;
+	virtual int64_t GetEndTime() const;
+	virtual int64_t GetSampleStart(size_t i) const;
+	virtual int64_t GetSampleLen(size_t i) const;
+	virtual bool EqualityTest(size_t i, size_t j) const;
+	virtual bool SamplesAdjacent(size_t i, size_t j) const;
+
+	virtual size_t GetMemoryUsage() const;
+};
+
+/**
+	@brief Computes a spectrogram (short-time FFT) of an analog waveform.
+
+	The output is a 2D image, which none of the ChannelRenderer classes can draw. As with WaterfallDecoder, the
+	client is expected to draw the SpectrogramCapture itself. CreateRenderer() only returns an AnalogRenderer so the
+	channel has something to hang its label on; since the capture reports a depth of zero, it draws no samples.
+ */
+class SpectrogramDecoder : public ProtocolDecoder
+{
+public:
+	SpectrogramDecoder(std::string color);
+
+	virtual void Refresh();
+	virtual ChannelRenderer* CreateRenderer();
+
+	virtual bool NeedsConfig();
+	virtual bool IsOverlay();
+
+	static std::string GetProtocolName();
+	virtual void SetDefaultName();
+
+	virtual double GetVoltageRange();
+	virtual double GetOffset();
+	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
+
+	PROTOCOL_DECODER_INITPROC(SpectrogramDecoder)
+
+protected:
+	virtual bool UsesResultCache();
+
+	std::string m_rowsName;
+	std::string m_overlapName;
+	std::string m_windowName;
+	std::string m_rangeName;
+
+	///Window coefficients for the current FFT size (empty if rectangular)
+	std::vector<float> m_window;
+	int m_windowType;
+	size_t m_windowLen;
+};
+
+#endif
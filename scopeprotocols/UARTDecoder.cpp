@@ -103,138 +103,187 @@ void UARTDecoder::SetDefaultName()
 
 void UARTDecoder::Refresh()
 {
-	ClearPackets();
-
 	//Get the input data
-	if(m_channels[0] == NULL)
-	{
-		SetData(NULL);
-		return;
-	}
-	DigitalCapture* din = dynamic_cast<DigitalCapture*>(m_channels[0]->GetData());
-	if(din == NULL)
+	if( (m_channels[0] == NULL) || (dynamic_cast<DigitalCapture*>(m_channels[0]->GetData()) == NULL) )
 	{
+		ClearPackets();
 		SetData(NULL);
 		return;
 	}
 
+	RefreshStreaming();
+}
+
+bool UARTDecoder::SupportsStreaming()
+{
+	return true;
+}
+
+void UARTDecoder::Begin()
+{
+	ProtocolDecoder::Begin();
+	ClearPackets();
+
 	//Get the bit period
 	float bit_period = 1.0f / m_parameters[m_baudname].GetFloatVal();
 	bit_period *= 1E12;
-	int64_t ibitper = bit_period;
-	int64_t scaledbitper = ibitper / din->m_timescale;
 
-	//UART processing
-	AsciiCapture* cap = new AsciiCapture;
-	cap->m_timescale = din->m_timescale;
-	cap->m_startTimestamp = din->m_startTimestamp;
-	cap->m_startPicoseconds = din->m_startPicoseconds;
+	m_stream.m_state = StreamState::STATE_IDLE;
+	m_stream.m_bitPeriod = bit_period;
+	m_stream.m_scaledBitPeriod = 0;
+	m_stream.m_timescale = 1;
+	m_stream.m_tstart = 0;
+	m_stream.m_nextValue = 0;
+	m_stream.m_tlast = 0;
+	m_stream.m_lastOffset = 0;
+	m_stream.m_dval = 0;
+	m_stream.m_nbit = 0;
+}
+
+void UARTDecoder::Push(const vector<CaptureChannelBase*>& chunk)
+{
+	if(chunk.empty())
+		return;
+	DigitalCapture* din = dynamic_cast<DigitalCapture*>(chunk[0]);
+	if( (din == NULL) || din->m_samples.empty() )
+		return;
+
+	auto& st = m_stream;
+	if(st.m_scaledBitPeriod == 0)
+	{
+		st.m_timescale = din->m_timescale;
+		st.m_scaledBitPeriod = st.m_bitPeriod / din->m_timescale;
+	}
+	int64_t scaledbitper = st.m_scaledBitPeriod;
+
+	//Append to the current output, if any
+	AsciiCapture* cap = dynamic_cast<AsciiCapture*>(GetData());
+	if(cap == NULL)
+	{
+		cap = new AsciiCapture;
+		cap->m_timescale = din->m_timescale;
+		cap->m_startTimestamp = din->m_startTimestamp;
+		cap->m_startPicoseconds = din->m_startPicoseconds;
+	}
 
-	//Time-domain processing to reflect potentially variable sampling rate for RLE captures
-	int64_t next_value = 0;
+	//Time-domain processing to reflect potentially variable sampling rate for RLE captures.
+	//Samples are only consumed when they can't satisfy the current state, so a state change re-examines the same sample.
+	size_t len = din->m_samples.size();
 	size_t isample = 0;
-	int64_t tlast = 0;
-	Packet* pack = NULL;
-	while(isample < din->m_samples.size())
+	while(isample < len)
 	{
-		//Wait for signal to go high (idle state)
-		while( (isample < din->m_samples.size()) && !din->m_samples[isample].m_sample)
-			isample ++;
-		if(isample >= din->m_samples.size())
-			break;
-
-		//Wait for a falling edge (start bit)
-		while( (isample < din->m_samples.size()) && din->m_samples[isample].m_sample)
-			isample ++;
-		if(isample >= din->m_samples.size())
-			break;
-
-		//Time of the start bit
-		int64_t tstart = din->m_samples[isample].m_offset;
-
-		//The next data bit should be measured 1.5 bit periods after the falling edge
-		next_value = tstart + scaledbitper + scaledbitper/2;
-
-		//Read eight data bits
-		unsigned char dval = 0;
-		for(int ibit=0; ibit<8; ibit++)
+		auto& samp = din->m_samples[isample];
+		int64_t samp_end = samp.m_offset + samp.m_duration;
+
+		switch(st.m_state)
 		{
-			//Find the sample of interest
-			while( (isample < din->m_samples.size()) && ((din->m_samples[isample].m_offset + din->m_samples[isample].m_duration) < next_value))
-				isample ++;
-			if(isample >= din->m_samples.size())
+			//Wait for signal to go high (idle state)
+			case StreamState::STATE_IDLE:
+				if(!samp.m_sample)
+					isample ++;
+				else
+					st.m_state = StreamState::STATE_START;
 				break;
 
-			//Got the sample
-			dval = (dval >> 1) | (din->m_samples[isample].m_sample ? 0x80 : 0);
+			//Wait for a falling edge (start bit)
+			case StreamState::STATE_START:
+				if(samp.m_sample)
+					isample ++;
+				else
+				{
+					//The next data bit should be measured 1.5 bit periods after the falling edge
+					st.m_tstart = samp.m_offset;
+					st.m_nextValue = st.m_tstart + scaledbitper + scaledbitper/2;
+					st.m_dval = 0;
+					st.m_nbit = 0;
+					st.m_state = StreamState::STATE_DATA;
+				}
+				break;
 
-			//Go on to the next bit
-			next_value += scaledbitper;
-		}
+			//Read eight data bits
+			case StreamState::STATE_DATA:
+				if(samp_end < st.m_nextValue)
+					isample ++;
+				else
+				{
+					st.m_dval = (st.m_dval >> 1) | (samp.m_sample ? 0x80 : 0);
+					st.m_nextValue += scaledbitper;
+					st.m_nbit ++;
+					if(st.m_nbit == 8)
+						st.m_state = StreamState::STATE_STOP;
+				}
+				break;
 
-		//If we ran out of space before we hit the end of the buffer, abort
-		if(isample >= din->m_samples.size())
-			break;
-
-		//All good, read the stop bit
-		while( (isample < din->m_samples.size()) && ((din->m_samples[isample].m_offset + din->m_samples[isample].m_duration) < next_value))
-			isample ++;
-		if(isample >= din->m_samples.size())
-			break;
-
-		//Save the sample
-		int64_t tend = next_value + (scaledbitper/2);
-		cap->m_samples.push_back(AsciiSample(
-			tstart,
-			tend-tstart,
-			(char)dval));
-
-		//If the last packet was more than 3 byte times ago, start a new one
-		if(pack != NULL)
-		{
-			int64_t delta = tstart - tlast;
-			if(delta > 30 * scaledbitper)
-			{
-				pack->m_len = (tend * din->m_timescale) - pack->m_offset;
-				FinishPacket(pack);
-				pack = NULL;
-			}
+			//Read the stop bit
+			case StreamState::STATE_STOP:
+				if(samp_end < st.m_nextValue)
+					isample ++;
+				else
+				{
+					//Save the sample
+					int64_t tstart = st.m_tstart;
+					int64_t tend = st.m_nextValue + (scaledbitper/2);
+					cap->m_samples.push_back(AsciiSample(
+						tstart,
+						tend-tstart,
+						(char)st.m_dval));
+
+					//If the last packet was more than 3 byte times ago, start a new one
+					if(m_packets.IsPacketOpen())
+					{
+						int64_t delta = tstart - st.m_tlast;
+						if(delta > 30 * scaledbitper)
+							FinishPacket(tend * din->m_timescale);
+					}
+
+					//If we don't have a packet yet, start one
+					if(!m_packets.IsPacketOpen())
+						m_packets.BeginPacket(tstart * din->m_timescale);
+
+					//Append to the existing packet
+					m_packets.AppendPayload(st.m_dval);
+					st.m_tlast = tstart;
+
+					st.m_state = StreamState::STATE_IDLE;
+				}
+				break;
 		}
+	}
 
-		//If we don't have a packet yet, start one
-		if(pack == NULL)
-		{
-			pack = new Packet;
-			pack->m_offset = tstart * din->m_timescale;
-		}
+	st.m_lastOffset = din->m_samples[len-1].m_offset;
 
-		//Append to the existing packet
-		pack->m_data.push_back(dval);
-		tlast = tstart;
-	}
+	SetData(cap);
+}
 
+void UARTDecoder::Flush()
+{
 	//If we have a packet in progress, add it
-	if(pack)
-	{
-		pack->m_len = (din->m_samples[din->m_samples.size()-1].m_offset * din->m_timescale) - pack->m_offset;
-		FinishPacket(pack);
-	}
+	auto& st = m_stream;
+	if(m_packets.IsPacketOpen())
+		FinishPacket(st.m_lastOffset * st.m_timescale);
 
-	SetData(cap);
+	//Make sure we have an output even if we never got any input
+	if(GetData() == NULL)
+		SetData(new AsciiCapture);
 }
 
-void UARTDecoder::FinishPacket(Packet* pack)
+/**
+	@brief Completes the packet in progress
+
+	@param tend		End time of the packet (picoseconds)
+ */
+void UARTDecoder::FinishPacket(int64_t tend)
 {
+	size_t row = m_packets.size();
+	const uint8_t* data = m_packets.GetPayload(row);
+	size_t len = m_packets.GetPayloadSize(row);
+
 	//length header
-	char tmp[128];
-	snprintf(tmp, sizeof(tmp), "%zu", pack->m_data.size());
-	pack->m_headers["Length"] = tmp;
+	m_packets.SetInt(COL_LENGTH, len);
 
 	//ascii packet contents
-	string s;
-	for(auto b : pack->m_data)
-		s += (char)b;
-	pack->m_headers["ASCII"] = s;
+	string s(reinterpret_cast<const char*>(data), len);
+	m_packets.SetString(COL_ASCII, s);
 
-	m_packets.push_back(pack);
+	m_packets.EndPacket(tend - m_packets.GetOffset(row));
 }
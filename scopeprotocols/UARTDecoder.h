@@ -54,11 +54,61 @@ public:
 
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
+	virtual bool SupportsStreaming();
+	virtual void Begin();
+	virtual void Push(const std::vector<CaptureChannelBase*>& chunk);
+	virtual void Flush();
+
 	PROTOCOL_DECODER_INITPROC(UARTDecoder)
 
 protected:
-	void FinishPacket(Packet* pack);
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_LENGTH,
+		COL_ASCII
+	};
+
+	void FinishPacket(int64_t tend);
 	std::string m_baudname;
+
+	/**
+		@brief Decoder state carried between chunks of a stream
+	 */
+	class StreamState
+	{
+	public:
+		enum State
+		{
+			STATE_IDLE,		//waiting for the line to go high
+			STATE_START,	//waiting for a falling edge (start bit)
+			STATE_DATA,		//reading data bits
+			STATE_STOP		//waiting for the stop bit
+		} m_state;
+
+		///Bit period, in picoseconds
+		int64_t m_bitPeriod;
+
+		///Bit period, in input timebase units (zero until the first chunk arrives)
+		int64_t m_scaledBitPeriod;
+
+		int64_t m_timescale;
+
+		///Start time of the current byte
+		int64_t m_tstart;
+
+		///Time at which to sample the next bit
+		int64_t m_nextValue;
+
+		///Start time of the previous byte
+		int64_t m_tlast;
+
+		///Offset of the last input sample seen
+		int64_t m_lastOffset;
+
+		uint8_t m_dval;
+		int m_nbit;
+	} m_stream;
 };
 
 #endif
@@ -82,6 +82,11 @@ bool USB2PacketDecoder::IsOverlay()
 	return true;
 }
 
+bool USB2PacketDecoder::SupportsTimeWindow()
+{
+	return true;
+}
+
 bool USB2PacketDecoder::NeedsConfig()
 {
 	return true;
@@ -108,6 +113,88 @@ vector<string> USB2PacketDecoder::GetHeaders()
 	return ret;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Export
+
+int USB2PacketDecoder::GetPcapLinkType()
+{
+	return PcapNGWriter::LINKTYPE_USB_2_0;
+}
+
+/**
+	@brief Writes each USB packet (PID through CRC) as one pcapng record
+
+	The raw packet bytes are reassembled from our symbol stream rather than the transaction-level packet table.
+ */
+void USB2PacketDecoder::WritePcap(PcapNGWriter& writer, int64_t tbase)
+{
+	auto cap = dynamic_cast<USB2PacketCapture*>(GetData());
+	if(cap == NULL)
+		return;
+
+	bool open = false;
+	uint16_t field = 0;
+	for(auto& s : cap->m_samples)
+	{
+		auto& sym = s.m_sample;
+		switch(sym.m_type)
+		{
+			//Every packet starts with a PID
+			case USB2PacketSymbol::TYPE_PID:
+				if(open)
+					writer.EndPacket();
+				writer.BeginPacket(tbase + s.m_offset * cap->m_timescale);
+				writer.Append(sym.m_data & 0xff);
+				open = true;
+				break;
+
+			//Token fields are packed LSB first into 11 bits, followed by the CRC
+			case USB2PacketSymbol::TYPE_ADDR:
+				field = sym.m_data & 0x7f;
+				break;
+
+			case USB2PacketSymbol::TYPE_ENDP:
+				field |= (sym.m_data & 0xf) << 7;
+				break;
+
+			case USB2PacketSymbol::TYPE_NFRAME:
+				field = sym.m_data & 0x7ff;
+				break;
+
+			case USB2PacketSymbol::TYPE_CRC5:
+				if(open)
+				{
+					writer.Append(field & 0xff);
+					writer.Append( (field >> 8) | (sym.m_data << 3) );
+				}
+				break;
+
+			case USB2PacketSymbol::TYPE_DATA:
+				if(open)
+					writer.Append(sym.m_data & 0xff);
+				break;
+
+			case USB2PacketSymbol::TYPE_CRC16:
+				if(open)
+				{
+					writer.Append(sym.m_data >> 8);
+					writer.Append(sym.m_data & 0xff);
+				}
+				break;
+
+			//Don't export malformed packets
+			case USB2PacketSymbol::TYPE_ERROR:
+			default:
+				writer.AbortPacket();
+				open = false;
+				break;
+		}
+	}
+
+	if(open)
+		writer.EndPacket();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
@@ -144,13 +231,39 @@ void USB2PacketDecoder::Refresh()
 		STATE_DATA
 	} state = STATE_IDLE;
 
+	//If we only need part of the capture, resync at the end of the last packet before the window
+	size_t istart = 0;
+	int64_t tstart;
+	int64_t tend;
+	bool windowed = GetDecodeWindow(tstart, tend);
+	if(windowed)
+	{
+		istart = FindSampleAtTime(din, tstart);
+		while(istart > 0)
+		{
+			auto type = din->m_samples[istart].m_sample.m_type;
+			if(type == USB2PCSSymbol::TYPE_IDLE)
+				break;
+			if(type == USB2PCSSymbol::TYPE_EOP)
+			{
+				istart ++;
+				break;
+			}
+			istart --;
+		}
+	}
+
 	//Decode stuff
 	uint8_t last = 0;
 	uint64_t last_offset;
-	for(size_t i=0; i<din->m_samples.size(); i++)
+	for(size_t i=istart; i<din->m_samples.size(); i++)
 	{
 		auto& sin = din->m_samples[i];
 
+		//Past the end of the window and between packets, we're done
+		if(windowed && (state == STATE_IDLE) && (sin.m_offset * din->m_timescale > tend) )
+			break;
+
 		switch(state)
 		{
 			case STATE_IDLE:
@@ -364,7 +477,7 @@ void USB2PacketDecoder::FindPackets(USB2PacketCapture* cap)
 	ClearPackets();
 
 	//Stop when we have no chance of fitting a full packet
-	for(size_t i=0; i<cap->m_samples.size() - 2;)
+	for(size_t i=0; i+2 < cap->m_samples.size();)
 	{
 		//Every packet should start with a PID. Discard unknown garbage.
 		auto& psample = cap->m_samples[i];
@@ -417,18 +530,16 @@ void USB2PacketDecoder::DecodeSof(USB2PacketCapture* cap, USB2PacketSample& star
 		return;
 
 	//Make the packet
-	Packet* pack = new Packet;
-	pack->m_offset = start.m_offset * cap->m_timescale;
-	pack->m_headers["Type"] = "SOF";
+	int64_t offset = start.m_offset * cap->m_timescale;
+	m_packets.BeginPacket(offset);
+	m_packets.SetEnum(COL_TYPE, "SOF");
 	char tmp[128];
 	snprintf(tmp, sizeof(tmp), "Sequence = %u", snframe.m_sample.m_data);
-	pack->m_headers["Details"] = tmp;
-	pack->m_len = ((scrc.m_offset + scrc.m_duration) * cap->m_timescale) - pack->m_offset;
-	m_packets.push_back(pack);
-
-	pack->m_headers["Device"] = "--";
-	pack->m_headers["Endpoint"] = "--";
-	pack->m_headers["Length"] = "2";
+	m_packets.SetString(COL_DETAILS, tmp);
+	m_packets.SetEnum(COL_DEVICE, "--");
+	m_packets.SetEnum(COL_ENDPOINT, "--");
+	m_packets.SetInt(COL_LENGTH, 2);
+	m_packets.EndPacket(((scrc.m_offset + scrc.m_duration) * cap->m_timescale) - offset);
 }
 
 void USB2PacketDecoder::DecodeSetup(USB2PacketCapture* cap, USB2PacketSample& start, size_t& i)
@@ -517,15 +628,12 @@ void USB2PacketDecoder::DecodeSetup(USB2PacketCapture* cap, USB2PacketSample& st
 	}
 
 	//Make the packet
-	Packet* pack = new Packet;
-	pack->m_offset = start.m_offset * cap->m_timescale;
-	pack->m_headers["Type"] = "SETUP";
-	char tmp[256];
-	snprintf(tmp, sizeof(tmp), "%d", saddr.m_sample.m_data);
-	pack->m_headers["Device"] = tmp;
-	snprintf(tmp, sizeof(tmp), "%d", sendp.m_sample.m_data);
-	pack->m_headers["Endpoint"] = tmp;
-	pack->m_headers["Length"] = "8";	//constant
+	int64_t offset = start.m_offset * cap->m_timescale;
+	m_packets.BeginPacket(offset);
+	m_packets.SetEnum(COL_TYPE, "SETUP");
+	m_packets.SetInt(COL_DEVICE, saddr.m_sample.m_data);
+	m_packets.SetInt(COL_ENDPOINT, sendp.m_sample.m_data);
+	m_packets.SetInt(COL_LENGTH, 8);	//constant
 
 	//Decode setup details
 	uint8_t bmRequestType = data[0];
@@ -570,6 +678,7 @@ void USB2PacketDecoder::DecodeSetup(USB2PacketCapture* cap, USB2PacketSample& st
 			sdest = "reserved";
 			break;
 	}
+	char tmp[256];
 	snprintf(
 		tmp,
 		sizeof(tmp),
@@ -582,11 +691,10 @@ void USB2PacketDecoder::DecodeSetup(USB2PacketCapture* cap, USB2PacketSample& st
 		wIndex,
 		wLength,
 		ack.c_str());
-	pack->m_headers["Details"] = tmp;
+	m_packets.SetString(COL_DETAILS, tmp);
 
 	//Done
-	pack->m_len = ((sdcrc.m_offset + sdcrc.m_duration) * cap->m_timescale) - pack->m_offset;
-	m_packets.push_back(pack);
+	m_packets.EndPacket(((sdcrc.m_offset + sdcrc.m_duration) * cap->m_timescale) - offset);
 }
 
 void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& start, size_t& i)
@@ -644,19 +752,16 @@ void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& sta
 		i++;
 
 		//Add a line for the aborted transaction
-		Packet* pack = new Packet;
-		pack->m_offset = start.m_offset * cap->m_timescale;
+		int64_t offset = start.m_offset * cap->m_timescale;
+		m_packets.BeginPacket(offset);
 		if( (start.m_sample.m_data & 0xf) == USB2PacketSymbol::PID_IN)
-			pack->m_headers["Type"] = "IN";
+			m_packets.SetEnum(COL_TYPE, "IN");
 		else
-			pack->m_headers["Type"] = "OUT";
-		char tmp[256];
-		snprintf(tmp, sizeof(tmp), "%d", saddr.m_sample.m_data);
-		pack->m_headers["Device"] = tmp;
-		snprintf(tmp, sizeof(tmp), "%d", sendp.m_sample.m_data);
-		pack->m_headers["Endpoint"] = tmp;
-		pack->m_headers["Details"] = "NAK";
-		m_packets.push_back(pack);
+			m_packets.SetEnum(COL_TYPE, "OUT");
+		m_packets.SetInt(COL_DEVICE, saddr.m_sample.m_data);
+		m_packets.SetInt(COL_ENDPOINT, sendp.m_sample.m_data);
+		m_packets.SetEnum(COL_DETAILS, "NAK");
+		m_packets.EndPacket(((sdatpid.m_offset + sdatpid.m_duration) * cap->m_timescale) - offset);
 		return;
 	}
 	else	//normal data
@@ -667,24 +772,23 @@ void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& sta
 		LogError("Not data PID (%x, i=%zu)\n", sdatpid.m_sample.m_data, i);
 
 		//DEBUG
-		Packet* pack = new Packet;
-		pack->m_offset = start.m_offset * cap->m_timescale;
-		pack->m_headers["Details"] = "ERROR";
-		m_packets.push_back(pack);
+		m_packets.BeginPacket(start.m_offset * cap->m_timescale);
+		m_packets.SetEnum(COL_DETAILS, "ERROR");
+		m_packets.EndPacket(0);
 		return;
 	}
 
 	//Create the new packet
-	Packet* pack = new Packet;
-	pack->m_offset = start.m_offset * cap->m_timescale;
+	int64_t offset = start.m_offset * cap->m_timescale;
+	int64_t len = 0;
+	size_t row = m_packets.size();
+	m_packets.BeginPacket(offset);
 	if( (start.m_sample.m_data & 0xf) == USB2PacketSymbol::PID_IN)
-		pack->m_headers["Type"] = "IN";
+		m_packets.SetEnum(COL_TYPE, "IN");
 	else
-		pack->m_headers["Type"] = "OUT";
-	snprintf(tmp, sizeof(tmp), "%d", saddr.m_sample.m_data);
-	pack->m_headers["Device"] = tmp;
-	snprintf(tmp, sizeof(tmp), "%d", sendp.m_sample.m_data);
-	pack->m_headers["Endpoint"] = tmp;
+		m_packets.SetEnum(COL_TYPE, "OUT");
+	m_packets.SetInt(COL_DEVICE, saddr.m_sample.m_data);
+	m_packets.SetInt(COL_ENDPOINT, sendp.m_sample.m_data);
 
 	//Read the data
 	while(i < cap->m_samples.size())
@@ -694,8 +798,8 @@ void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& sta
 		//Keep adding data
 		if(s.m_sample.m_type == USB2PacketSymbol::TYPE_DATA)
 		{
-			pack->m_data.push_back(s.m_sample.m_data);
-			pack->m_len = ((s.m_offset + s.m_duration) * cap->m_timescale) - pack->m_offset;
+			m_packets.AppendPayload(s.m_sample.m_data);
+			len = ((s.m_offset + s.m_duration) * cap->m_timescale) - offset;
 		}
 
 		//Next should be a CRC16
@@ -710,6 +814,7 @@ void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& sta
 	if(i >= cap->m_samples.size())
 	{
 		LogDebug("Truncated ACK\n");
+		m_packets.AbortPacket();
 		return;
 	}
 	string ack = "";
@@ -732,17 +837,17 @@ void USB2PacketDecoder::DecodeData(USB2PacketCapture* cap, USB2PacketSample& sta
 	}
 
 	//Format the data
+	const uint8_t* data = m_packets.GetPayload(row);
+	size_t datalen = m_packets.GetPayloadSize(row);
 	string details = "";
-	for(auto b : pack->m_data)
+	for(size_t j=0; j<datalen; j++)
 	{
-		snprintf(tmp, sizeof(tmp), "%02x ", b);
+		snprintf(tmp, sizeof(tmp), "%02x ", data[j]);
 		details += tmp;
 	}
 	details += ack;
-	pack->m_headers["Details"] = details;
-
-	snprintf(tmp, sizeof(tmp), "%zu", pack->m_data.size());
-	pack->m_headers["Length"] = tmp;
+	m_packets.SetString(COL_DETAILS, details);
+	m_packets.SetInt(COL_LENGTH, datalen);
 
-	m_packets.push_back(pack);
+	m_packets.EndPacket(len);
 }
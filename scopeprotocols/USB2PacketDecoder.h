@@ -102,6 +102,7 @@ public:
 	USB2PacketDecoder(std::string color);
 
 	virtual void Refresh();
+	virtual bool SupportsTimeWindow();
 	virtual ChannelRenderer* CreateRenderer();
 
 	virtual bool NeedsConfig();
@@ -115,11 +116,24 @@ public:
 	virtual std::vector<std::string> GetHeaders();
 	virtual bool GetShowDataColumn();
 
+	virtual int GetPcapLinkType();
+	virtual void WritePcap(PcapNGWriter& writer, int64_t tbase);
+
 	virtual bool ValidateChannel(size_t i, OscilloscopeChannel* channel);
 
 	PROTOCOL_DECODER_INITPROC(USB2PacketDecoder)
 
 protected:
+	///Indexes into GetHeaders()
+	enum Columns
+	{
+		COL_TYPE,
+		COL_DEVICE,
+		COL_ENDPOINT,
+		COL_LENGTH,
+		COL_DETAILS
+	};
+
 	void FindPackets(USB2PacketCapture* cap);
 	void DecodeSof(USB2PacketCapture* cap, USB2PacketSample& start, size_t& i);
 	void DecodeSetup(USB2PacketCapture* cap, USB2PacketSample& start, size_t& i);
@@ -133,40 +133,8 @@ void UartClockRecoveryDecoder::Refresh()
 	cap->m_timescale = 1;		//recovered clock time scale is single picoseconds
 
 	//Timestamps of the edges
-	vector<int64_t> edges;
-
-	//Find times of the zero crossings
-	bool first = true;
-	bool last = false;
-	const float threshold = m_parameters[m_threshname].GetFloatVal();
-	for(size_t i=1; i<din->m_samples.size(); i++)
-	{
-		auto sin = din->m_samples[i];
-		bool value = static_cast<float>(sin) > threshold;
-
-		//Start time of the sample, in picoseconds
-		int64_t t = din->m_triggerPhase + din->m_timescale * sin.m_offset;
-
-		//Move to the middle of the sample
-		t += din->m_timescale/2;
-
-		//Save the last value
-		if(first)
-		{
-			last = value;
-			first = false;
-			continue;
-		}
-
-		//Skip samples with no transition
-		if(last == value)
-			continue;
-
-		//Interpolate the time
-		t += din->m_timescale * Measurement::InterpolateTime(din, i-1, threshold);
-		edges.push_back(t);
-		last = value;
-	}
+	EdgeListPtr pedges = EdgeDetector::FindZeroCrossings(din, m_parameters[m_threshname].GetFloatVal());
+	auto& edges = *pedges;
 
 	//Actual DLL logic
 	//TODO: recover from glitches better?
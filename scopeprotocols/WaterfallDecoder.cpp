@@ -40,6 +40,7 @@ using namespace std;
 WaterfallCapture::WaterfallCapture(size_t width, size_t height)
 	: m_width(width)
 	, m_height(height)
+	, m_head(0)
 {
 	size_t npix = width*height;
 	m_outdata = new float[npix];
@@ -83,6 +84,11 @@ bool WaterfallCapture::SamplesAdjacent(size_t /*i*/, size_t /*j*/) const
 	return false;
 }
 
+size_t WaterfallCapture::GetMemoryUsage() const
+{
+	return sizeof(*this) + m_width*m_height*sizeof(float);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
@@ -92,6 +98,7 @@ WaterfallDecoder::WaterfallDecoder(string color)
 	, m_offsetHz(0)
 	, m_width(1)
 	, m_height(1)
+	, m_aggregation(AGGREGATE_MAX)
 {
 	//Set up channels
 	m_signalNames.push_back("din");
@@ -165,47 +172,70 @@ void WaterfallDecoder::Refresh()
 	FFTCapture* din = dynamic_cast<FFTCapture*>(m_channels[0]->GetData());
 
 	//We need meaningful data
-	if(din->GetDepth() == 0)
+	if( (din == NULL) || (din->GetDepth() == 0) || (m_width == 0) || (m_height == 0) )
 	{
 		SetData(NULL);
 		return;
 	}
 
-	//Initialize the capture
-	//TODO: timestamps? do we need those?qui
+	//Initialize the capture, starting over if our size changed
+	//TODO: timestamps? do we need those?
 	WaterfallCapture* cap = dynamic_cast<WaterfallCapture*>(m_data);
-	if(cap == NULL)
+	if( (cap == NULL) || (cap->GetWidth() != m_width) || (cap->GetHeight() != m_height) )
 		cap = new WaterfallCapture(m_width, m_height);
 	cap->m_timescale = 1;
-	float* data = cap->GetData();
-
-	//Move the whole waterfall down by one row
-	for(size_t y=0; y < m_height-1 ; y++)
-	{
-		for(size_t x=0; x<m_width; x++)
-			data[y*m_width + x] = data[(y+1)*m_width + x];
-	}
 
-	//Add the new data
+	//Aggregate every bin under each pixel, rather than point sampling, so nothing narrower than a pixel gets lost.
+	//Pixel x covers bins [bins_per_pixel*x + bin_offset, bins_per_pixel*(x+1) + bin_offset), and always at least one.
 	double hz_per_bin = din->m_timescale;
 	double bins_per_pixel = 1.0f / (m_pixelsPerHz  * hz_per_bin);
 	double bin_offset = m_offsetHz / hz_per_bin;
-	double vmin = 1.0 / 255.0;
+	int64_t nbins = din->GetDepth();
+	const AnalogSample* bins = &din->m_samples[0];
+	bool peak = (m_aggregation == AGGREGATE_MAX);
+
+	m_rowMagnitudes.resize(m_width);
+	float* mags = &m_rowMagnitudes[0];
 	for(size_t x=0; x<m_width; x++)
 	{
-		//Look up the frequency bin for this position
-		//For now, just do nearest neighbor interpolation
-		size_t nbin = static_cast<size_t>(round(bins_per_pixel*x + bin_offset));
-
-		float value = 0;
-		if(nbin < din->GetDepth())
-			value = (-70 - 20 * log10(din->m_samples[nbin].m_sample)) / -70;
-
-		//Cap values to prevent going off-scale-low with our color ramps
-		if(value < vmin)
-			value = vmin;
+		int64_t start = static_cast<int64_t>(floor(bins_per_pixel*x + bin_offset));
+		int64_t end = static_cast<int64_t>(floor(bins_per_pixel*(x+1) + bin_offset));
+		if(end <= start)
+			end = start + 1;
+
+		//Off the end of the spectrum
+		start = max(start, (int64_t)0);
+		end = min(end, nbins);
+		if(start >= end)
+		{
+			mags[x] = 0;
+			continue;
+		}
+
+		float value = bins[start].m_sample;
+		if(peak)
+		{
+			for(int64_t i=start+1; i<end; i++)
+				value = (bins[i].m_sample > value) ? bins[i].m_sample : value;
+		}
+		else
+		{
+			for(int64_t i=start+1; i<end; i++)
+				value = (bins[i].m_sample < value) ? bins[i].m_sample : value;
+		}
+		mags[x] = value;
+	}
 
-		data[(m_height-1)*m_width + x] = value;
+	//Convert the whole row to a 70 dB log scale in one pass, overwriting the oldest row in place.
+	//Cap values to prevent going off-scale-low with our color ramps.
+	float* row = cap->PushRow();
+	const float vmin = 1.0 / 255.0;
+	const float scale = 20.0f / 70;
+	#pragma omp simd
+	for(size_t x=0; x<m_width; x++)
+	{
+		float value = 1 + scale * log10f(mags[x] + FLT_MIN);
+		row[x] = (value < vmin) ? vmin : value;
 	}
 
 	SetData(cap);
@@ -37,18 +37,53 @@
 
 #include "../scopehal/ProtocolDecoder.h"
 
+/**
+	@brief Waterfall image, stored as a circular buffer of rows.
+
+	Rows are never moved once written. m_head is the physical row holding the oldest data, so display row y (0 at the
+	top, oldest) is physical row (m_head + y) % height. Use GetRow() to read rows in display order.
+ */
 class WaterfallCapture : public CaptureChannelBase
 {
 public:
 	WaterfallCapture(size_t width, size_t height);
 	virtual ~WaterfallCapture();
 
-	float* GetData()
+	/**
+		@brief Raw ring storage, in physical (not display) row order.
+
+		Row 0 of this buffer is NOT the top of the image: callers that want display order should use GetRow(), or
+		start at GetHead() and wrap around.
+	 */
+	float* GetRawRingData()
 	{ return m_outdata; }
 
+	size_t GetWidth() const
+	{ return m_width; }
+
+	size_t GetHeight() const
+	{ return m_height; }
+
+	///Physical index of the oldest row
+	size_t GetHead() const
+	{ return m_head; }
+
+	///Gets display row y, where 0 is the oldest row and height-1 the newest
+	const float* GetRow(size_t y) const
+	{ return m_outdata + ((m_head + y) % m_height) * m_width; }
+
+	///Overwrites the oldest row and returns it, making it the newest
+	float* PushRow()
+	{
+		float* row = m_outdata + m_head*m_width;
+		m_head = (m_head + 1) % m_height;
+		return row;
+	}
+
 protected:
 	size_t m_width;
 	size_t m_height;
+	size_t m_head;
 
 	float* m_outdata;
 
@@ -60,6 +95,8 @@ public:
 	virtual int64_t GetSampleLen(size_t i) const;
 	virtual bool EqualityTest(size_t i, size_t j) const;
 	virtual bool SamplesAdjacent(size_t i, size_t j) const;
+
+	virtual size_t GetMemoryUsage() const;
 };
 
 class WaterfallDecoder : public ProtocolDecoder
@@ -98,6 +135,19 @@ public:
 	void SetTimeOffset(double offsetHz)
 	{ m_offsetHz = offsetHz; }
 
+	///How to combine the FFT bins that fall within one pixel
+	enum Aggregation
+	{
+		AGGREGATE_MAX,		//Peak of all bins (keeps narrow spurs visible when zoomed out)
+		AGGREGATE_MIN		//Floor of all bins (shows the noise floor under the spurs)
+	};
+
+	void SetAggregation(Aggregation mode)
+	{ m_aggregation = mode; }
+
+	Aggregation GetAggregation()
+	{ return m_aggregation; }
+
 	size_t GetWidth()
 	{ return m_width; }
 
@@ -112,6 +162,11 @@ protected:
 
 	size_t m_width;
 	size_t m_height;
+
+	Aggregation m_aggregation;
+
+	///Aggregated magnitude of each pixel in the new row
+	std::vector<float> m_rowMagnitudes;
 };
 
 #endif
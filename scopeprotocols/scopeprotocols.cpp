@@ -63,6 +63,7 @@ void ScopeProtocolStaticInit()
 	AddDecoderClass(ParallelBusDecoder);
 	AddDecoderClass(PeriodMeasurementDecoder);
 	AddDecoderClass(SincInterpolationDecoder);
+	AddDecoderClass(SpectrogramDecoder);
 	AddDecoderClass(ThresholdDecoder);
 	AddDecoderClass(TMDSDecoder);
 	AddDecoderClass(UARTDecoder);
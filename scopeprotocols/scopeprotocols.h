@@ -64,6 +64,7 @@
 #include "ParallelBusDecoder.h"
 #include "PeriodMeasurementDecoder.h"
 #include "SincInterpolationDecoder.h"
+#include "SpectrogramDecoder.h"
 #include "ThresholdDecoder.h"
 #include "TMDSDecoder.h"
 #include "UARTDecoder.h"
@@ -0,0 +1,94 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks the in-place raw to AnalogSample expansion used by SCPI drivers' block reads
+ */
+
+#include "../scopehal/scopehal.h"
+#include "Test.h"
+
+using namespace std;
+
+/**
+	@brief Exposes the protected block helpers. Never instantiated.
+ */
+class AnalogBlockAccess : public SCPIOscilloscope
+{
+public:
+	using SCPIOscilloscope::ExpandAnalogBlock;
+};
+
+/**
+	@brief Places raw values at the front of a capture the way ReadRawBlock() does, expands them, and checks every point
+ */
+template<class T>
+void TestExpand(size_t nsamples, float scale, float offset)
+{
+	vector<T> raw(nsamples);
+	for(size_t i=0; i<nsamples; i++)
+		raw[i] = static_cast<T>((i * 7919) % 251);
+
+	AnalogCapture cap;
+	cap.m_samples.resize(nsamples);
+	if(nsamples)
+		memcpy(reinterpret_cast<unsigned char*>(&cap.m_samples[0]), &raw[0], nsamples * sizeof(T));
+
+	AnalogBlockAccess::ExpandAnalogBlock<T>(&cap, nsamples, scale, offset);
+
+	CHECK(cap.m_samples.size() == nsamples);
+	size_t bad = 0;
+	for(size_t i=0; i<nsamples; i++)
+	{
+		const AnalogSample& s = cap.m_samples[i];
+		float expected = raw[i]*scale + offset;
+		if( (s.m_offset != (int64_t)i) || (s.m_duration != 1) || (s.m_sample != expected) )
+			bad ++;
+	}
+	if(bad)
+		fprintf(stderr, "%zu of %zu samples wrong (sizeof(T) = %zu)\n", bad, nsamples, sizeof(T));
+	CHECK(bad == 0);
+}
+
+int main()
+{
+	//Block boundaries are at multiples of 1024 points
+	size_t sizes[] = {0, 1, 2, 1023, 1024, 1025, 4096, 100003};
+	for(auto n : sizes)
+	{
+		TestExpand<uint8_t>(n, 0.5f, -3);
+		TestExpand<int8_t>(n, 0.25f, 1);
+		TestExpand<int16_t>(n, 1e-3f, 0.125f);
+		TestExpand<float>(n, 1, 0);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,193 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks the chunked parallel edge detector against a plain serial scan
+ */
+
+#include "../scopehal/scopehal.h"
+#include "Test.h"
+
+using namespace std;
+
+///Same as the detector's chunk size, so we can put transitions right on the boundaries
+static const size_t CHUNK = 262144;
+
+/**
+	@brief Exposes the protected crossing time interpolation. Never instantiated.
+ */
+class EdgeDetectorAccess : public EdgeDetector
+{
+public:
+	using EdgeDetector::GetCrossingTime;
+};
+
+/**
+	@brief One sample at a time reference: sample 0 is ignored, the state is unknown until the signal first leaves
+	the hysteresis band, and every later exit from the band on the opposite side is an edge.
+ */
+vector<int64_t> SerialScan(AnalogCapture* cap, float threshold, float hysteresis)
+{
+	float hi = threshold + hysteresis/2;
+	float lo = threshold - hysteresis/2;
+
+	vector<int64_t> ret;
+	bool known = false;
+	bool state = false;
+	for(size_t i=1; i<cap->m_samples.size(); i++)
+	{
+		float v = cap->m_samples[i];
+		if(!known)
+		{
+			if( (v > hi) || (v <= lo) )
+			{
+				known = true;
+				state = (v > hi);
+			}
+			continue;
+		}
+
+		if(state && (v <= lo))
+		{
+			state = false;
+			ret.push_back(EdgeDetectorAccess::GetCrossingTime(cap, i, threshold, false));
+		}
+		else if(!state && (v > hi))
+		{
+			state = true;
+			ret.push_back(EdgeDetectorAccess::GetCrossingTime(cap, i, threshold, true));
+		}
+	}
+	return ret;
+}
+
+/**
+	@brief Square wave with random period and noise, spanning a few chunks
+ */
+AnalogCapture* MakeNoisySquare(size_t len, uint32_t seed)
+{
+	AnalogCapture* cap = new AnalogCapture;
+	cap->m_timescale = 10;
+	cap->m_triggerPhase = 3;
+
+	bool high = false;
+	size_t next = 0;
+	for(size_t i=0; i<len; i++)
+	{
+		seed = seed*1103515245 + 12345;
+		if(i >= next)
+		{
+			high = !high;
+			next = i + 1 + (seed >> 8) % 5000;
+		}
+		float noise = (static_cast<int>((seed >> 16) & 0xff) - 128) / 400.0f;
+		cap->m_samples.push_back(AnalogSample(i, 1, (high ? 1 : -1) + noise));
+	}
+	return cap;
+}
+
+void CheckAgainstSerial(AnalogCapture* cap, float threshold, float hysteresis, const char* name)
+{
+	auto edges = EdgeDetector::FindZeroCrossings(cap, threshold, hysteresis);
+	vector<int64_t> expected = SerialScan(cap, threshold, hysteresis);
+	if(*edges != expected)
+	{
+		fprintf(stderr, "%s (threshold %f, hysteresis %f): got %zu edges, expected %zu\n",
+			name, threshold, hysteresis, edges->size(), expected.size());
+	}
+	CHECK(*edges == expected);
+}
+
+int main()
+{
+	//Random square wave over several chunks, with and without hysteresis
+	AnalogCapture* square = MakeNoisySquare(3*CHUNK + 12345, 1);
+	float hysteresis[] = {0, 0.1f, 0.4f, 1.5f};
+	for(auto h : hysteresis)
+		CheckAgainstSerial(square, 0, h, "noisy square");
+	CheckAgainstSerial(square, 0.7f, 0, "noisy square, offset threshold");
+
+	//Transitions exactly on chunk boundaries. Chunk n starts at sample 1 + n*CHUNK.
+	AnalogCapture* edges = new AnalogCapture;
+	edges->m_timescale = 1;
+	for(size_t i=0; i<3*CHUNK; i++)
+	{
+		bool high = (i >= CHUNK + 1) && (i < 2*CHUNK + 1);
+		if(i == CHUNK)
+			high = true;
+		edges->m_samples.push_back(AnalogSample(i, 1, high ? 1 : -1));
+	}
+	CheckAgainstSerial(edges, 0, 0, "chunk boundaries");
+	CheckAgainstSerial(edges, 0, 0.5f, "chunk boundaries");
+	CHECK(EdgeDetector::FindZeroCrossings(edges, 0, 0)->size() == 2);
+
+	//A whole chunk stuck inside the hysteresis band: the state carries across it, and the edge is at the far side
+	AnalogCapture* band = new AnalogCapture;
+	band->m_timescale = 1;
+	for(size_t i=0; i<3*CHUNK; i++)
+	{
+		float v = -1;
+		if( (i >= CHUNK/2) && (i < 2*CHUNK + 100) )
+			v = 0.1f;
+		else if(i >= 2*CHUNK + 100)
+			v = 1;
+		band->m_samples.push_back(AnalogSample(i, 1, v));
+	}
+	CheckAgainstSerial(band, 0, 0.5f, "in band");
+	CHECK(EdgeDetector::FindZeroCrossings(band, 0, 0.5f)->size() == 1);
+	CheckAgainstSerial(band, 0, 0, "in band, no hysteresis");
+
+	//Too short to have any edges
+	AnalogCapture* tiny = new AnalogCapture;
+	tiny->m_samples.push_back(AnalogSample(0, 1, -1));
+	tiny->m_samples.push_back(AnalogSample(1, 1, 1));
+	CHECK(EdgeDetector::FindZeroCrossings(tiny, 0, 0)->empty());
+
+	//Published captures share one list per threshold/hysteresis, and get a fresh one when the generation changes
+	square->m_generation = 100;
+	auto a = EdgeDetector::FindZeroCrossings(square, 0, 0.1f);
+	auto b = EdgeDetector::FindZeroCrossings(square, 0, 0.1f);
+	CHECK(a == b);
+	CHECK(a != EdgeDetector::FindZeroCrossings(square, 0, 0.2f));
+	square->m_generation = 101;
+	CHECK(a != EdgeDetector::FindZeroCrossings(square, 0, 0.1f));
+
+	//Unpublished captures are never cached, so changes made in place show up
+	edges->m_samples[CHUNK/2] = AnalogSample(CHUNK/2, 1, 1);
+	CHECK(EdgeDetector::FindZeroCrossings(edges, 0, 0)->size() == 4);
+
+	delete square;
+	delete edges;
+	delete band;
+	delete tiny;
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,217 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks PacketQuery filtering and PacketQueryResult lookups against a brute force scan
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopehal/PacketQuery.h"
+#include "Test.h"
+#include <functional>
+
+using namespace std;
+
+enum Columns
+{
+	COL_TYPE,
+	COL_ADDR,
+	COL_NOTE
+};
+
+///Enough rows to span several bitmap words, with a partial last word
+static const size_t NROWS = 1000;
+
+void FillTable(PacketTable& table)
+{
+	table.SetSchema({"Type", "Addr", "Note"});
+	for(size_t i=0; i<NROWS; i++)
+	{
+		table.BeginPacket(i * 100);
+		table.SetEnum(COL_TYPE, (i % 3) ? "read" : "write");
+		table.SetInt(COL_ADDR, static_cast<int64_t>(i % 50) - 10);
+		if(i % 7 == 0)
+			table.SetString(COL_NOTE, (i % 14) ? "odd" : "even");
+		uint8_t payload[4] = {(uint8_t)i, (uint8_t)(i >> 8), 0x55, (uint8_t)(i % 5)};
+		table.AppendPayload(payload, sizeof(payload));
+		table.EndPacket(50);
+	}
+
+	//One aborted packet at the end, which must never match
+	table.BeginPacket(NROWS * 100);
+	table.SetEnum(COL_TYPE, "read");
+	table.AbortPacket();
+}
+
+/**
+	@brief Checks a result against the rows a brute force scan says should match
+ */
+void CheckResult(const PacketTable& table, const PacketQueryResult& result, function<bool(size_t)> expect,
+	const char* name)
+{
+	vector<size_t> expected;
+	for(size_t i=0; i<table.size(); i++)
+	{
+		if(expect(i))
+			expected.push_back(i);
+	}
+
+	vector<size_t> got;
+	for(size_t n=0; n<result.size(); n++)
+		got.push_back(result.GetRow(n));
+
+	if(got != expected)
+		fprintf(stderr, "%s: got %zu rows, expected %zu\n", name, got.size(), expected.size());
+	CHECK(got == expected);
+
+	//Ranges are ascending, non-empty, non-adjacent, and add up to the match count
+	size_t total = 0;
+	auto& ranges = result.GetRanges();
+	for(size_t i=0; i<ranges.size(); i++)
+	{
+		CHECK(ranges[i].first < ranges[i].second);
+		if(i > 0)
+			CHECK(ranges[i-1].second < ranges[i].first);
+		total += ranges[i].second - ranges[i].first;
+	}
+	CHECK(total == result.size());
+
+	//Times come from the table, and FindFirstAfter agrees with a linear search
+	for(size_t n=0; n<result.size(); n++)
+		CHECK(result.GetTime(n) == table.GetOffset(expected[n]));
+	int64_t times[] = {-1, 0, 1, 150, 12345, 50000, 99900, 99901, 1000000};
+	for(auto t : times)
+	{
+		size_t first = expected.size();
+		for(size_t n=0; n<expected.size(); n++)
+		{
+			if(table.GetOffset(expected[n]) >= t)
+			{
+				first = n;
+				break;
+			}
+		}
+		CHECK(result.FindFirstAfter(t) == first);
+	}
+}
+
+int main()
+{
+	PacketTable table;
+	FillTable(table);
+	CHECK(table.size() == NROWS);
+
+	PacketQuery q;
+	PacketQueryResult result;
+
+	//No predicates matches everything
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t) { return true; }, "all");
+
+	//Enum equality
+	q.Clear();
+	q.AddEquals("Type", "write");
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { return (i % 3) == 0; }, "enum");
+
+	//Integer equality, decimal and hex, including negative values
+	q.Clear();
+	q.AddEquals("Addr", "-7");
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { return (i % 50) == 3; }, "int");
+
+	q.Clear();
+	q.AddEquals("Addr", "0x1f");
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { return (i % 50) == 41; }, "hex int");
+
+	//String equality (hash keys must be checked against the text)
+	q.Clear();
+	q.AddEquals("Note", "even");
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { return (i % 14) == 0; }, "string");
+
+	//Values that don't occur anywhere
+	q.Clear();
+	q.AddEquals("Type", "erase");
+	CHECK(q.Run(table, result));
+	CHECK(result.empty());
+	CHECK(result.FindFirstAfter(0) == 0);
+
+	//Integer range, inclusive at both ends
+	q.Clear();
+	q.AddRange("Addr", -2, 5);
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { int64_t a = (int64_t)(i % 50) - 10; return (a >= -2) && (a <= 5); },
+		"range");
+
+	//Payload contains
+	q.Clear();
+	q.AddContains({0x55, 2});
+	CHECK(q.Run(table, result));
+	CheckResult(table, result, [](size_t i) { return (i % 5) == 2; }, "contains");
+
+	//All predicates must match
+	q.Clear();
+	q.AddEquals("Type", "read");
+	q.AddRange("Addr", 0, 20);
+	q.AddContains({0x55});
+	CHECK(q.Run(table, result));
+	CheckResult(table, result,
+		[](size_t i) { int64_t a = (int64_t)(i % 50) - 10; return (i % 3) && (a >= 0) && (a <= 20); },
+		"combined");
+
+	//Unknown columns are an error
+	q.Clear();
+	q.AddEquals("Nope", "1");
+	CHECK(!q.Run(table, result));
+
+	//Results go stale once the table is cleared for the next decode
+	q.Clear();
+	q.AddEquals("Type", "write");
+	CHECK(q.Run(table, result));
+	CHECK(result.IsValid());
+	size_t count = result.size();
+	table.Clear();
+	FillTable(table);
+	CHECK(!result.IsValid());
+	CHECK(result.size() == count);
+	CHECK(result.GetRow(0) == SIZE_MAX);
+	CHECK(result.GetTime(0) == -1);
+	CHECK(result.FindFirstAfter(0) == count);
+
+	//Re-running the query against the new decode works again
+	CHECK(q.Run(table, result));
+	CHECK(result.IsValid());
+	CheckResult(table, result, [](size_t i) { return (i % 3) == 0; }, "rerun");
+
+	return TEST_RESULT();
+}
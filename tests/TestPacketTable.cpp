@@ -0,0 +1,176 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks cell storage, packet building and column indexes in PacketTable
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopehal/PacketTable.h"
+#include "Test.h"
+
+using namespace std;
+
+enum Columns
+{
+	COL_TYPE,
+	COL_ADDR,
+	COL_NOTE
+};
+
+int main()
+{
+	PacketTable table;
+	table.SetSchema({"Type", "Addr", "Note"});
+	CHECK(table.GetColumnCount() == 3);
+	CHECK(table.GetColumn("Addr") == COL_ADDR);
+	CHECK(table.GetColumn("Nope") == -1);
+	table.SetIntFormat(COL_ADDR, "%04" PRIx64);
+
+	//First row has an empty string while the string arena is still empty
+	table.BeginPacket(100);
+	table.SetEnum(COL_TYPE, "read");
+	table.SetInt(COL_ADDR, 0xbeef);
+	table.SetString(COL_NOTE, "");
+	const uint8_t p0[] = {1, 2, 3};
+	table.AppendPayload(p0, sizeof(p0));
+	CHECK(table.IsPacketOpen());
+	CHECK(table.size() == 0);
+	table.EndPacket(50);
+	CHECK(!table.IsPacketOpen());
+	CHECK(table.size() == 1);
+
+	CHECK(table.GetCellType(0, COL_NOTE) == PacketTable::CELL_STRING);
+	CHECK(table.GetCellText(0, COL_NOTE) == "");
+	CHECK(table.GetCellText(0, COL_TYPE) == "read");
+	CHECK(table.GetCellText(0, COL_ADDR) == "beef");
+	CHECK(table.GetInt(0, COL_ADDR) == 0xbeef);
+	CHECK(table.GetOffset(0) == 100);
+	CHECK(table.GetLength(0) == 50);
+	CHECK(table.GetPayloadSize(0) == 3);
+	CHECK(table.GetPayload(0)[2] == 3);
+
+	//Negative ints survive the 62-bit cell, other cell types read back as 0
+	table.BeginPacket(200);
+	table.SetEnum(COL_TYPE, "write");
+	table.SetInt(COL_ADDR, -5);
+	table.SetString(COL_NOTE, "hello");
+	table.AppendPayload(0xaa);
+	table.EndPacket(10);
+	CHECK(table.GetInt(1, COL_ADDR) == -5);
+	CHECK(table.GetInt(1, COL_TYPE) == 0);
+	CHECK(table.GetCellText(1, COL_NOTE) == "hello");
+	CHECK(table.GetPayloadSize(0) == 3);
+	CHECK(table.GetPayloadSize(1) == 1);
+
+	//Aborted packets leave no trace, including their strings and payload
+	table.BeginPacket(300);
+	table.SetString(COL_NOTE, "discard me");
+	table.AppendPayload(p0, sizeof(p0));
+	table.AbortPacket();
+	CHECK(table.size() == 2);
+	table.BeginPacket(400);
+	table.SetEnum(COL_TYPE, "read");
+	table.SetString(COL_NOTE, "kept");
+	table.EndPacket(1);
+	CHECK(table.size() == 3);
+	CHECK(table.GetOffset(2) == 400);
+	CHECK(table.GetCellText(2, COL_NOTE) == "kept");
+	CHECK(table.GetCellText(1, COL_NOTE) == "hello");
+	CHECK(table.GetPayloadSize(2) == 0);
+	CHECK(table.GetCellType(2, COL_ADDR) == PacketTable::CELL_EMPTY);
+	CHECK(table.GetCellText(2, COL_ADDR) == "");
+
+	//Starting a new packet abandons an unfinished one
+	table.BeginPacket(500);
+	table.SetString(COL_NOTE, "lost");
+	table.BeginPacket(600);
+	table.EndPacket(1);
+	CHECK(table.size() == 4);
+	CHECK(table.GetOffset(3) == 600);
+	CHECK(table.GetCellType(3, COL_NOTE) == PacketTable::CELL_EMPTY);
+
+	//Enums are interned once and shared
+	uint32_t read_id;
+	uint32_t write_id;
+	CHECK(table.FindEnum("read", read_id));
+	CHECK(table.FindEnum("write", write_id));
+	CHECK(read_id != write_id);
+	uint32_t unused;
+	CHECK(!table.FindEnum("erase", unused));
+
+	//Column indexes are sorted by key, skip empty cells, and int keys sort numerically
+	auto& addrs = table.GetColumnIndex(COL_ADDR);
+	CHECK(addrs.size() == 2);
+	if(addrs.size() == 2)
+	{
+		CHECK(addrs[0].first == PacketTable::GetIntKey(-5));
+		CHECK(addrs[0].second == 1);
+		CHECK(addrs[1].first == PacketTable::GetIntKey(0xbeef));
+		CHECK(addrs[1].second == 0);
+	}
+	CHECK(PacketTable::GetIntKey(-1) < PacketTable::GetIntKey(0));
+	CHECK(PacketTable::GetIntKey(0) < PacketTable::GetIntKey(1));
+
+	auto& types = table.GetColumnIndex(COL_TYPE);
+	size_t nread = 0;
+	for(auto& e : types)
+	{
+		if(e.first == PacketTable::GetEnumKey(read_id))
+			nread ++;
+	}
+	CHECK(nread == 2);
+
+	auto& notes = table.GetColumnIndex(COL_NOTE);
+	CHECK(notes.size() == 3);
+	bool found = false;
+	for(auto& e : notes)
+	{
+		if( (e.first == PacketTable::GetStringKey("hello", 5)) && (e.second == 1) )
+			found = true;
+	}
+	CHECK(found);
+
+	//Indexes are rebuilt once more rows arrive
+	table.BeginPacket(700);
+	table.SetInt(COL_ADDR, 7);
+	table.EndPacket(1);
+	CHECK(table.GetColumnIndex(COL_ADDR).size() == 3);
+
+	//Clear drops rows but keeps interned enums
+	table.Clear();
+	CHECK(table.size() == 0);
+	CHECK(table.empty());
+	CHECK(table.GetColumnIndex(COL_ADDR).empty());
+	CHECK(table.FindEnum("write", unused) && (unused == write_id));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,175 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks the block layout of files written by PcapNGWriter
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopehal/PcapNGWriter.h"
+#include "Test.h"
+#include <cstring>
+
+using namespace std;
+
+//The writer uses native byte order, with the SHB byte order magic telling readers which that is
+uint32_t Get32(const vector<uint8_t>& buf, size_t pos)
+{
+	uint32_t v = 0;
+	if(pos + 4 <= buf.size())
+		memcpy(&v, &buf[pos], 4);
+	return v;
+}
+
+uint16_t Get16(const vector<uint8_t>& buf, size_t pos)
+{
+	uint16_t v = 0;
+	if(pos + 2 <= buf.size())
+		memcpy(&v, &buf[pos], 2);
+	return v;
+}
+
+/**
+	@brief Checks an enhanced packet block and returns the offset of the next block
+ */
+size_t CheckEPB(const vector<uint8_t>& buf, size_t pos, uint64_t timestamp, const vector<uint8_t>& data)
+{
+	size_t padded = (data.size() + 3) & ~3;
+	uint32_t len = 32 + padded;
+
+	CHECK(Get32(buf, pos) == 6);
+	CHECK(Get32(buf, pos + 4) == len);
+	CHECK(Get32(buf, pos + 8) == 0);									//interface
+	CHECK(Get32(buf, pos + 12) == (timestamp >> 32));
+	CHECK(Get32(buf, pos + 16) == (timestamp & 0xffffffff));
+	CHECK(Get32(buf, pos + 20) == data.size());							//captured length
+	CHECK(Get32(buf, pos + 24) == data.size());							//original length
+	CHECK( (pos + 28 + data.size() <= buf.size()) && equal(data.begin(), data.end(), buf.begin() + pos + 28) );
+	for(size_t i=data.size(); i<padded; i++)
+		CHECK(buf[pos + 28 + i] == 0);
+	CHECK(Get32(buf, pos + len - 4) == len);							//trailing length
+
+	return pos + len;
+}
+
+int main()
+{
+	const char* path = "TestPcapNGWriter.pcapng";
+	const time_t base = 1500000000;
+
+	vector<uint8_t> p1 = {0xde, 0xad, 0xbe, 0xef, 0x42};				//needs padding
+	vector<uint8_t> p2;													//empty
+	vector<uint8_t> p3 = {1, 2, 3, 4, 5, 6, 7, 8};						//already aligned
+	uint64_t t1 = 0x123456789abULL;										//uses both timestamp words
+	uint64_t t3 = 999;
+
+	PcapNGWriter writer;
+	CHECK(writer.Open(path, PcapNGWriter::LINKTYPE_ETHERNET, base));
+	CHECK(writer.IsOpen());
+
+	//Packet assembled from pieces
+	writer.BeginPacket(t1);
+	writer.Append(p1.data(), 2);
+	writer.Append(p1.data() + 2, 2);
+	writer.Append(p1[4]);
+	writer.EndPacket();
+
+	//Negative timestamps are clamped to zero
+	writer.WritePacket(-5, p2.data(), 0);
+
+	//Aborted packets leave nothing behind, nor does one left open at Close()
+	writer.BeginPacket(1);
+	writer.Append(0xff);
+	writer.AbortPacket();
+
+	writer.WritePacket(t3, p3.data(), p3.size());
+
+	writer.BeginPacket(2);
+	writer.Append(0xff);
+
+	CHECK(writer.GetPacketCount() == 3);
+	CHECK(writer.Close());
+	CHECK(!writer.IsOpen());
+
+	//Read it back
+	vector<uint8_t> buf;
+	FILE* fp = fopen(path, "rb");
+	CHECK(fp != NULL);
+	if(fp)
+	{
+		uint8_t tmp[4096];
+		size_t n;
+		while( (n = fread(tmp, 1, sizeof(tmp), fp)) > 0)
+			buf.insert(buf.end(), tmp, tmp + n);
+		fclose(fp);
+	}
+	remove(path);
+
+	//Section header block
+	CHECK(Get32(buf, 0) == 0x0a0d0d0a);
+	CHECK(Get32(buf, 4) == 28);
+	CHECK(Get32(buf, 8) == 0x1a2b3c4d);
+	CHECK(Get16(buf, 12) == 1);											//version 1.0
+	CHECK(Get16(buf, 14) == 0);
+	CHECK(Get32(buf, 16) == 0xffffffff);								//section length unknown
+	CHECK(Get32(buf, 20) == 0xffffffff);
+	CHECK(Get32(buf, 24) == 28);
+
+	//Interface description block, with if_tsresol = 10^-12 and if_tsoffset = base
+	size_t pos = 28;
+	const uint32_t idblen = 16 + 8 + 12 + 4 + 4;
+	CHECK(Get32(buf, pos) == 1);
+	CHECK(Get32(buf, pos + 4) == idblen);
+	CHECK(Get16(buf, pos + 8) == PcapNGWriter::LINKTYPE_ETHERNET);
+	CHECK(Get16(buf, pos + 10) == 0);
+	CHECK(Get32(buf, pos + 12) == 0);									//snap length
+	CHECK(Get16(buf, pos + 16) == 9);
+	CHECK(Get16(buf, pos + 18) == 1);
+	CHECK( (buf.size() > pos + 20) && (buf[pos + 20] == 12) );
+	CHECK(Get16(buf, pos + 24) == 14);
+	CHECK(Get16(buf, pos + 26) == 8);
+	int64_t offset = 0;
+	if(buf.size() >= pos + 36)
+		memcpy(&offset, &buf[pos + 28], 8);
+	CHECK(offset == base);
+	CHECK(Get16(buf, pos + 36) == 0);									//opt_endofopt
+	CHECK(Get16(buf, pos + 38) == 0);
+	CHECK(Get32(buf, pos + idblen - 4) == idblen);
+	pos += idblen;
+
+	//Packets, in order
+	pos = CheckEPB(buf, pos, t1, p1);
+	pos = CheckEPB(buf, pos, 0, p2);
+	pos = CheckEPB(buf, pos, t3, p3);
+	CHECK(pos == buf.size());
+
+	return TEST_RESULT();
+}
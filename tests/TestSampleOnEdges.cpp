@@ -0,0 +1,121 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks that sampling several lanes in pieces, or from partway in, matches sampling them in one go
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopehal/ProtocolDecoder.h"
+#include "Test.h"
+
+using namespace std;
+
+/**
+	@brief Exposes the protected multi-lane sampling helpers. Never instantiated.
+ */
+class SamplerAccess : public ProtocolDecoder
+{
+public:
+	typedef ProtocolDecoder::MultiLaneSamples Samples;
+
+	static void SampleAll(const vector<DigitalCapture*>& lanes, DigitalCapture* clock, Samples& samples)
+	{ SampleOnEdges<EDGE_RISING>(lanes, clock, samples); }
+
+	static void Seek(const vector<DigitalCapture*>& lanes, DigitalCapture* clock, Samples& samples, int64_t t)
+	{ SeekSampleOnEdges(lanes, clock, samples, t); }
+
+	static bool Continue(const vector<DigitalCapture*>& lanes, DigitalCapture* clock, Samples& samples, int64_t tend)
+	{ return ContinueSampleOnEdges<EDGE_RISING>(lanes, clock, samples, tend); }
+};
+
+/**
+	@brief Makes a digital waveform with a given sample period, either a square wave or random bits
+ */
+DigitalCapture* MakeCapture(int64_t period, size_t len, bool random)
+{
+	DigitalCapture* cap = new DigitalCapture;
+	cap->m_timescale = 10;
+	for(size_t i=0; i<len; i++)
+		cap->m_samples.push_back(DigitalSample(i*period, period, random ? (rand() & 1) : (i & 1)));
+	return cap;
+}
+
+int main()
+{
+	srand(1);
+
+	//Lanes of different lengths and rates, so sampling stops when the shortest one runs out
+	DigitalCapture* clock = MakeCapture(3, 3000, false);
+	vector<DigitalCapture*> lanes;
+	lanes.push_back(MakeCapture(2, 4600, true));
+	lanes.push_back(MakeCapture(5, 1700, true));
+	lanes.push_back(MakeCapture(7, 1300, true));
+
+	SamplerAccess::Samples full;
+	SamplerAccess::SampleAll(lanes, clock, full);
+	CHECK(full.size() > 1000);
+
+	//Sampling in small pieces gives exactly the same result
+	SamplerAccess::Samples pieces;
+	SamplerAccess::Seek(lanes, clock, pieces, -1);
+	int64_t tend = 0;
+	bool more = true;
+	while(more)
+	{
+		tend += 777;
+		more = SamplerAccess::Continue(lanes, clock, pieces, tend);
+	}
+	CHECK(pieces.m_offsets == full.m_offsets);
+	CHECK(pieces.m_durations == full.m_durations);
+	CHECK(pieces.m_words == full.m_words);
+
+	//Starting partway in gives the tail of the full result, from the first edge after the seek time
+	int64_t tseek = 40000;
+	SamplerAccess::Samples tail;
+	SamplerAccess::Seek(lanes, clock, tail, tseek);
+	CHECK(!SamplerAccess::Continue(lanes, clock, tail, INT64_MAX));
+
+	size_t first = 0;
+	while( (first < full.size()) && (full.m_offsets[first] <= tseek) )
+		first ++;
+	CHECK(tail.size() == full.size() - first);
+	for(size_t i=0; i<tail.size() && (first+i) < full.size(); i++)
+	{
+		CHECK(tail.m_offsets[i] == full.m_offsets[first+i]);
+		CHECK(tail.m_words[i] == full.m_words[first+i]);
+	}
+
+	for(auto l : lanes)
+		delete l;
+	delete clock;
+
+	return TEST_RESULT();
+}
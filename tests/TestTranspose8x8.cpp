@@ -0,0 +1,86 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks the 8x8 bit matrix transpose used to demux logic analyzer capture memory
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopehal/AntikernelLogicAnalyzer.h"
+#include "Test.h"
+
+/**
+	@brief Bit-at-a-time reference: byte i bit j moves to byte j bit i
+ */
+uint64_t SlowTranspose(uint64_t x)
+{
+	uint64_t out = 0;
+	for(int i=0; i<8; i++)
+	{
+		for(int j=0; j<8; j++)
+		{
+			if( (x >> (i*8 + j)) & 1 )
+				out |= 1ULL << (j*8 + i);
+		}
+	}
+	return out;
+}
+
+int main()
+{
+	//Every single bit on its own
+	for(int b=0; b<64; b++)
+	{
+		uint64_t x = 1ULL << b;
+		CHECK(AntikernelLogicAnalyzer::Transpose8x8(x) == SlowTranspose(x));
+	}
+
+	//Fixed patterns
+	CHECK(AntikernelLogicAnalyzer::Transpose8x8(0) == 0);
+	CHECK(AntikernelLogicAnalyzer::Transpose8x8(~0ULL) == ~0ULL);
+	CHECK(AntikernelLogicAnalyzer::Transpose8x8(0x8040201008040201ULL) == 0x8040201008040201ULL);	//diagonal
+	CHECK(AntikernelLogicAnalyzer::Transpose8x8(0x00000000000000ffULL) == 0x0101010101010101ULL);	//row 0 -> column 0
+
+	//Pseudorandom words, and transposing twice is the identity
+	uint64_t x = 0x0123456789abcdefULL;
+	for(int i=0; i<10000; i++)
+	{
+		x ^= x << 13;
+		x ^= x >> 7;
+		x ^= x << 17;
+
+		uint64_t t = AntikernelLogicAnalyzer::Transpose8x8(x);
+		CHECK(t == SlowTranspose(x));
+		CHECK(AntikernelLogicAnalyzer::Transpose8x8(t) == x);
+	}
+
+	return TEST_RESULT();
+}
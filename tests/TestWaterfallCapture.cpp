@@ -0,0 +1,101 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* ANTIKERNEL v0.1                                                                                                      *
+*                                                                                                                      *
+* Copyright (c) 2012-2020 Andrew D. Zonenberg                                                                          *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Checks that WaterfallCapture rows come back oldest first across ring buffer wraparound
+ */
+
+#include "../scopehal/scopehal.h"
+#include "../scopeprotocols/WaterfallDecoder.h"
+#include "Test.h"
+
+using namespace std;
+
+static const size_t WIDTH = 5;
+static const size_t HEIGHT = 4;
+
+/**
+	@brief Pushes one row with every pixel set to the given value
+ */
+void Push(WaterfallCapture& cap, float value)
+{
+	float* row = cap.PushRow();
+	for(size_t x=0; x<WIDTH; x++)
+		row[x] = value;
+}
+
+/**
+	@brief Checks that display row y of the capture is entirely the expected value
+ */
+bool RowIs(const WaterfallCapture& cap, size_t y, float value)
+{
+	const float* row = cap.GetRow(y);
+	for(size_t x=0; x<WIDTH; x++)
+	{
+		if(row[x] != value)
+			return false;
+	}
+	return true;
+}
+
+int main()
+{
+	WaterfallCapture cap(WIDTH, HEIGHT);
+	CHECK(cap.GetWidth() == WIDTH);
+	CHECK(cap.GetHeight() == HEIGHT);
+	CHECK(cap.GetHead() == 0);
+
+	//Starts out blank
+	for(size_t y=0; y<HEIGHT; y++)
+		CHECK(RowIs(cap, y, 0));
+
+	//Push rows 1...10, wrapping the ring more than twice, and check the display order after every push
+	for(size_t n=1; n<=10; n++)
+	{
+		Push(cap, n);
+		CHECK(cap.GetHead() == n % HEIGHT);
+
+		//Newest row is always at the bottom, and each row up is one older (or still blank)
+		for(size_t y=0; y<HEIGHT; y++)
+		{
+			size_t age = HEIGHT - 1 - y;
+			float expected = (age < n) ? (n - age) : 0;
+			CHECK(RowIs(cap, y, expected));
+		}
+	}
+
+	//After wrapping, the raw buffer is not in display order, but GetHead() finds the oldest row in it
+	const float* raw = cap.GetRawRingData();
+	CHECK(raw[0] != 7);
+	for(size_t y=0; y<HEIGHT; y++)
+		CHECK(raw[((cap.GetHead() + y) % HEIGHT) * WIDTH] == 7 + y);
+
+	return TEST_RESULT();
+}